@@ -6,6 +6,7 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include "src/include/iex_tp.h"
 
 #define PCAPNG_MAGIC 0x0a0d0d0a
 #define PCAPNG_EPB_TYPE 0x00000006
@@ -33,6 +34,9 @@ const char* get_iex_message_type(uint8_t type) {
         case 0x58: return "Official Price";
         case 0x42: return "Trade Break";
         case 0x41: return "Auction Information";
+        case 0x45: return "Security Event";
+        case 0x38: return "Price Level Update (Buy)";
+        case 0x35: return "Price Level Update (Sell)";
         case 0x52: return "Retail Interest Indicator";
         default: return "Unknown";
     }
@@ -48,32 +52,22 @@ void decode_symbol(const uint8_t *symbol_data, char *output) {
     output[len] = '\0';
 }
 
-void analyze_security_directory(const uint8_t *data, size_t offset) {
-    if (data[offset] != 0x44) return;
+void analyze_security_directory(const uint8_t *msg) {
+    char ticker[16], poc[IEX_PRICE_TEXT_MAX];
+    decode_symbol(msg + IEX_MSG_SYMBOL_OFFSET, ticker);
     
-    const uint8_t *msg = &data[offset];
-    const uint8_t *symbol = msg + 9;
-    uint8_t round_lot_size = msg[17];
-    uint8_t adjusted_poc_price = msg[18];
-    uint8_t luld_tier = msg[19];
-    
-    char ticker[16];
-    decode_symbol(symbol, ticker);
-    
-    printf("SECURITY: %-8s  RoundLot:%u  LULDTier:%c\n",
-           ticker, round_lot_size, luld_tier);
+    printf("SECURITY: %-8s  RoundLot:%u  POC:$%s  LULDTier:%u\n",
+           ticker, iex_security_directory_round_lot_size(msg),
+           iex_price_text(iex_security_directory_adjusted_poc_price(msg), poc),
+           iex_security_directory_luld_tier(msg));
 }
 
-void analyze_trading_status(const uint8_t *data, size_t offset) {
-    if (data[offset] != 0x48) return;
-    
-    const uint8_t *msg = &data[offset];
-    const uint8_t *symbol = msg + 9;
-    uint8_t trading_status = msg[17];
-    uint8_t reason = msg[18];
+void analyze_trading_status(const uint8_t *msg) {
+    uint8_t trading_status = iex_trading_status_flags(msg);
+    uint32_t reason = iex_trading_status_reason(msg);
     
     char ticker[16];
-    decode_symbol(symbol, ticker);
+    decode_symbol(msg + IEX_MSG_SYMBOL_OFFSET, ticker);
     
     const char* status_desc = "";
     switch(trading_status) {
@@ -84,38 +78,23 @@ void analyze_trading_status(const uint8_t *data, size_t offset) {
         default: status_desc = "Unknown"; break;
     }
     
-    printf("STATUS:   %-8s  %s  (Reason:%c)\n", ticker, status_desc, reason);
+    printf("STATUS:   %-8s  %s  (Reason:%.4s)\n", ticker, status_desc, (const char *)&reason);
 }
 
-void analyze_quote_update(const uint8_t *data, size_t offset) {
-    if (data[offset] != 0x51) return;
-    
-    const uint8_t *msg = &data[offset];
-    const uint8_t *symbol = msg + 9;
-    uint32_t bid_price = *(uint32_t*)(msg + 17);
-    uint32_t bid_size = *(uint32_t*)(msg + 21);
-    uint32_t ask_price = *(uint32_t*)(msg + 25);
-    uint32_t ask_size = *(uint32_t*)(msg + 29);
+void analyze_quote_update(const uint8_t *msg) {
+    char ticker[16], bid[IEX_PRICE_TEXT_MAX], ask[IEX_PRICE_TEXT_MAX];
+    decode_symbol(msg + IEX_MSG_SYMBOL_OFFSET, ticker);
     
-    char ticker[16];
-    decode_symbol(symbol, ticker);
-    
-    printf("QUOTE:    %-8s  Bid:$%-8.4f(%u)  Ask:$%-8.4f(%u)\n",
-           ticker, (double)bid_price / 10000.0, bid_size,
-           (double)ask_price / 10000.0, ask_size);
+    printf("QUOTE:    %-8s  Bid:$%-8s(%u)  Ask:$%-8s(%u)\n",
+           ticker, iex_price_text(iex_quote_update_bid_price(msg), bid), iex_quote_update_bid_size(msg),
+           iex_price_text(iex_quote_update_ask_price(msg), ask), iex_quote_update_ask_size(msg));
 }
 
-void analyze_auction_info(const uint8_t *data, size_t offset) {
-    if (data[offset] != 0x41) return;
-    
-    const uint8_t *msg = &data[offset];
-    const uint8_t *symbol = msg + 9;
-    uint8_t auction_type = msg[17];
-    uint32_t paired_shares = *(uint32_t*)(msg + 18);
-    uint32_t reference_price = *(uint32_t*)(msg + 22);
+void analyze_auction_info(const uint8_t *msg) {
+    uint8_t auction_type = iex_auction_info_flags(msg);
     
-    char ticker[16];
-    decode_symbol(symbol, ticker);
+    char ticker[16], reference[IEX_PRICE_TEXT_MAX];
+    decode_symbol(msg + IEX_MSG_SYMBOL_OFFSET, ticker);
     
     const char* auction_desc = "";
     switch(auction_type) {
@@ -126,22 +105,20 @@ void analyze_auction_info(const uint8_t *data, size_t offset) {
         default: auction_desc = "Unknown"; break;
     }
     
-    printf("AUCTION:  %-8s  %s  Paired:%u  RefPrice:$%.4f\n",
-           ticker, auction_desc, paired_shares, (double)reference_price / 10000.0);
+    printf("AUCTION:  %-8s  %s  Paired:%u  RefPrice:$%s\n",
+           ticker, auction_desc, iex_auction_info_paired_shares(msg),
+           iex_price_text(iex_auction_info_reference_price(msg), reference));
 }
 
-void analyze_system_event(const uint8_t *data, size_t offset) {
-    if (data[offset] != 0x53) return;
-    
-    const uint8_t *msg = &data[offset];
-    uint8_t system_event = msg[9];
+void analyze_system_event(const uint8_t *msg) {
+    uint8_t system_event = iex_system_event_flags(msg);
     
     const char* event_desc = "";
     switch(system_event) {
         case 'O': event_desc = "Start of Messages"; break;
         case 'S': event_desc = "Start of System Hours"; break;
-        case 'Q': event_desc = "Start of Market Hours"; break;
-        case 'M': event_desc = "End of Market Hours"; break;
+        case 'R': event_desc = "Start of Regular Market Hours"; break;
+        case 'M': event_desc = "End of Regular Market Hours"; break;
         case 'E': event_desc = "End of System Hours"; break;
         case 'C': event_desc = "End of Messages"; break;
         default: event_desc = "Unknown System Event"; break;
@@ -150,6 +127,22 @@ void analyze_system_event(const uint8_t *data, size_t offset) {
     printf("SYSTEM:   %s (%c)\n", event_desc, system_event);
 }
 
+void analyze_trade_report(const uint8_t *msg) {
+    char ticker[16], price[IEX_PRICE_TEXT_MAX];
+    decode_symbol(msg + IEX_MSG_SYMBOL_OFFSET, ticker);
+    
+    printf("TRADE:    %-8s  $%-8s  %8u shares  flags:0x%02x\n",
+           ticker, iex_price_text(iex_trade_report_price(msg), price), iex_trade_report_size(msg),
+           iex_trade_report_flags(msg));
+}
+
+void analyze_official_price(const uint8_t *msg) {
+    char ticker[16], price[IEX_PRICE_TEXT_MAX];
+    decode_symbol(msg + IEX_MSG_SYMBOL_OFFSET, ticker);
+    
+    printf("OFFICIAL: %-8s  $%-8s\n", ticker, iex_price_text(iex_official_price_price(msg), price));
+}
+
 void comprehensive_message_analysis(const uint8_t *udp_payload, size_t len) {
     printf("\n=== Comprehensive IEX Message Analysis ===\n");
     
@@ -157,56 +150,37 @@ void comprehensive_message_analysis(const uint8_t *udp_payload, size_t len) {
     int message_counts[256] = {0};
     int total_messages = 0;
     
-    for (size_t i = 0; i < len - 30; i++) {
-        uint8_t msg_type = udp_payload[i];
+    iex_tp_segment_t seg;
+    if (iex_tp_segment_init(&seg, udp_payload, len) != 0) {
+        printf("Not an IEX-TP segment (%zu bytes)\n", len);
+        return;
+    }
+    printf("Feed: %s\n", iex_schema_name(seg.header->message_protocol_id));
+    
+    const uint8_t *msg;
+    uint16_t msg_len;
+    
+    while ((msg = iex_tp_next_message(&seg, &msg_len)) != NULL) {
+        uint8_t msg_type = msg[IEX_MSG_TYPE_OFFSET];
+        message_counts[msg_type]++;
+        total_messages++;
         
-        // Look for valid IEX message types
-        if (msg_type >= 0x41 && msg_type <= 0x58) {
-            const uint8_t *symbol_area = &udp_payload[i + 9];
-            if (i + 30 < len && symbol_area[0] >= 'A' && symbol_area[0] <= 'Z') {
-                message_counts[msg_type]++;
-                total_messages++;
-                
-                // Analyze first few of each type
-                if (message_counts[msg_type] <= 3) {
-                    switch(msg_type) {
-                        case 0x44: analyze_security_directory(udp_payload, i); break;
-                        case 0x48: analyze_trading_status(udp_payload, i); break;
-                        case 0x51: analyze_quote_update(udp_payload, i); break;
-                        case 0x54: 
-                            {
-                                const uint8_t *msg = &udp_payload[i];
-                                const uint8_t *symbol = msg + 9;
-                                uint32_t price = *(uint32_t*)(msg + 17);
-                                uint32_t size = *(uint32_t*)(msg + 21);
-                                uint8_t side = msg[25];
-                                
-                                char ticker[16];
-                                decode_symbol(symbol, ticker);
-                                
-                                printf("TRADE:    %-8s  $%-8.4f  %8u shares  %c\n",
-                                       ticker, (double)price / 10000.0, size, 
-                                       (side >= 32 && side <= 126) ? side : '?');
-                            }
-                            break;
-                        case 0x41: analyze_auction_info(udp_payload, i); break;
-                        case 0x53: analyze_system_event(udp_payload, i); break;
-                        case 0x58:
-                            {
-                                const uint8_t *msg = &udp_payload[i];
-                                const uint8_t *symbol = msg + 9;
-                                uint32_t official_price = *(uint32_t*)(msg + 17);
-                                
-                                char ticker[16];
-                                decode_symbol(symbol, ticker);
-                                
-                                printf("OFFICIAL: %-8s  $%-8.4f\n",
-                                       ticker, (double)official_price / 10000.0);
-                            }
-                            break;
-                    }
-                }
-            }
+        // Analyze first few of each type (only if the body is complete)
+        if (message_counts[msg_type] > 3) continue;
+        switch(msg_type) {
+#define ANALYZE(type_, name, fn) \
+            case type_: if (msg_len >= IEX_LENGTH(name)) fn(msg); break;
+            ANALYZE(IEX_SECURITY_DIRECTORY, security_directory, analyze_security_directory)
+            ANALYZE(IEX_TRADING_STATUS, trading_status, analyze_trading_status)
+            ANALYZE(IEX_QUOTE_UPDATE, quote_update, analyze_quote_update)
+            ANALYZE(IEX_TRADE_REPORT, trade_report, analyze_trade_report)
+            ANALYZE(IEX_AUCTION_INFO, auction_info, analyze_auction_info)
+            ANALYZE(IEX_SYSTEM_EVENT, system_event, analyze_system_event)
+            ANALYZE(IEX_OFFICIAL_PRICE, official_price, analyze_official_price)
+#undef ANALYZE
+            default:
+                iex_print_message(stdout, msg, msg_len, seg.header->message_protocol_id);
+                break;
         }
     }
     
@@ -264,10 +238,10 @@ int main() {
                 printf("\n\n>>> ANALYZING PACKET %d (%u bytes) <<<\n", 
                        packet_count + 1, epb->captured_len);
                 
-                const uint8_t *udp_payload = packet_data + 42;
-                size_t payload_len = epb->captured_len - 42;
-                
-                comprehensive_message_analysis(udp_payload, payload_len);
+                size_t payload_len;
+                const uint8_t *udp_payload = iex_udp_payload(packet_data, epb->captured_len,
+                                                             &payload_len);
+                if (udp_payload) comprehensive_message_analysis(udp_payload, payload_len);
                 packet_count++;
             }
         }
@@ -0,0 +1,512 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include "src/include/bench_results.h"
+
+// Benchmark regression comparator
+// Diffs two result files written by pipeline_benchmark --json or
+// simd_benchmark --counters --json. Results are matched by name and the
+// timed samples compared with Welch's t-test: the confidence interval of
+// the change in mean time decides. A result is a regression when the
+// slowdown is significant (the whole interval lies above zero) and its
+// mean change exceeds the threshold, so noise alone never fails a run and
+// a real slowdown smaller than the threshold is reported, not flagged.
+// Exit status: 0 no regression, 1 regression, 2 bad input.
+
+#define DEFAULT_CONFIDENCE  95.0
+#define DEFAULT_THRESHOLD   2.0     // percent
+#define MAX_FILE_SIZE       (64 * 1024 * 1024)
+
+// Minimal JSON document tree, enough for the result files
+typedef enum {
+    JSON_NULL,
+    JSON_BOOL,
+    JSON_NUMBER,
+    JSON_STRING,
+    JSON_ARRAY,
+    JSON_OBJECT,
+} json_type_t;
+
+typedef struct json_value {
+    json_type_t type;
+    double number;
+    char *string;
+    struct json_value *items;       // array elements or object values
+    char **keys;                    // object member names
+    size_t count;
+} json_value_t;
+
+typedef struct {
+    const char *cursor;
+    const char *end;
+    const char *error;
+} json_parser_t;
+
+static void json_skip_space(json_parser_t *p) {
+    while (p->cursor < p->end && strchr(" \t\r\n", *p->cursor)) p->cursor++;
+}
+
+static int json_parse_value(json_parser_t *p, json_value_t *value, int depth);
+
+static char *json_parse_string(json_parser_t *p) {
+    size_t capacity = 16, length = 0;
+    char *text = malloc(capacity);
+
+    p->cursor++;    // opening quote
+    while (text && p->cursor < p->end && *p->cursor != '"') {
+        char c = *p->cursor++;
+        if (c == '\\' && p->cursor < p->end) {
+            c = *p->cursor++;
+            switch (c) {
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                case 'u': {
+                    // Result names and paths are ASCII; anything else becomes '?'
+                    unsigned code = 0;
+                    int digits = 0;
+                    for (; digits < 4 && p->cursor < p->end && isxdigit((unsigned char)*p->cursor); digits++) {
+                        char h = (char)tolower((unsigned char)*p->cursor++);
+                        code = code * 16 + (unsigned)(isdigit((unsigned char)h) ? h - '0' : h - 'a' + 10);
+                    }
+                    c = (digits == 4 && code < 0x80) ? (char)code : '?';
+                    break;
+                }
+                default: break;     // \" \\ \/
+            }
+        }
+        if (length + 2 > capacity) {
+            capacity *= 2;
+            char *grown = realloc(text, capacity);
+            if (!grown) {
+                free(text);
+                text = NULL;
+                break;
+            }
+            text = grown;
+        }
+        text[length++] = c;
+    }
+
+    if (!text || p->cursor >= p->end) {
+        free(text);
+        p->error = "unterminated string";
+        return NULL;
+    }
+    p->cursor++;    // closing quote
+    text[length] = '\0';
+    return text;
+}
+
+// Elements of an array, or members of an object when close is '}'
+static int json_parse_members(json_parser_t *p, json_value_t *value, char close, int depth) {
+    size_t capacity = 0;
+    int is_object = (close == '}');
+
+    p->cursor++;
+    json_skip_space(p);
+    if (p->cursor < p->end && *p->cursor == close) {
+        p->cursor++;
+        return 0;
+    }
+
+    for (;;) {
+        if (value->count == capacity) {
+            capacity = capacity ? capacity * 2 : 8;
+            json_value_t *items = realloc(value->items, capacity * sizeof(json_value_t));
+            char **keys = is_object ? realloc(value->keys, capacity * sizeof(char *)) : NULL;
+            if (items) value->items = items;
+            if (keys) value->keys = keys;
+            if (!items || (is_object && !keys)) {
+                p->error = "out of memory";
+                return -1;
+            }
+        }
+
+        json_skip_space(p);
+        if (is_object) {
+            if (p->cursor >= p->end || *p->cursor != '"') {
+                p->error = "expected member name";
+                return -1;
+            }
+            char *key = json_parse_string(p);
+            if (!key) return -1;
+            value->keys[value->count] = key;
+            json_skip_space(p);
+            if (p->cursor >= p->end || *p->cursor != ':') {
+                memset(&value->items[value->count++], 0, sizeof(json_value_t));
+                p->error = "expected ':'";
+                return -1;
+            }
+            p->cursor++;
+        }
+
+        json_value_t *item = &value->items[value->count++];
+        if (json_parse_value(p, item, depth + 1) != 0) return -1;
+
+        json_skip_space(p);
+        if (p->cursor < p->end && *p->cursor == ',') {
+            p->cursor++;
+        } else if (p->cursor < p->end && *p->cursor == close) {
+            p->cursor++;
+            return 0;
+        } else {
+            p->error = is_object ? "expected ',' or '}'" : "expected ',' or ']'";
+            return -1;
+        }
+    }
+}
+
+static int json_parse_value(json_parser_t *p, json_value_t *value, int depth) {
+    memset(value, 0, sizeof(*value));
+    json_skip_space(p);
+    if (p->cursor >= p->end) {
+        p->error = "unexpected end of input";
+        return -1;
+    }
+    if (depth > 32) {
+        p->error = "nested too deeply";
+        return -1;
+    }
+
+    char c = *p->cursor;
+    if (c == '{') {
+        value->type = JSON_OBJECT;
+        return json_parse_members(p, value, '}', depth);
+    }
+    if (c == '[') {
+        value->type = JSON_ARRAY;
+        return json_parse_members(p, value, ']', depth);
+    }
+    if (c == '"') {
+        value->type = JSON_STRING;
+        value->string = json_parse_string(p);
+        return value->string ? 0 : -1;
+    }
+
+    static const struct { const char *word; json_type_t type; double number; } literals[] = {
+        { "null", JSON_NULL, 0 }, { "true", JSON_BOOL, 1 }, { "false", JSON_BOOL, 0 },
+    };
+    for (size_t i = 0; i < sizeof(literals) / sizeof(literals[0]); i++) {
+        size_t length = strlen(literals[i].word);
+        if ((size_t)(p->end - p->cursor) >= length && strncmp(p->cursor, literals[i].word, length) == 0) {
+            value->type = literals[i].type;
+            value->number = literals[i].number;
+            p->cursor += length;
+            return 0;
+        }
+    }
+
+    char *number_end;
+    value->type = JSON_NUMBER;
+    value->number = strtod(p->cursor, &number_end);
+    if (number_end == p->cursor) {
+        p->error = "unexpected character";
+        return -1;
+    }
+    p->cursor = number_end;
+    return 0;
+}
+
+static void json_free(json_value_t *value) {
+    for (size_t i = 0; i < value->count; i++) {
+        json_free(&value->items[i]);
+        if (value->keys) free(value->keys[i]);
+    }
+    free(value->items);
+    free(value->keys);
+    free(value->string);
+}
+
+static const json_value_t *json_get(const json_value_t *object, const char *key) {
+    if (object->type != JSON_OBJECT) return NULL;
+    for (size_t i = 0; i < object->count; i++) {
+        if (strcmp(object->keys[i], key) == 0) return &object->items[i];
+    }
+    return NULL;
+}
+
+static const char *json_get_string(const json_value_t *object, const char *key) {
+    const json_value_t *value = json_get(object, key);
+    return (value && value->type == JSON_STRING) ? value->string : "unknown";
+}
+
+// Result file: the document plus the header fields compared up front
+typedef struct {
+    const char *path;
+    json_value_t root;
+    const json_value_t *results;
+    const json_value_t *datasets;
+} result_file_t;
+
+static int load_result_file(const char *path, result_file_t *file) {
+    memset(file, 0, sizeof(*file));
+    file->path = path;
+
+    FILE *in = fopen(path, "rb");
+    if (!in) {
+        perror(path);
+        return -1;
+    }
+    char *text = malloc(MAX_FILE_SIZE + 1);
+    size_t length = text ? fread(text, 1, MAX_FILE_SIZE, in) : 0;
+    fclose(in);
+    if (!text || length == MAX_FILE_SIZE) {
+        fprintf(stderr, "%s: %s\n", path, text ? "file too large" : "out of memory");
+        free(text);
+        return -1;
+    }
+
+    text[length] = '\0';     // strtod stops here at the latest
+    json_parser_t parser = { text, text + length, NULL };
+    int result = json_parse_value(&parser, &file->root, 0);
+    if (result != 0) {
+        fprintf(stderr, "%s: invalid JSON at byte %zu: %s\n", path,
+                (size_t)(parser.cursor - text), parser.error);
+    }
+    free(text);
+    if (result != 0) return -1;
+
+    const json_value_t *version = json_get(&file->root, "schema_version");
+    if (!version || version->type != JSON_NUMBER) {
+        fprintf(stderr, "%s: no schema_version; rerun the benchmark to get a versioned file\n", path);
+        return -1;
+    }
+    if ((int)version->number != BENCH_RESULTS_SCHEMA_VERSION) {
+        fprintf(stderr, "%s: schema version %d, expected %d\n", path, (int)version->number,
+                BENCH_RESULTS_SCHEMA_VERSION);
+        return -1;
+    }
+
+    file->results = json_get(&file->root, "results");
+    file->datasets = json_get(&file->root, "datasets");
+    if (!file->results || file->results->type != JSON_ARRAY) {
+        fprintf(stderr, "%s: no results array\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// Timed samples of one result
+typedef struct {
+    int count;
+    double mean;
+    double variance;    // sample variance
+} sample_stats_t;
+
+static int result_stats(const json_value_t *result, sample_stats_t *stats) {
+    const json_value_t *seconds = json_get(result, "seconds");
+    memset(stats, 0, sizeof(*stats));
+    if (!seconds || seconds->type != JSON_ARRAY || seconds->count == 0) return -1;
+
+    double sum = 0.0, squares = 0.0;
+    for (size_t i = 0; i < seconds->count; i++) {
+        if (seconds->items[i].type != JSON_NUMBER) return -1;
+        sum += seconds->items[i].number;
+    }
+    stats->count = (int)seconds->count;
+    stats->mean = sum / stats->count;
+    for (size_t i = 0; i < seconds->count; i++) {
+        double d = seconds->items[i].number - stats->mean;
+        squares += d * d;
+    }
+    stats->variance = stats->count > 1 ? squares / (stats->count - 1) : 0.0;
+    return 0;
+}
+
+// Standard normal quantile (Abramowitz & Stegun 26.2.23, |error| < 4.5e-4)
+static double normal_quantile(double p) {
+    double q = p < 0.5 ? p : 1.0 - p;
+    double t = sqrt(-2.0 * log(q));
+    double z = t - (2.515517 + 0.802853 * t + 0.010328 * t * t) /
+                   (1.0 + 1.432788 * t + 0.189269 * t * t + 0.001308 * t * t * t);
+    return p < 0.5 ? -z : z;
+}
+
+// Student t quantile from the normal one (Abramowitz & Stegun 26.7.5)
+static double t_quantile(double p, double df) {
+    double z = normal_quantile(p);
+    double z2 = z * z, z3 = z2 * z, z5 = z3 * z2, z7 = z5 * z2, z9 = z7 * z2;
+    double g1 = (z3 + z) / 4.0;
+    double g2 = (5 * z5 + 16 * z3 + 3 * z) / 96.0;
+    double g3 = (3 * z7 + 19 * z5 + 17 * z3 - 15 * z) / 384.0;
+    double g4 = (79 * z9 + 776 * z7 + 1482 * z5 - 1920 * z3 - 945 * z) / 92160.0;
+    return z + g1 / df + g2 / (df * df) + g3 / (df * df * df) + g4 / (df * df * df * df);
+}
+
+typedef enum {
+    VERDICT_UNCHANGED,
+    VERDICT_SLOWER,             // significant, but smaller than the threshold
+    VERDICT_FASTER_SMALL,       // significant, but smaller than the threshold
+    VERDICT_FASTER,
+    VERDICT_REGRESSION,
+    VERDICT_TOO_FEW_SAMPLES,
+} verdict_t;
+
+static const char *const verdict_names[] = {
+    "no change", "slower, within threshold", "faster, within threshold", "faster",
+    "REGRESSION", "too few samples",
+};
+
+// Change of the new mean relative to the base mean, in percent, with its
+// confidence interval (Welch: unequal variances and sample counts)
+static verdict_t compare_samples(const sample_stats_t *base, const sample_stats_t *new,
+                                 double confidence, double threshold,
+                                 double *change, double *low, double *high) {
+    *change = (new->mean - base->mean) / base->mean * 100.0;
+    *low = *high = *change;
+    if (base->count < 2 || new->count < 2) return VERDICT_TOO_FEW_SAMPLES;
+
+    double vb = base->variance / base->count;
+    double vn = new->variance / new->count;
+    double se = sqrt(vb + vn);
+    if (se > 0.0) {
+        double df = (vb + vn) * (vb + vn) /
+                    (vb * vb / (base->count - 1) + vn * vn / (new->count - 1));
+        double margin = t_quantile(0.5 + confidence / 200.0, df) * se / base->mean * 100.0;
+        *low = *change - margin;
+        *high = *change + margin;
+    }
+
+    // Significance from the interval, size from the mean change
+    if (*low > 0.0) return (*change > threshold) ? VERDICT_REGRESSION : VERDICT_SLOWER;
+    if (*high < 0.0) return (*change < -threshold) ? VERDICT_FASTER : VERDICT_FASTER_SMALL;
+    return VERDICT_UNCHANGED;
+}
+
+// Same capture paths must have the same content
+static int check_datasets(const result_file_t *base, const result_file_t *new) {
+    int mismatches = 0;
+    if (!base->datasets || !new->datasets) return 0;
+
+    for (size_t i = 0; i < base->datasets->count; i++) {
+        const json_value_t *b = &base->datasets->items[i];
+        for (size_t j = 0; j < new->datasets->count; j++) {
+            const json_value_t *n = &new->datasets->items[j];
+            if (strcmp(json_get_string(b, "path"), json_get_string(n, "path")) == 0 &&
+                strcmp(json_get_string(b, "hash"), json_get_string(n, "hash")) != 0) {
+                fprintf(stderr, "Dataset %s differs: %s vs %s\n", json_get_string(b, "path"),
+                        json_get_string(b, "hash"), json_get_string(n, "hash"));
+                mismatches++;
+            }
+        }
+    }
+    return mismatches;
+}
+
+void print_usage(const char *prog_name) {
+    printf("Usage: %s [-c confidence] [-t threshold] [-f] <base.json> <new.json>\n", prog_name);
+    printf("Flag results whose mean time grew significantly between two benchmark runs\n");
+    printf("  -c <percent>  Confidence level of the intervals (default: %.0f)\n", DEFAULT_CONFIDENCE);
+    printf("  -t <percent>  Smallest slowdown that counts as a regression (default: %.1f)\n",
+           DEFAULT_THRESHOLD);
+    printf("  -f            Compare even if a capture's content hash changed\n");
+}
+
+int main(int argc, char *argv[]) {
+    double confidence = DEFAULT_CONFIDENCE;
+    double threshold = DEFAULT_THRESHOLD;
+    int force = 0;
+    const char *paths[2];
+    int path_count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            confidence = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-f") == 0) {
+            force = 1;
+        } else if (argv[i][0] != '-' && path_count < 2) {
+            paths[path_count++] = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+    if (path_count != 2 || confidence < 50.0 || confidence >= 100.0 || threshold < 0.0) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    result_file_t base, new;
+    if (load_result_file(paths[0], &base) != 0) {
+        json_free(&base.root);
+        return 2;
+    }
+    if (load_result_file(paths[1], &new) != 0) {
+        json_free(&base.root);
+        json_free(&new.root);
+        return 2;
+    }
+
+    int status = 0;
+    const char *base_benchmark = json_get_string(&base.root, "benchmark");
+    if (strcmp(base_benchmark, json_get_string(&new.root, "benchmark")) != 0) {
+        fprintf(stderr, "Different benchmarks: %s vs %s\n", base_benchmark,
+                json_get_string(&new.root, "benchmark"));
+        status = 2;
+    } else if (check_datasets(&base, &new) && !force) {
+        fprintf(stderr, "Captures changed between runs; use -f to compare anyway\n");
+        status = 2;
+    }
+
+    if (status == 0) {
+        printf("=== %s benchmark: %s -> %s ===\n", base_benchmark,
+               json_get_string(&base.root, "git_revision"), json_get_string(&new.root, "git_revision"));
+        printf("Base: %s, %s kernels, %s\n", json_get_string(&base.root, "cpu_model"),
+               json_get_string(&base.root, "cpu_kernels"), json_get_string(&base.root, "timestamp"));
+        printf("New:  %s, %s kernels, %s\n", json_get_string(&new.root, "cpu_model"),
+               json_get_string(&new.root, "cpu_kernels"), json_get_string(&new.root, "timestamp"));
+        if (strcmp(json_get_string(&base.root, "cpu_model"), json_get_string(&new.root, "cpu_model")) != 0 ||
+            strcmp(json_get_string(&base.root, "cpu_kernels"), json_get_string(&new.root, "cpu_kernels")) != 0) {
+            printf("Warning: runs are from different CPUs or kernels\n");
+        }
+        printf("Mean time, %.0f%% confidence interval of the change, regression above +%.1f%%\n\n",
+               confidence, threshold);
+        printf("%-32s %11s %11s %9s %21s  %s\n", "Result", "Base ms", "New ms", "Change",
+               "Interval", "Verdict");
+
+        int regressions = 0, compared = 0;
+        for (size_t i = 0; i < new.results->count; i++) {
+            const json_value_t *n = &new.results->items[i];
+            const char *name = json_get_string(n, "name");
+            const json_value_t *b = NULL;
+            for (size_t j = 0; j < base.results->count && !b; j++) {
+                if (strcmp(name, json_get_string(&base.results->items[j], "name")) == 0) {
+                    b = &base.results->items[j];
+                }
+            }
+
+            sample_stats_t base_stats, new_stats;
+            if (!b || result_stats(b, &base_stats) != 0 || result_stats(n, &new_stats) != 0 ||
+                base_stats.mean <= 0.0) {
+                printf("%-32s %11s %11s %9s %21s  %s\n", name, "-", "-", "-", "-",
+                       b ? "no samples" : "new result");
+                continue;
+            }
+
+            double change, low, high;
+            verdict_t verdict = compare_samples(&base_stats, &new_stats, confidence, threshold,
+                                                &change, &low, &high);
+            char interval[32];
+            snprintf(interval, sizeof(interval), "[%+.1f%%, %+.1f%%]", low, high);
+            printf("%-32s %11.3f %11.3f %+8.1f%% %21s  %s\n", name, base_stats.mean * 1e3,
+                   new_stats.mean * 1e3, change, interval, verdict_names[verdict]);
+
+            compared++;
+            if (verdict == VERDICT_REGRESSION) regressions++;
+        }
+
+        printf("\n%d of %d results regressed\n", regressions, compared);
+        status = regressions ? 1 : 0;
+    }
+
+    json_free(&base.root);
+    json_free(&new.root);
+    return status;
+}
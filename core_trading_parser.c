@@ -7,6 +7,7 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <time.h>
+#include "src/include/iex_tp.h"
 
 #define PCAPNG_MAGIC 0x0a0d0d0a
 #define PCAPNG_EPB_TYPE 0x00000006
@@ -41,48 +42,39 @@ void extract_symbol(const uint8_t *symbol_bytes, char *output) {
 
 // Convert IEX timestamp to readable format
 void format_timestamp(uint64_t iex_time, char *output) {
-    // IEX timestamps are in nanoseconds since midnight
+    // IEX timestamps are nanoseconds since the POSIX epoch; show UTC time of day
+    iex_time %= 86400ULL * 1000000000;
     uint64_t hours = iex_time / (3600ULL * 1000000000);
     uint64_t minutes = (iex_time % (3600ULL * 1000000000)) / (60ULL * 1000000000);
     uint64_t seconds = (iex_time % (60ULL * 1000000000)) / 1000000000;
     uint64_t nanos = iex_time % 1000000000;
     
-    snprintf(output, 32, "%02llu:%02llu:%02llu.%09llu", hours, minutes, seconds, nanos);
+    snprintf(output, 32, "%02llu:%02llu:%02llu.%09llu", (unsigned long long)hours,
+             (unsigned long long)minutes, (unsigned long long)seconds, (unsigned long long)nanos);
 }
 
 // Parse Trade Report message (0x54)
 void parse_trade_report(const uint8_t *data, size_t offset) {
     const uint8_t *msg = &data[offset];
     
-    // IEX Trade Report format:
-    // Byte 0: Message Type (0x54)
-    // Bytes 1-8: Timestamp  
-    // Bytes 9-16: Symbol
-    // Bytes 17-20: Price (32-bit, scaled)
-    // Bytes 21-24: Size
-    // Byte 25: Sale Condition
-    
+    // Layout: iex_trade_report_t (src/include/iex_schema.h)
     if (msg[0] != 0x54) return;
     
-    uint64_t timestamp = *(uint64_t*)(msg + 1);
-    const uint8_t *symbol_bytes = msg + 9;
-    uint32_t price_raw = *(uint32_t*)(msg + 17);
-    uint32_t size = *(uint32_t*)(msg + 21);
-    uint8_t sale_condition = msg[25];
+    uint8_t sale_condition = msg[IEX_MSG_FLAGS_OFFSET];
+    uint64_t timestamp = iex_msg_timestamp(msg);
+    const uint8_t *symbol_bytes = msg + IEX_MSG_SYMBOL_OFFSET;
+    uint32_t size = iex_trade_report_size(msg);
+    int64_t price_raw = iex_trade_report_price(msg);
     
     char symbol[16];
     char time_str[32];
+    char price[IEX_PRICE_TEXT_MAX];
     extract_symbol(symbol_bytes, symbol);
     format_timestamp(timestamp, time_str);
     
-    // IEX prices are in 1/10000 of a dollar
-    double price = (double)price_raw / 10000.0;
-    
-    // Only show reasonable prices and valid symbols
-    if (price > 0.01 && price < 10000.0 && strlen(symbol) > 0) {
-        printf("TRADE | %-8s | %s | $%8.4f | %10u | %c\n",
-               symbol, time_str, price, size, 
-               (sale_condition >= 32 && sale_condition <= 126) ? sale_condition : ' ');
+    if (strlen(symbol) > 0) {
+        printf("TRADE | %-8s | %s | $%8s | %10u | flags 0x%02x\n",
+               symbol, time_str, iex_price_text(price_raw, price), size, sale_condition);
     }
 }
 
@@ -90,37 +82,28 @@ void parse_trade_report(const uint8_t *data, size_t offset) {
 void parse_quote_update(const uint8_t *data, size_t offset) {
     const uint8_t *msg = &data[offset];
     
-    // IEX Quote Update format:
-    // Byte 0: Message Type (0x51)
-    // Bytes 1-8: Timestamp
-    // Bytes 9-16: Symbol  
-    // Bytes 17-20: Bid Price
-    // Bytes 21-24: Bid Size
-    // Bytes 25-28: Ask Price
-    // Bytes 29-32: Ask Size
-    
+    // Layout: iex_quote_update_t (src/include/iex_schema.h)
     if (msg[0] != 0x51) return;
     
-    uint64_t timestamp = *(uint64_t*)(msg + 1);
-    const uint8_t *symbol_bytes = msg + 9;
-    uint32_t bid_price_raw = *(uint32_t*)(msg + 17);
-    uint32_t bid_size = *(uint32_t*)(msg + 21);
-    uint32_t ask_price_raw = *(uint32_t*)(msg + 25);
-    uint32_t ask_size = *(uint32_t*)(msg + 29);
+    uint64_t timestamp = iex_msg_timestamp(msg);
+    const uint8_t *symbol_bytes = msg + IEX_MSG_SYMBOL_OFFSET;
+    uint32_t bid_size = iex_quote_update_bid_size(msg);
+    int64_t bid_price_raw = iex_quote_update_bid_price(msg);
+    int64_t ask_price_raw = iex_quote_update_ask_price(msg);
+    uint32_t ask_size = iex_quote_update_ask_size(msg);
     
     char symbol[16];
     char time_str[32];
+    char bid_price[IEX_PRICE_TEXT_MAX], ask_price[IEX_PRICE_TEXT_MAX], spread[IEX_PRICE_TEXT_MAX];
     extract_symbol(symbol_bytes, symbol);
     format_timestamp(timestamp, time_str);
     
-    double bid_price = (double)bid_price_raw / 10000.0;
-    double ask_price = (double)ask_price_raw / 10000.0;
-    
-    // Show valid quotes
-    if (bid_price > 0.01 && ask_price > 0.01 && ask_price > bid_price && strlen(symbol) > 0) {
-        double spread = ask_price - bid_price;
-        printf("QUOTE | %-8s | %s | $%8.4f x %6u | $%8.4f x %6u | Spread:$%.4f\n",
-               symbol, time_str, bid_price, bid_size, ask_price, ask_size, spread);
+    // Show two-sided quotes
+    if (bid_size > 0 && ask_size > 0 && strlen(symbol) > 0) {
+        printf("QUOTE | %-8s | %s | $%8s x %6u | $%8s x %6u | Spread:$%s\n",
+               symbol, time_str, iex_price_text(bid_price_raw, bid_price), bid_size,
+               iex_price_text(ask_price_raw, ask_price), ask_size,
+               iex_price_text(ask_price_raw - bid_price_raw, spread));
     }
 }
 
@@ -130,60 +113,55 @@ void parse_official_price(const uint8_t *data, size_t offset) {
     
     if (msg[0] != 0x58) return;
     
-    uint64_t timestamp = *(uint64_t*)(msg + 1);
-    const uint8_t *symbol_bytes = msg + 9;
-    uint32_t official_price_raw = *(uint32_t*)(msg + 17);
+    uint64_t timestamp = iex_msg_timestamp(msg);
+    const uint8_t *symbol_bytes = msg + IEX_MSG_SYMBOL_OFFSET;
+    int64_t official_price_raw = iex_official_price_price(msg);
     
     char symbol[16];
     char time_str[32];
+    char official_price[IEX_PRICE_TEXT_MAX];
     extract_symbol(symbol_bytes, symbol);
     format_timestamp(timestamp, time_str);
     
-    double official_price = (double)official_price_raw / 10000.0;
-    
-    if (official_price > 0.01 && strlen(symbol) > 0) {
-        printf("OFFCL | %-8s | %s | $%8.4f (Official)\n",
-               symbol, time_str, official_price);
+    if (strlen(symbol) > 0) {
+        printf("OFFCL | %-8s | %s | $%8s (Official %s)\n",
+               symbol, time_str, iex_price_text(official_price_raw, official_price),
+               msg[IEX_MSG_FLAGS_OFFSET] == 'Q' ? "open" : "close");
     }
 }
 
-// Analyze UDP payload for core trading messages
+// Walk the IEX-TP segment for core trading messages
 void parse_core_trading_data(const uint8_t *udp_payload, size_t len) {
     int trade_count = 0, quote_count = 0, official_count = 0;
     
-    // Look for properly aligned IEX messages
-    for (size_t i = 0; i < len - 35; i++) {
-        uint8_t msg_type = udp_payload[i];
-        
-        // Verify this looks like a real message by checking symbol area
-        if (i + 35 < len) {
-            const uint8_t *symbol_area = &udp_payload[i + 9];
-            
-            // Check if symbol starts with a letter (basic validation)
-            if (symbol_area[0] >= 'A' && symbol_area[0] <= 'Z') {
-                switch (msg_type) {
-                    case 0x54: // Trade Report
-                        if (trade_count < 10) {
-                            parse_trade_report(udp_payload, i);
-                            trade_count++;
-                        }
-                        break;
-                        
-                    case 0x51: // Quote Update
-                        if (quote_count < 5) {
-                            parse_quote_update(udp_payload, i);
-                            quote_count++;
-                        }
-                        break;
-                        
-                    case 0x58: // Official Price
-                        if (official_count < 5) {
-                            parse_official_price(udp_payload, i);
-                            official_count++;
-                        }
-                        break;
+    iex_tp_segment_t seg;
+    if (iex_tp_segment_init(&seg, udp_payload, len) != 0) return;
+    
+    const uint8_t *msg;
+    uint16_t msg_len;
+    
+    while ((msg = iex_tp_next_message(&seg, &msg_len)) != NULL) {
+        switch (msg[IEX_MSG_TYPE_OFFSET]) {
+            case 0x54: // Trade Report
+                if (trade_count < 10 && msg_len >= IEX_LENGTH(trade_report)) {
+                    parse_trade_report(msg, 0);
+                    trade_count++;
                 }
-            }
+                break;
+                
+            case 0x51: // Quote Update
+                if (quote_count < 5 && msg_len >= IEX_LENGTH(quote_update)) {
+                    parse_quote_update(msg, 0);
+                    quote_count++;
+                }
+                break;
+                
+            case 0x58: // Official Price
+                if (official_count < 5 && msg_len >= IEX_LENGTH(official_price)) {
+                    parse_official_price(msg, 0);
+                    official_count++;
+                }
+                break;
         }
     }
     
@@ -242,11 +220,11 @@ int main(int argc, char *argv[]) {
             pcapng_epb_t *epb = (pcapng_epb_t *)data_ptr;
             uint8_t *packet_data = data_ptr + sizeof(pcapng_epb_t);
             
-            // Focus on large packets with trading data
-            if (epb->captured_len > 1000) {
-                const uint8_t *udp_payload = packet_data + 42;
-                size_t payload_len = epb->captured_len - 42;
-                
+            size_t payload_len;
+            const uint8_t *udp_payload = iex_udp_payload(packet_data, epb->captured_len, &payload_len);
+            
+            // Focus on segments carrying messages (skip heartbeats)
+            if (udp_payload && iex_tp_message_count(udp_payload, payload_len) > 0) {
                 printf("\n--- Packet %d (%u bytes) ---\n", 
                        large_packets_processed + 1, epb->captured_len);
                 parse_core_trading_data(udp_payload, payload_len);
@@ -6,6 +6,7 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include "src/include/iex_tp.h"
 
 #define PCAPNG_MAGIC 0x0a0d0d0a
 #define PCAPNG_EPB_TYPE 0x00000006
@@ -36,11 +37,10 @@ void analyze_packet(const uint8_t *packet_data, size_t len) {
     printf("\n=== Packet Analysis ===\n");
     printf("Total length: %zu bytes\n", len);
     
-    if (len < 42) return;
-    
-    // Skip to UDP payload (Ethernet 14 + IP ~20 + UDP 8 = ~42)
-    const uint8_t *udp_payload = packet_data + 42;
-    size_t payload_len = len - 42;
+    // Locate the UDP payload (Ethernet, optional VLAN tag, IPv4, UDP)
+    size_t payload_len;
+    const uint8_t *udp_payload = iex_udp_payload(packet_data, len, &payload_len);
+    if (!udp_payload) return;
     
     printf("UDP payload length: %zu bytes\n", payload_len);
     
@@ -116,27 +116,24 @@ void decode_symbol(const uint8_t *symbol_data, char *output) {
     output[len] = '\0';
 }
 
-// Convert IEX price format (little endian)
-double decode_price(uint32_t price_raw) {
-    return (double)price_raw / 10000.0;  // IEX prices in 1/10000ths
-}
-
 // Decode IEX Trade Report message
 void decode_trade_message(const uint8_t *data, size_t offset) {
     if (data[offset] != 0x54) return;  // Not a trade message
     
     const uint8_t *msg = &data[offset];
-    uint64_t timestamp = *(uint64_t*)(msg + 1);  // 8-byte timestamp
-    const uint8_t *symbol = msg + 9;              // Symbol at offset 9
-    uint32_t price = *(uint32_t*)(msg + 17);      // Price at offset 17
-    uint32_t size = *(uint32_t*)(msg + 21);       // Size at offset 21
-    uint8_t side = msg[25];                       // Side at offset 25
-    
-    char ticker[16];
+    uint8_t flags = msg[IEX_MSG_FLAGS_OFFSET];
+    uint64_t timestamp = iex_msg_timestamp(msg);
+    const uint8_t *symbol = msg + IEX_MSG_SYMBOL_OFFSET;
+    uint32_t size = iex_trade_report_size(msg);
+    int64_t price = iex_trade_report_price(msg);
+    uint64_t trade_id = iex_trade_report_trade_id(msg);
+    
+    char ticker[16], price_text[IEX_PRICE_TEXT_MAX];
     decode_symbol(symbol, ticker);
     
-    printf("TRADE: %-8s  $%-8.4f  %8u shares  %c  (ts:%llu)\n",
-           ticker, decode_price(price), size, side, timestamp);
+    printf("TRADE: %-8s  $%-8s  %8u shares  flags:0x%02x  id:%llu  (ts:%llu)\n",
+           ticker, iex_price_text(price, price_text), size, flags,
+           (unsigned long long)trade_id, (unsigned long long)timestamp);
 }
 
 // Decode IEX Quote Update message  
@@ -144,52 +141,54 @@ void decode_quote_message(const uint8_t *data, size_t offset) {
     if (data[offset] != 0x51) return;  // Not a quote message
     
     const uint8_t *msg = &data[offset];
-    uint64_t timestamp = *(uint64_t*)(msg + 1);
-    const uint8_t *symbol = msg + 9;
-    uint32_t bid_price = *(uint32_t*)(msg + 17);
-    uint32_t bid_size = *(uint32_t*)(msg + 21);
-    uint32_t ask_price = *(uint32_t*)(msg + 25);
-    uint32_t ask_size = *(uint32_t*)(msg + 29);
-    
-    char ticker[16];
+    uint64_t timestamp = iex_msg_timestamp(msg);
+    const uint8_t *symbol = msg + IEX_MSG_SYMBOL_OFFSET;
+    uint32_t bid_size = iex_quote_update_bid_size(msg);
+    int64_t bid_price = iex_quote_update_bid_price(msg);
+    int64_t ask_price = iex_quote_update_ask_price(msg);
+    uint32_t ask_size = iex_quote_update_ask_size(msg);
+    
+    char ticker[16], bid_text[IEX_PRICE_TEXT_MAX], ask_text[IEX_PRICE_TEXT_MAX];
     decode_symbol(symbol, ticker);
     
-    printf("QUOTE: %-8s  Bid:$%-8.4f x%-6u  Ask:$%-8.4f x%-6u  (ts:%llu)\n",
-           ticker, decode_price(bid_price), bid_size, 
-           decode_price(ask_price), ask_size, timestamp);
+    printf("QUOTE: %-8s  Bid:$%-8s x%-6u  Ask:$%-8s x%-6u  (ts:%llu)\n",
+           ticker, iex_price_text(bid_price, bid_text), bid_size, 
+           iex_price_text(ask_price, ask_text), ask_size, (unsigned long long)timestamp);
 }
 
 // Analyze UDP payload for IEX messages
 void analyze_iex_payload(const uint8_t *udp_payload, size_t len) {
     printf("\n=== IEX Message Analysis ===\n");
     
+    iex_tp_segment_t seg;
+    if (iex_tp_segment_init(&seg, udp_payload, len) != 0) {
+        printf("Not an IEX-TP segment (%zu bytes)\n", len);
+        return;
+    }
+    
+    printf("Segment: protocol 0x%04x (%s), %u messages, first seq %llu\n",
+           seg.header->message_protocol_id, iex_schema_name(seg.header->message_protocol_id),
+           seg.remaining,
+           (unsigned long long)seg.sequence);
+    
     int message_count = 0;
+    const uint8_t *msg;
+    uint16_t msg_len;
     
-    // Look for message patterns - they seem to start after timestamp patterns
-    for (size_t i = 0; i < len - 30; i++) {
-        uint8_t msg_type = udp_payload[i];
+    // Walk the length-prefixed message blocks
+    while ((msg = iex_tp_next_message(&seg, &msg_len)) != NULL) {
+        uint8_t msg_type = msg[IEX_MSG_TYPE_OFFSET];
         
-        // Check for Trade Report (0x54)
-        if (msg_type == 0x54 && i + 26 < len) {
-            // Verify this looks like a real message by checking symbol area
-            const uint8_t *symbol_area = &udp_payload[i + 9];
-            if (symbol_area[0] >= 'A' && symbol_area[0] <= 'Z') {
-                decode_trade_message(udp_payload, i);
-                message_count++;
-                if (message_count >= 10) break;  // Limit output
-            }
+        if (msg_type == IEX_TRADE_REPORT && msg_len >= IEX_LENGTH(trade_report)) {
+            decode_trade_message(msg, 0);
+        } else if (msg_type == IEX_QUOTE_UPDATE && msg_len >= IEX_LENGTH(quote_update)) {
+            decode_quote_message(msg, 0);
+        } else {
+            continue;
         }
         
-        // Check for Quote Update (0x51)
-        else if (msg_type == 0x51 && i + 33 < len) {
-            const uint8_t *symbol_area = &udp_payload[i + 9];
-            if (symbol_area[0] >= 'A' && symbol_area[0] <= 'Z') {
-                decode_quote_message(udp_payload, i);
-                message_count++;
-                if (message_count >= 10) break;
-            }
-        }
+        if (++message_count >= 10) break;  // Limit output
     }
     
     printf("Found %d decodable messages\n", message_count);
-}
\ No newline at end of file
+}
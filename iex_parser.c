@@ -6,6 +6,7 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include "src/include/iex_tp.h"
 
 #define PCAPNG_MAGIC 0x0a0d0d0a
 #define PCAPNG_EPB_TYPE 0x00000006
@@ -37,68 +38,56 @@ void extract_clean_symbol(const uint8_t *symbol_bytes, char *output, int max_len
     output[len] = '\0';
 }
 
-// Debug analysis of quote message structure
-void debug_quote_structure(const uint8_t *data, size_t quote_offset, const char *symbol, int debug_mode) {
+// Debug dump of a framed quote message
+void debug_quote_structure(const uint8_t *msg, uint16_t msg_len, uint16_t protocol_id,
+                           const char *symbol, int debug_mode) {
     if (!debug_mode) return;
     
-    printf("\n=== DEBUG: Quote structure for %s at offset %zu ===\n", symbol, quote_offset);
+    printf("\n=== DEBUG: Quote structure for %s (%u bytes) ===\n", symbol, msg_len);
     printf("Hex: ");
-    for (int i = 0; i < 40; i++) {
-        printf("%02x ", data[quote_offset + i]);
+    for (int i = 0; i < msg_len; i++) {
+        printf("%02x ", msg[i]);
         if ((i + 1) % 8 == 0) printf(" ");
     }
     printf("\nASCII: ");
-    for (int i = 0; i < 40; i++) {
-        uint8_t c = data[quote_offset + i];
+    for (int i = 0; i < msg_len; i++) {
+        uint8_t c = msg[i];
         printf("%c", (c >= 32 && c <= 126) ? c : '.');
     }
     printf("\n");
     
-    // Try different interpretations
-    for (int offset = 8; offset <= 24; offset += 4) {
-        uint32_t val1 = *(uint32_t*)(data + quote_offset + offset);
-        uint32_t val2 = *(uint32_t*)(data + quote_offset + offset + 4);
-        uint32_t val3 = *(uint32_t*)(data + quote_offset + offset + 8);
-        uint32_t val4 = *(uint32_t*)(data + quote_offset + offset + 12);
-        
-        printf("Offset +%02d: %10u %10u %10u %10u\n", offset, val1, val2, val3, val4);
-        printf("    /100:   $%8.2f  %8u   $%8.2f  %8u\n", 
-               (double)val1/100.0, val2, (double)val3/100.0, val4);
-        printf("  /10000:   $%8.4f  %8u   $%8.4f  %8u\n", 
-               (double)val1/10000.0, val2, (double)val3/10000.0, val4);
-    }
+    iex_print_message(stdout, msg, msg_len, protocol_id);
 }
 
-// Search for all message types (analysis mode)
+// Count all message types (analysis mode)
 void search_message_types(const uint8_t *udp_payload, size_t len, int show_details) {
     int trade_count = 0, quote_count = 0, other_counts[256] = {0};
     
-    printf("Searching for IEX message types in %zu bytes...\n", len);
+    iex_tp_segment_t seg;
+    if (iex_tp_segment_init(&seg, udp_payload, len) != 0) {
+        printf("Not an IEX-TP segment (%zu bytes)\n", len);
+        return;
+    }
+    
+    printf("Walking %u IEX-TP messages (%s, first seq %llu) in %zu bytes...\n",
+           seg.remaining, iex_schema_name(seg.header->message_protocol_id),
+           (unsigned long long)seg.sequence, len);
+    
+    const uint8_t *msg;
+    uint16_t msg_len;
     
-    for (size_t i = 0; i < len - 30; i++) {
-        uint8_t msg_type = udp_payload[i];
+    while ((msg = iex_tp_next_message(&seg, &msg_len)) != NULL) {
+        uint8_t msg_type = msg[IEX_MSG_TYPE_OFFSET];
         
-        if (msg_type >= 0x40 && msg_type <= 0x58) {
-            for (int offset = 1; offset <= 8; offset++) {
-                if (i + offset + 8 < len) {
-                    const uint8_t *potential_symbol = &udp_payload[i + offset];
-                    if (potential_symbol[0] >= 'A' && potential_symbol[0] <= 'Z' &&
-                        potential_symbol[1] >= 'A' && potential_symbol[1] <= 'Z') {
-                        
-                        other_counts[msg_type]++;
-                        if (msg_type == 0x54) trade_count++;
-                        else if (msg_type == 0x51) quote_count++;
-                        
-                        if (show_details && other_counts[msg_type] <= 3) {
-                            char symbol[16];
-                            extract_clean_symbol(potential_symbol, symbol, sizeof(symbol));
-                            if (strlen(symbol) > 0) {
-                                printf("Found 0x%02X: %s at offset %zu\n", msg_type, symbol, i);
-                            }
-                        }
-                        break;
-                    }
-                }
+        other_counts[msg_type]++;
+        if (msg_type == IEX_TRADE_REPORT) trade_count++;
+        else if (msg_type == IEX_QUOTE_UPDATE) quote_count++;
+        
+        if (show_details && other_counts[msg_type] <= 3) {
+            printf("Found 0x%02X (seq %llu, %u bytes): ", msg_type,
+                   (unsigned long long)(seg.sequence - 1), msg_len);
+            if (iex_print_message(stdout, msg, msg_len, seg.header->message_protocol_id) != 0) {
+                printf("not in schema\n");
             }
         }
     }
@@ -106,17 +95,7 @@ void search_message_types(const uint8_t *udp_payload, size_t len, int show_detai
     printf("\nMessage type summary:\n");
     for (int i = 0; i < 256; i++) {
         if (other_counts[i] > 0) {
-            const char* desc = "";
-            switch(i) {
-                case 0x51: desc = "Quote Update"; break;
-                case 0x54: desc = "Trade Report"; break;
-                case 0x53: desc = "System Event"; break;
-                case 0x44: desc = "Security Directory"; break;
-                case 0x48: desc = "Trading Status"; break;
-                case 0x41: desc = "Auction Info"; break;
-                default: desc = "Other"; break;
-            }
-            printf("0x%02X (%s): %d occurrences\n", i, desc, other_counts[i]);
+            printf("0x%02X (%s): %d occurrences\n", i, iex_message_name((uint8_t)i), other_counts[i]);
         }
     }
     printf("Total: %d trades, %d quotes found\n", trade_count, quote_count);
@@ -135,117 +114,60 @@ void extract_comprehensive_data(const uint8_t *udp_payload, size_t len, int mode
     
     int quote_count = 0, trade_count = 0, active_quotes = 0;
     
-    for (size_t i = 0; i < len - 40; i++) {
-        uint8_t msg_type = udp_payload[i];
+    iex_tp_segment_t seg;
+    if (iex_tp_segment_init(&seg, udp_payload, len) != 0) {
+        printf("Not an IEX-TP segment (%zu bytes)\n", len);
+        return;
+    }
+    
+    const uint8_t *msg;
+    uint16_t msg_len;
+    
+    while ((msg = iex_tp_next_message(&seg, &msg_len)) != NULL) {
+        uint8_t msg_type = msg[IEX_MSG_TYPE_OFFSET];
         
         // Parse Quote Updates (0x51)
-        if (msg_type == 0x51 && quote_count < 25) {
-            const uint8_t *quote_msg = &udp_payload[i];
+        if (msg_type == IEX_QUOTE_UPDATE && msg_len >= IEX_LENGTH(quote_update) && quote_count < 25) {
+            char symbol[16];
+            extract_clean_symbol(msg + IEX_MSG_SYMBOL_OFFSET, symbol, sizeof(symbol));
             
-            if (i + 32 < len) {
-                const uint8_t *symbol_area = &quote_msg[8];
-                
-                if (symbol_area[0] >= 'A' && symbol_area[0] <= 'Z') {
-                    char symbol[16];
-                    extract_clean_symbol(symbol_area, symbol, sizeof(symbol));
-                    
-                    if (strlen(symbol) >= 1) {
-                        if (debug_mode && quote_count < 3) {
-                            debug_quote_structure(udp_payload, i, symbol, debug_mode);
-                        }
-                        
-                        // Check for active quote data
-                        int has_quote_data = 0;
-                        for (int j = 16; j < 32 && i + j < len; j++) {
-                            if (quote_msg[j] != 0) {
-                                has_quote_data = 1;
-                                break;
-                            }
-                        }
-                        
-                        if (has_quote_data) {
-                            // Try to extract bid/ask data with multiple formats
-                            uint32_t val1 = *(uint32_t*)(&quote_msg[16]);
-                            uint32_t val2 = *(uint32_t*)(&quote_msg[20]);
-                            uint32_t val3 = *(uint32_t*)(&quote_msg[24]);
-                            uint32_t val4 = *(uint32_t*)(&quote_msg[28]);
-                            
-                            // Try different price scaling patterns
-                            int found_valid_quote = 0;
-                            
-                            // Pattern 1: bid_size, bid_price, ask_price, ask_size
-                            double bid_price = (double)val2 / 10000.0;
-                            double ask_price = (double)val3 / 10000.0;
-                            
-                            if (bid_price > 0.01 && ask_price > bid_price && ask_price < 1000.0 && 
-                                val1 > 0 && val4 > 0) {
-                                printf("%-8s | QUOTE | $%8.4f | %10u | $%8.4f | %10u |             |            | Active bid/ask\n",
-                                       symbol, bid_price, val1, ask_price, val4);
-                                active_quotes++;
-                                found_valid_quote = 1;
-                            } else {
-                                // Pattern 2: Different scaling
-                                bid_price = (double)val2 / 100.0;
-                                ask_price = (double)val3 / 100.0;
-                                if (bid_price > 0.01 && ask_price > bid_price && ask_price < 1000.0 && 
-                                    val1 > 0 && val4 > 0) {
-                                    printf("%-8s | QUOTE | $%8.2f | %10u | $%8.2f | %10u |             |            | Active bid/ask\n",
-                                           symbol, bid_price, val1, ask_price, val4);
-                                    active_quotes++;
-                                    found_valid_quote = 1;
-                                }
-                            }
-                            
-                            if (!found_valid_quote) {
-                                if (debug_mode) {
-                                    printf("%-8s | QUOTE | (complex quote data)           |             |            | Raw: %u %u %u %u\n",
-                                           symbol, val1, val2, val3, val4);
-                                } else {
-                                    printf("%-8s | QUOTE | (inactive quote)               |             |            | Zero bid/ask\n", symbol);
-                                }
-                            }
-                        } else {
-                            printf("%-8s | QUOTE | (quote deletion)               |             |            | Market cleanup\n", symbol);
-                        }
-                        quote_count++;
-                    }
-                }
+            if (debug_mode && quote_count < 3) {
+                debug_quote_structure(msg, msg_len, seg.header->message_protocol_id, symbol, debug_mode);
+            }
+            
+            uint32_t bid_size = iex_quote_update_bid_size(msg);
+            int64_t bid_price = iex_quote_update_bid_price(msg);
+            int64_t ask_price = iex_quote_update_ask_price(msg);
+            uint32_t ask_size = iex_quote_update_ask_size(msg);
+            
+            char bid_text[IEX_PRICE_TEXT_MAX], ask_text[IEX_PRICE_TEXT_MAX];
+            iex_price_text(bid_price, bid_text);
+            iex_price_text(ask_price, ask_text);
+            if (bid_size > 0 && ask_size > 0) {
+                printf("%-8s | QUOTE | $%8s | %10u | $%8s | %10u |             |            | Active bid/ask\n",
+                       symbol, bid_text, bid_size, ask_text, ask_size);
+                active_quotes++;
+            } else if (bid_size > 0 || ask_size > 0) {
+                printf("%-8s | QUOTE | $%8s | %10u | $%8s | %10u |             |            | One-sided\n",
+                       symbol, bid_text, bid_size, ask_text, ask_size);
+            } else {
+                printf("%-8s | QUOTE | (quote deletion)               |             |            | Zero bid/ask\n", symbol);
             }
+            quote_count++;
         }
         
         // Parse Trade Reports (0x54)
-        else if (msg_type == 0x54 && trade_count < 25) {
-            for (int offset = 1; offset <= 8; offset++) {
-                if (i + offset + 16 < len) {
-                    const uint8_t *symbol_area = &udp_payload[i + offset];
-                    if (symbol_area[0] >= 'A' && symbol_area[0] <= 'Z') {
-                        char symbol[16];
-                        extract_clean_symbol(symbol_area, symbol, sizeof(symbol));
-                        
-                        if (strlen(symbol) >= 1) {
-                            for (int data_offset = 8; data_offset <= 16; data_offset += 4) {
-                                if (i + offset + data_offset + 8 < len) {
-                                    uint32_t price_raw = *(uint32_t*)(symbol_area + data_offset);
-                                    uint32_t size = *(uint32_t*)(symbol_area + data_offset + 4);
-                                    
-                                    double price = (double)price_raw / 10000.0;
-                                    if (price < 0.01 || price > 1000.0) {
-                                        price = (double)price_raw / 100.0;
-                                    }
-                                    
-                                    if (price > 0.01 && price < 1000.0 && size > 0 && size < 1000000000) {
-                                        printf("%-8s | TRADE |           |            |           |            | $%10.4f | %10u | Execution\n",
-                                               symbol, price, size);
-                                        trade_count++;
-                                        goto next_trade;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-            next_trade:;
+        else if (msg_type == IEX_TRADE_REPORT && msg_len >= IEX_LENGTH(trade_report) && trade_count < 25) {
+            char symbol[16];
+            extract_clean_symbol(msg + IEX_MSG_SYMBOL_OFFSET, symbol, sizeof(symbol));
+            
+            uint32_t size = iex_trade_report_size(msg);
+            int64_t price = iex_trade_report_price(msg);
+            
+            char price_text[IEX_PRICE_TEXT_MAX];
+            printf("%-8s | TRADE |           |            |           |            | $%10s | %10u | Execution\n",
+                   symbol, iex_price_text(price, price_text), size);
+            trade_count++;
         }
     }
     
@@ -348,13 +270,13 @@ int main(int argc, char *argv[]) {
             pcapng_epb_t *epb = (pcapng_epb_t *)data_ptr;
             uint8_t *packet_data = data_ptr + sizeof(pcapng_epb_t);
             
-            if (epb->captured_len > 1000) {
+            size_t payload_len;
+            const uint8_t *udp_payload = iex_udp_payload(packet_data, epb->captured_len, &payload_len);
+            
+            if (udp_payload && iex_tp_message_count(udp_payload, payload_len) > 0) {
                 printf("\n\n############### PACKET %d (%u bytes) ###############", 
                        packets_processed + 1, epb->captured_len);
                 
-                const uint8_t *udp_payload = packet_data + 42;
-                size_t payload_len = epb->captured_len - 42;
-                
                 extract_comprehensive_data(udp_payload, payload_len, mode, debug_mode);
                 packets_processed++;
             }
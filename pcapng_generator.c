@@ -0,0 +1,1055 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include "src/include/pcap.h"
+#include "src/include/iex_tp.h"
+#include "src/include/iex_schema.h"
+
+// Synthetic IEX capture generator
+// Writes a pcapng file (SHB, one Ethernet IDB with nanosecond timestamps,
+// one EPB per packet) of IPv4/UDP datagrams carrying IEX-TP segments of
+// TOPS 1.6 or DEEP 1.0 messages. The symbol universe, message mix, arrival
+// profile, packet sizes and seed are configurable. Everything is derived
+// from the seed with integer arithmetic, so the same command line writes
+// the same bytes on every platform, and the output is streamed so the size
+// is limited only by the disk.
+
+#define GEN_DEFAULT_SIZE        (64ULL << 20)
+#define GEN_DEFAULT_SYMBOLS     8000
+#define GEN_DEFAULT_RATE        200000          // messages per second
+#define GEN_DEFAULT_PAYLOAD     1472            // UDP payload in a 1500-byte MTU
+#define GEN_DEFAULT_COALESCE    2000            // ns
+#define GEN_MIN_PAYLOAD         (IEX_TP_HEADER_SIZE + 2 + 80)   // one of the largest messages
+#define GEN_MAX_SYMBOLS         0xFFFF          // SYMBOL_TABLE_MAX
+#define GEN_SESSION_OPEN_NS     1704205800000000000ULL  // 2024-01-02 14:30:00 UTC
+#define GEN_SESSION_NS          (23400ULL * 1000000000ULL)  // 6.5 h
+#define GEN_HEARTBEAT_NS        1000000000ULL
+#define GEN_CAPTURE_DELAY_NS    25000           // send time to capture time
+#define GEN_PROGRESS_BYTES      (1ULL << 30)
+#define GEN_WRITE_BUFFER        (8 << 20)
+
+#define FRAME_HEADERS           (ETH_HEADER_SIZE + 20 + UDP_HEADER_SIZE)
+#define EPB_OVERHEAD            (sizeof(pcapng_epb_t) + 4)
+
+#define PRICE_TICK              100             // one cent in 1/10000 dollars
+#define BOOK_LEVELS             8               // DEEP levels kept per side
+#define TRADING_STATUS_TRADING  'T'
+#define SALE_ODD_LOT            0x20
+
+typedef enum {
+    PROFILE_STEADY,
+    PROFILE_INTRADAY,       // U-shaped: twice the mean at open/close, half midday
+    PROFILE_MICROBURST      // quiet at half the mean, 2 ms bursts at 13x
+} arrival_profile_t;
+
+// splitmix64: small state, full period, identical everywhere
+typedef struct {
+    uint64_t state;
+} rng_t;
+
+static uint64_t rng_next(rng_t *rng) {
+    uint64_t z = (rng->state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Uniform in [0, n)
+static uint64_t rng_below(rng_t *rng, uint64_t n) {
+    return (uint64_t)(((unsigned __int128)rng_next(rng) * n) >> 64);
+}
+
+// -ln(u) for u uniform in (0, 1], in 16.16 fixed point
+// log2 from the leading-zero count plus a quadratic fit of the mantissa
+// (within 0.01), so arrival times do not depend on the platform's libm.
+static uint64_t rng_exponential_fixed(rng_t *rng) {
+    uint64_t x = rng_next(rng) | 1;
+    int lz = __builtin_clzll(x);
+    uint64_t f = ((x << lz) << 1) >> 48;
+    uint64_t log2_mantissa = f + ((f * (65536 - f) * 22713) >> 32);    // f + 0.3466 f (1 - f)
+    uint64_t neg_log2 = ((uint64_t)(lz + 1) << 16) - log2_mantissa;
+    return (neg_log2 * 45426) >> 16;                                    // x ln 2
+}
+
+// log2(n) for n >= 1 in 32.32 fixed point, truncated: the integer part is
+// the bit length, then each squaring of the mantissa yields one fraction bit
+static uint64_t log2_fixed(uint64_t n) {
+    int msb = 63 - __builtin_clzll(n);
+    uint64_t result = (uint64_t)msb << 32;
+    uint64_t m = n << (63 - msb);                       // [1, 2) in Q63
+    for (int bit = 31; bit >= 0; bit--) {
+        unsigned __int128 square = (unsigned __int128)m * m;
+        if (square >> 127) {
+            result |= 1ULL << bit;
+            m = (uint64_t)(square >> 64);
+        } else {
+            m = (uint64_t)(square >> 63);
+        }
+    }
+    return result;
+}
+
+// 2^(-2^-j) for j = 1..32 in Q62
+static const uint64_t exp2_neg_fraction[32] = {
+    0x2d413cccfe779921ULL, 0x35d13f32b5a75abdULL,
+    0x3ab031b9f7490e4cULL, 0x3d495f454921b30bULL,
+    0x3ea0ecb6dc8a80cfULL, 0x3f4f83033d21b05dULL,
+    0x3fa784571ee3e213ULL, 0x3fd3b2d65447b229ULL,
+    0x3fe9d59487236bb4ULL, 0x3ff4e9d4703df843ULL,
+    0x3ffa74acbdf6c9d5ULL, 0x3ffd3a46ffc6e30fULL,
+    0x3ffe9d1fa8010199ULL, 0x3fff4e8ede053ad5ULL,
+    0x3fffa747318376acULL, 0x3fffd3a38961e6ffULL,
+    0x3fffe9d1c0d8fd14ULL, 0x3ffff4e8df7680c5ULL,
+    0x3ffffa746f7dc0ecULL, 0x3ffffd3a37af8098ULL,
+    0x3ffffe9d1bd3e854ULL, 0x3fffff4e8de8fe2cULL,
+    0x3fffffa746f44197ULL, 0x3fffffd3a37a116bULL,
+    0x3fffffe9d1bd04deULL, 0x3ffffff4e8de8179ULL,
+    0x3ffffffa746f407fULL, 0x3ffffffd3a37a030ULL,
+    0x3ffffffe9d1bd014ULL, 0x3fffffff4e8de809ULL,
+    0x3fffffffa746f404ULL, 0x3fffffffd3a37a02ULL
+};
+
+// scale * 2^-e for e in 32.32 fixed point, rounded to nearest
+static uint64_t scale_exp2_neg(uint64_t scale, uint64_t e) {
+    uint64_t whole = e >> 32;
+    if (whole >= 64) return 0;
+
+    uint64_t m = 1ULL << 62;
+    for (int j = 1; j <= 32; j++) {
+        if (e & (1ULL << (32 - j))) m = (uint64_t)(((unsigned __int128)m * exp2_neg_fraction[j - 1]) >> 62);
+    }
+    unsigned __int128 product = (unsigned __int128)scale * m;
+    unsigned shift = 62 + (unsigned)whole;
+    if (shift >= 127) return 0;
+    return (uint64_t)((product + ((unsigned __int128)1 << (shift - 1))) >> shift);
+}
+
+// Decimal text as 16.16 fixed point, rounded; -1 unless it is a plain
+// non-negative number
+static int parse_fixed16(const char *text, uint32_t *value) {
+    uint64_t whole = 0, fraction = 0, scale = 1;
+    const char *p = text;
+
+    if (!isdigit((unsigned char)*p) && !(*p == '.' && isdigit((unsigned char)p[1]))) return -1;
+    for (; isdigit((unsigned char)*p); p++) {
+        whole = whole * 10 + (uint64_t)(*p - '0');
+        if (whole > 0xFFFF) return -1;
+    }
+    if (*p == '.') {
+        for (p++; isdigit((unsigned char)*p); p++) {
+            if (scale >= 1000000000000ULL) continue;    // digits past 1e-12 cannot round
+            fraction = fraction * 10 + (uint64_t)(*p - '0');
+            scale *= 10;
+        }
+    }
+    if (*p != '\0') return -1;
+
+    uint64_t fixed = (whole << 16) + (fraction * 65536 + scale / 2) / scale;
+    if (fixed > UINT32_MAX) return -1;
+    *value = (uint32_t)fixed;
+    return 0;
+}
+
+// DEEP levels published and not yet deleted on one side of a symbol
+typedef struct {
+    int64_t prices[BOOK_LEVELS];
+    uint32_t count;
+} book_side_t;
+
+typedef struct {
+    uint64_t symbol;
+    int64_t mid;            // multiple of PRICE_TICK
+    uint32_t spread;        // ticks
+    book_side_t bids;
+    book_side_t asks;
+} symbol_state_t;
+
+typedef struct {
+    const char *name;
+    uint8_t type;
+    uint16_t length;
+} message_kind_t;
+
+static const message_kind_t message_kinds[] = {
+#define GEN_MESSAGE_KIND(name, type_, length) { #name, type_, length },
+    IEX_MESSAGES(GEN_MESSAGE_KIND)
+#undef GEN_MESSAGE_KIND
+};
+
+#define MESSAGE_KIND_COUNT (sizeof(message_kinds) / sizeof(message_kinds[0]))
+
+static const char *const default_mix_tops =
+    "quote_update=850,trade_report=120,trading_status=5,short_sale_price=5,"
+    "official_price=4,auction_info=15,trade_break=1";
+static const char *const default_mix_deep =
+    "price_level_buy=430,price_level_sell=430,trade_report=110,security_event=4,"
+    "trading_status=5,short_sale_price=5,official_price=4,auction_info=11,trade_break=1";
+
+typedef struct {
+    const char *output;
+    uint64_t target_bytes;
+    uint64_t seed;
+    uint16_t protocol;
+    uint32_t symbol_count;
+    const char *symbol_file;
+    uint32_t skew;              // 16.16 fixed point
+    const char *mix;
+    arrival_profile_t profile;
+    uint64_t rate;
+    uint32_t max_payload;
+    uint64_t coalesce_ns;
+} generator_config_t;
+
+typedef struct {
+    generator_config_t config;
+    rng_t rng;
+    FILE *out;
+
+    symbol_state_t *symbols;
+    uint32_t symbol_count;
+    uint64_t *activity_cdf;         // integer Zipf weights, cumulative
+    uint8_t mix_types[MESSAGE_KIND_COUNT];
+    uint64_t mix_cdf[MESSAGE_KIND_COUNT];
+    uint32_t mix_count;
+
+    // Arrival process
+    uint64_t now;
+    int in_burst;
+    uint64_t phase_end;
+
+    // Segment under construction: frame headers, IEX-TP header, messages
+    uint8_t *frame;
+    size_t payload;                 // IEX-TP payload bytes so far
+    uint16_t segment_messages;
+    uint64_t segment_start;         // timestamp of its first message
+    uint64_t segment_last;          // and of its last; the send time
+    uint64_t last_send;
+    uint64_t last_capture;
+    uint64_t sequence;              // next message sequence number
+    uint64_t stream_offset;
+    uint32_t session_id;
+    uint16_t ip_id;
+    uint64_t trade_id;
+
+    // Totals
+    uint64_t bytes;
+    uint64_t next_progress;
+    uint64_t packets;
+    uint64_t heartbeats;
+    uint64_t messages;
+    uint64_t type_counts[256];
+} generator_t;
+
+void print_usage(const char *prog_name) {
+    printf("Usage: %s [options] -o out.pcapng\n", prog_name);
+    printf("  -s SIZE       Stop after SIZE bytes (K, M, G, T suffixes; default 64M)\n");
+    printf("  -r SEED       Random seed (default 1)\n");
+    printf("  -p FEED       tops or deep (default deep)\n");
+    printf("  -n COUNT      Generated symbol universe size (default %d)\n", GEN_DEFAULT_SYMBOLS);
+    printf("  -S FILE       Symbol universe from FILE, one ticker per line, most active first\n");
+    printf("  -z SKEW       Zipf exponent of per-symbol activity (default 1.0)\n");
+    printf("  -m MIX        Message weights, e.g. quote_update=850,trade_report=120\n");
+    printf("                (price_level_buy/sell weights count book events of 1-3 updates)\n");
+    printf("  -b PROFILE    Arrival profile: steady, intraday or microburst (default intraday)\n");
+    printf("  -R RATE       Mean messages per second (default %d)\n", GEN_DEFAULT_RATE);
+    printf("  -P BYTES      Maximum UDP payload per packet (default %d)\n", GEN_DEFAULT_PAYLOAD);
+    printf("  -c NS         Messages within NS of a segment's first share it (default %d)\n",
+           GEN_DEFAULT_COALESCE);
+}
+
+// "64M", "50G", "1048576"
+static int parse_size(const char *text, uint64_t *bytes) {
+    char *end;
+    uint64_t value = strtoull(text, &end, 10);
+    int shift = 0;
+    switch (toupper((unsigned char)*end)) {
+        case 'T': shift = 40; end++; break;
+        case 'G': shift = 30; end++; break;
+        case 'M': shift = 20; end++; break;
+        case 'K': shift = 10; end++; break;
+        default: break;
+    }
+    if (end == text || *end != '\0' || value == 0) return -1;
+    *bytes = value << shift;
+    return 0;
+}
+
+// Symbol words
+
+static uint64_t pack_symbol(const char *text, size_t length) {
+    char padded[8];
+    uint64_t word;
+    memset(padded, ' ', sizeof(padded));
+    memcpy(padded, text, length);
+    memcpy(&word, padded, sizeof(word));
+    return word;
+}
+
+// Ticker shapes roughly as listed: mostly 3-4 letters, a few share classes
+static uint64_t random_ticker(rng_t *rng) {
+    char text[8];
+    uint64_t shape = rng_below(rng, 100);
+    size_t length = shape < 1 ? 1 : shape < 6 ? 2 : shape < 36 ? 3 : shape < 86 ? 4 : 5;
+
+    for (size_t i = 0; i < length; i++) text[i] = (char)('A' + rng_below(rng, 26));
+    if (length >= 3 && length <= 4 && rng_below(rng, 100) < 2) {
+        text[length++] = '.';
+        text[length++] = (char)('A' + rng_below(rng, 2));
+    }
+    return pack_symbol(text, length);
+}
+
+// Open-addressing set of symbol words, to keep the universe distinct
+static int insert_unique(uint64_t *set, uint32_t mask, uint64_t symbol) {
+    uint32_t slot = (uint32_t)((symbol * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+    while (set[slot] != 0) {
+        if (set[slot] == symbol) return 0;
+        slot = (slot + 1) & mask;
+    }
+    set[slot] = symbol;
+    return 1;
+}
+
+static int load_symbol_file(const char *path, uint64_t **symbols, uint32_t *count) {
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        perror("open symbol file");
+        return -1;
+    }
+
+    uint32_t capacity = 1024;
+    *symbols = malloc(capacity * sizeof(uint64_t));
+    *count = 0;
+    char line[256];
+    int rc = 0;
+    while (*symbols && fgets(line, sizeof(line), in)) {
+        char *text = line;
+        while (isspace((unsigned char)*text)) text++;
+        size_t length = strlen(text);
+        while (length > 0 && isspace((unsigned char)text[length - 1])) length--;
+        if (length == 0 || text[0] == '#') continue;
+        if (length > 8) {
+            fprintf(stderr, "Symbol longer than 8 characters: %.*s\n", (int)length, text);
+            rc = -1;
+            break;
+        }
+        if (*count == GEN_MAX_SYMBOLS) {
+            fprintf(stderr, "More than %d symbols in %s\n", GEN_MAX_SYMBOLS, path);
+            rc = -1;
+            break;
+        }
+        if (*count == capacity) {
+            capacity *= 2;
+            uint64_t *grown = realloc(*symbols, capacity * sizeof(uint64_t));
+            if (!grown) {
+                free(*symbols);
+                *symbols = NULL;
+                break;
+            }
+            *symbols = grown;
+        }
+        (*symbols)[(*count)++] = pack_symbol(text, length);
+    }
+    fclose(in);
+
+    if (!*symbols) {
+        fprintf(stderr, "Failed to allocate symbol list\n");
+        return -1;
+    }
+    if (rc == 0 && *count == 0) {
+        fprintf(stderr, "No symbols in %s\n", path);
+        rc = -1;
+    }
+    if (rc != 0) {
+        free(*symbols);
+        *symbols = NULL;
+    }
+    return rc;
+}
+
+static int build_universe(generator_t *gen) {
+    uint64_t *words = NULL;
+    uint32_t count = gen->config.symbol_count;
+
+    if (gen->config.symbol_file) {
+        if (load_symbol_file(gen->config.symbol_file, &words, &count) != 0) return -1;
+    }
+
+    uint32_t slots = 16;
+    while (slots < count * 2) slots <<= 1;
+    uint64_t *set = calloc(slots, sizeof(uint64_t));
+    gen->symbols = calloc(count, sizeof(symbol_state_t));
+    gen->activity_cdf = malloc(count * sizeof(uint64_t));
+    if (!set || !gen->symbols || !gen->activity_cdf) {
+        fprintf(stderr, "Failed to allocate symbol universe\n");
+        free(set);
+        free(words);
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t symbol;
+        if (words) {
+            symbol = words[i];
+            if (!insert_unique(set, slots - 1, symbol)) {
+                char name[9];
+                memcpy(name, &symbol, 8);
+                name[8] = '\0';
+                fprintf(stderr, "Duplicate symbol in %s: %s\n", gen->config.symbol_file, name);
+                free(set);
+                free(words);
+                return -1;
+            }
+        } else {
+            do {
+                symbol = random_ticker(&gen->rng);
+            } while (!insert_unique(set, slots - 1, symbol));
+        }
+
+        // Log-uniform price from $1 to $512, spread widening with price
+        symbol_state_t *s = &gen->symbols[i];
+        uint64_t octave = rng_below(&gen->rng, 9);
+        uint64_t cents = (100ULL << octave) + rng_below(&gen->rng, 100ULL << octave);
+        s->symbol = symbol;
+        s->mid = (int64_t)cents * PRICE_TICK;
+        s->spread = 1 + (uint32_t)rng_below(&gen->rng, cents > 10000 ? 5 : 2);
+
+        // Rank i + 1 gets weight 1e9 (i + 1)^-skew = 1e9 2^-(skew log2(i + 1)),
+        // in fixed point so the weights do not depend on libm
+        uint64_t exponent = (gen->config.skew * log2_fixed(i + 1)) >> 16;
+        uint64_t weight = scale_exp2_neg(1000000000, exponent);
+        gen->activity_cdf[i] = (i ? gen->activity_cdf[i - 1] : 0) + (weight ? weight : 1);
+    }
+
+    gen->symbol_count = count;
+    free(set);
+    free(words);
+    return 0;
+}
+
+static symbol_state_t *pick_symbol(generator_t *gen) {
+    uint64_t r = rng_below(&gen->rng, gen->activity_cdf[gen->symbol_count - 1]);
+    uint32_t lo = 0, hi = gen->symbol_count - 1;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (gen->activity_cdf[mid] > r) hi = mid;
+        else lo = mid + 1;
+    }
+    return &gen->symbols[lo];
+}
+
+// Message mix: "name=weight,..." with schema message names
+static int parse_mix(generator_t *gen) {
+    uint64_t feed_types = iex_schema_types(gen->config.protocol);
+    char *mix = strdup(gen->config.mix);
+    if (!mix) return -1;
+
+    uint64_t total = 0;
+    int rc = 0;
+    for (char *item = strtok(mix, ","); item && rc == 0; item = strtok(NULL, ",")) {
+        char *eq = strchr(item, '=');
+        char *end = NULL;
+        unsigned long weight = eq ? strtoul(eq + 1, &end, 10) : 0;
+        if (!eq || end == eq + 1 || *end != '\0') {
+            fprintf(stderr, "Bad mix entry: %s (expected name=weight)\n", item);
+            rc = -1;
+            break;
+        }
+        *eq = '\0';
+
+        const message_kind_t *kind = NULL;
+        for (size_t k = 0; k < MESSAGE_KIND_COUNT; k++) {
+            if (strcmp(item, message_kinds[k].name) == 0) kind = &message_kinds[k];
+        }
+        if (!kind) {
+            fprintf(stderr, "Unknown message in mix: %s\n", item);
+            rc = -1;
+        } else if (kind->type == IEX_SYSTEM_EVENT || kind->type == IEX_SECURITY_DIRECTORY) {
+            fprintf(stderr, "%s is written at session start and end, not mixed\n", item);
+            rc = -1;
+        } else if (!(feed_types & IEX_TYPE_BIT(kind->type))) {
+            fprintf(stderr, "%s is not part of %s\n", item, iex_schema_name(gen->config.protocol));
+            rc = -1;
+        } else if (weight > 0) {
+            total += weight;
+            gen->mix_types[gen->mix_count] = kind->type;
+            gen->mix_cdf[gen->mix_count] = total;
+            gen->mix_count++;
+        }
+    }
+    free(mix);
+
+    if (rc == 0 && total == 0) {
+        fprintf(stderr, "Message mix has no weight\n");
+        rc = -1;
+    }
+    return rc;
+}
+
+static uint8_t pick_type(generator_t *gen) {
+    uint64_t r = rng_below(&gen->rng, gen->mix_cdf[gen->mix_count - 1]);
+    uint32_t i = 0;
+    while (gen->mix_cdf[i] <= r) i++;
+    return gen->mix_types[i];
+}
+
+// Arrival process: exponential gaps at the profile's current rate
+
+static uint64_t profile_rate_permille(generator_t *gen) {
+    switch (gen->config.profile) {
+        case PROFILE_INTRADAY: {
+            uint64_t into = (gen->now - GEN_SESSION_OPEN_NS) % GEN_SESSION_NS;
+            int64_t x = (int64_t)((unsigned __int128)into * (2 << 20) / GEN_SESSION_NS) - (1 << 20);
+            return 500 + (uint64_t)(1500 * ((unsigned __int128)(x * x)) >> 40);
+        }
+        case PROFILE_MICROBURST:
+            while (gen->now >= gen->phase_end) {
+                gen->in_burst = !gen->in_burst;
+                uint64_t mean_ns = gen->in_burst ? 2000000 : 48000000;
+                gen->phase_end += (mean_ns * rng_exponential_fixed(&gen->rng)) >> 16;
+            }
+            return gen->in_burst ? 13000 : 500;
+        default:
+            return 1000;
+    }
+}
+
+static void advance_clock(generator_t *gen) {
+    uint64_t rate = gen->config.rate * profile_rate_permille(gen);    // per 1000 s
+    gen->now += (1000000000000ULL * rng_exponential_fixed(&gen->rng) / rate) >> 16;
+}
+
+// Output
+
+static int write_bytes(generator_t *gen, const void *data, size_t length) {
+    if (fwrite(data, 1, length, gen->out) != length) {
+        perror("write output");
+        return -1;
+    }
+    gen->bytes += length;
+    return 0;
+}
+
+static int write_file_header(generator_t *gen) {
+    pcapng_shb_t shb = {
+        .block_type = PCAPNG_MAGIC,
+        .block_length = sizeof(pcapng_shb_t) + 4,
+        .byte_order_magic = 0x1A2B3C4D,
+        .version_major = 1,
+        .version_minor = 0,
+        .section_length = UINT64_MAX,           // not known while streaming
+    };
+    uint32_t shb_trailer = shb.block_length;
+
+    // IDB: link type, reserved, snaplen, if_tsresol = 9 (ns), end of options
+    uint8_t idb[32] = {0};
+    uint32_t idb_length = sizeof(idb);
+    uint32_t idb_type = PCAPNG_IDB_TYPE;
+    uint16_t link_type = 1;                     // Ethernet
+    uint32_t snaplen = MAX_PACKET_SIZE;
+    uint16_t option_tsresol[2] = { 9, 1 };
+    memcpy(idb, &idb_type, 4);
+    memcpy(idb + 4, &idb_length, 4);
+    memcpy(idb + 8, &link_type, 2);
+    memcpy(idb + 12, &snaplen, 4);
+    memcpy(idb + 16, option_tsresol, 4);
+    idb[20] = 9;
+    memcpy(idb + 28, &idb_length, 4);
+
+    if (write_bytes(gen, &shb, sizeof(shb)) != 0 ||
+        write_bytes(gen, &shb_trailer, 4) != 0 ||
+        write_bytes(gen, idb, sizeof(idb)) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static uint16_t ipv4_checksum(const uint8_t *header) {
+    uint32_t sum = 0;
+    for (int i = 0; i < 20; i += 2) sum += (uint32_t)(header[i] << 8 | header[i + 1]);
+    while (sum >> 16) sum = (sum & 0xFFFF) + (sum >> 16);
+    return (uint16_t)~sum;
+}
+
+static void put_be16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+// Write the segment under construction (a heartbeat if it has no messages)
+// as one Ethernet/IPv4/UDP packet sent at send_time
+static int flush_segment(generator_t *gen, uint64_t send_time) {
+    static const uint8_t eth[ETH_HEADER_SIZE] = {
+        0x01, 0x00, 0x5E, 0x57, 0x15, 0x04,     // IPv4 multicast MAC
+        0x02, 0x00, 0x00, 0x00, 0x00, 0x01,     // locally administered source
+        0x08, 0x00,
+    };
+    uint8_t *frame = gen->frame;
+    size_t udp_length = UDP_HEADER_SIZE + IEX_TP_HEADER_SIZE + gen->payload;
+    size_t frame_length = ETH_HEADER_SIZE + 20 + udp_length;
+
+    memcpy(frame, eth, sizeof(eth));
+    uint8_t *ip = frame + ETH_HEADER_SIZE;
+    memset(ip, 0, 20);
+    ip[0] = 0x45;
+    put_be16(ip + 2, (uint16_t)(20 + udp_length));
+    put_be16(ip + 4, gen->ip_id++);
+    ip[6] = 0x40;                               // don't fragment
+    ip[8] = 64;
+    ip[9] = IPV4_PROTOCOL_UDP;
+    static const uint8_t addresses[8] = { 10, 0, 0, 1, 233, 215, 21, 4 };
+    memcpy(ip + 12, addresses, sizeof(addresses));
+    put_be16(ip + 10, ipv4_checksum(ip));
+
+    uint8_t *udp = ip + 20;
+    put_be16(udp, 10378);
+    put_be16(udp + 2, 10378);
+    put_be16(udp + 4, (uint16_t)udp_length);
+    put_be16(udp + 6, 0);                       // no checksum
+
+    iex_tp_header_t tp = {
+        .version = IEX_TP_VERSION,
+        .message_protocol_id = gen->config.protocol,
+        .channel_id = 1,
+        .session_id = gen->session_id,
+        .payload_length = (uint16_t)gen->payload,
+        .message_count = gen->segment_messages,
+        .stream_offset = gen->stream_offset,
+        .first_sequence_number = gen->sequence,
+        .send_time = send_time,
+    };
+    memcpy(udp + UDP_HEADER_SIZE, &tp, sizeof(tp));
+
+    // Capture a fixed delay after sending, never before the previous packet
+    uint64_t capture = send_time + GEN_CAPTURE_DELAY_NS;
+    if (capture <= gen->last_capture) capture = gen->last_capture + 1;
+    gen->last_capture = capture;
+
+    size_t padded = (frame_length + 3) & ~(size_t)3;
+    pcapng_epb_t epb = {
+        .block_type = PCAPNG_EPB_TYPE,
+        .block_length = (uint32_t)(sizeof(pcapng_epb_t) + padded + 4),
+        .interface_id = 0,
+        .timestamp_high = (uint32_t)(capture >> 32),
+        .timestamp_low = (uint32_t)capture,
+        .captured_len = (uint32_t)frame_length,
+        .packet_len = (uint32_t)frame_length,
+    };
+    memset(frame + frame_length, 0, padded - frame_length);
+    memcpy(frame + padded, &epb.block_length, 4);
+
+    if (write_bytes(gen, &epb, sizeof(epb)) != 0 ||
+        write_bytes(gen, frame, padded + 4) != 0) {
+        return -1;
+    }
+
+    gen->packets++;
+    if (gen->segment_messages == 0) gen->heartbeats++;
+    gen->sequence += gen->segment_messages;
+    gen->stream_offset += gen->payload;
+    gen->last_send = send_time;
+    gen->payload = 0;
+    gen->segment_messages = 0;
+
+    if (gen->bytes >= gen->next_progress) {
+        printf("Written: %llu MB, %llu packets, %llu messages\n",
+               (unsigned long long)(gen->bytes >> 20), (unsigned long long)gen->packets,
+               (unsigned long long)gen->messages);
+        gen->next_progress += GEN_PROGRESS_BYTES;
+    }
+    return 0;
+}
+
+// Append one message stamped at time; the open segment is sent first (at
+// its last message's time) when the message is outside its coalescing
+// window or would not fit. Idle gaps longer than a second carry
+// heartbeats, as the feed does.
+static int add_message(generator_t *gen, const void *message, uint16_t length, uint64_t time) {
+    if (gen->segment_messages > 0 &&
+        (time - gen->segment_start > gen->config.coalesce_ns ||
+         IEX_TP_HEADER_SIZE + gen->payload + 2 + length > gen->config.max_payload)) {
+        if (flush_segment(gen, gen->segment_last) != 0) return -1;
+    }
+
+    if (gen->segment_messages == 0) {
+        while (time > gen->last_send + GEN_HEARTBEAT_NS) {
+            if (flush_segment(gen, gen->last_send + GEN_HEARTBEAT_NS) != 0) return -1;
+        }
+        gen->segment_start = time;
+    }
+
+    uint8_t *body = gen->frame + FRAME_HEADERS + IEX_TP_HEADER_SIZE + gen->payload;
+    memcpy(body, &length, 2);
+    memcpy(body + 2, message, length);
+    gen->payload += 2 + (size_t)length;
+    gen->segment_messages++;
+    gen->segment_last = time;
+    gen->messages++;
+    gen->type_counts[((const uint8_t *)message)[0]]++;
+    return 0;
+}
+
+// Message builders
+
+static void random_walk(generator_t *gen, symbol_state_t *s) {
+    uint64_t step = rng_below(&gen->rng, 8);
+    int64_t floor = (int64_t)(s->spread + 1) * PRICE_TICK;
+    if (step == 0 && s->mid > floor) s->mid -= PRICE_TICK;
+    if (step == 1) s->mid += PRICE_TICK;
+}
+
+static int64_t bid_of(const symbol_state_t *s) {
+    return s->mid - (int64_t)(s->spread / 2) * PRICE_TICK;
+}
+
+static int64_t ask_of(const symbol_state_t *s) {
+    return bid_of(s) + (int64_t)s->spread * PRICE_TICK;
+}
+
+static uint32_t round_lots(generator_t *gen, uint32_t max_lots) {
+    return 100 * (1 + (uint32_t)rng_below(&gen->rng, max_lots));
+}
+
+static int emit_system_event(generator_t *gen, uint8_t event, uint64_t time) {
+    iex_system_event_t m = {
+        .message_type = IEX_SYSTEM_EVENT, .flags = event, .timestamp = time,
+    };
+    return add_message(gen, &m, sizeof(m), time);
+}
+
+// DEEP: publish one level update and track it in the symbol's book
+static int emit_level(generator_t *gen, symbol_state_t *s, uint8_t side, int64_t price,
+                      uint32_t size, uint8_t flags) {
+    book_side_t *book = side == IEX_PRICE_LEVEL_BUY ? &s->bids : &s->asks;
+    uint32_t i = 0;
+    while (i < book->count && book->prices[i] != price) i++;
+
+    if (size == 0 && i < book->count) {
+        book->prices[i] = book->prices[--book->count];
+    } else if (size > 0 && i == book->count) {
+        if (book->count == BOOK_LEVELS) {
+            // Full: the level furthest from the touch makes room
+            uint32_t worst = 0;
+            for (uint32_t j = 1; j < book->count; j++) {
+                int further = side == IEX_PRICE_LEVEL_BUY ? book->prices[j] < book->prices[worst]
+                                                          : book->prices[j] > book->prices[worst];
+                if (further) worst = j;
+            }
+            if (emit_level(gen, s, side, book->prices[worst], 0, 0) != 0) return -1;
+        }
+        book->prices[book->count++] = price;
+    }
+
+    iex_price_level_buy_t m = {
+        .message_type = side, .flags = flags, .timestamp = gen->now,
+        .symbol = s->symbol, .size = size, .price = price,
+    };
+    return add_message(gen, &m, sizeof(m), gen->now);
+}
+
+// Delete the levels of one side the quote has moved through
+static int delete_crossed(generator_t *gen, symbol_state_t *s, uint8_t side) {
+    book_side_t *book = side == IEX_PRICE_LEVEL_BUY ? &s->bids : &s->asks;
+    uint32_t i = 0;
+    while (i < book->count) {
+        int64_t price = book->prices[i];
+        int crossed = side == IEX_PRICE_LEVEL_BUY ? price > bid_of(s) : price < ask_of(s);
+        if (!crossed) {
+            i++;
+        } else if (emit_level(gen, s, side, price, 0, 0) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// DEEP: one order book event of one to three level updates, the last
+// flagged complete. Levels the mid has moved past since the symbol's last
+// event are deleted first, so every bid stays at or below bid_of() and
+// every ask at or above ask_of(): the book is never locked or crossed.
+static int emit_price_levels(generator_t *gen, uint8_t type, symbol_state_t *s) {
+    if (delete_crossed(gen, s, IEX_PRICE_LEVEL_BUY) != 0 ||
+        delete_crossed(gen, s, IEX_PRICE_LEVEL_SELL) != 0) {
+        return -1;
+    }
+
+    uint32_t updates = 1 + (uint32_t)rng_below(&gen->rng, 3);
+    for (uint32_t i = 0; i < updates; i++) {
+        uint8_t side = (i == 0) ? type : (rng_below(&gen->rng, 2) ? IEX_PRICE_LEVEL_BUY
+                                                                   : IEX_PRICE_LEVEL_SELL);
+        int64_t depth = (int64_t)rng_below(&gen->rng, 5) * PRICE_TICK;
+        uint32_t size = rng_below(&gen->rng, 10) == 0 ? 0 : round_lots(gen, 50);
+        int64_t price = side == IEX_PRICE_LEVEL_BUY ? bid_of(s) - depth : ask_of(s) + depth;
+        uint8_t flags = (i + 1 == updates) ? IEX_DEEP_EVENT_COMPLETE : 0;
+        if (emit_level(gen, s, side, price, size, flags) != 0) return -1;
+    }
+    return 0;
+}
+
+static int emit_message(generator_t *gen, uint8_t type) {
+    symbol_state_t *s = pick_symbol(gen);
+    uint64_t t = gen->now;
+    random_walk(gen, s);
+
+    switch (type) {
+        case IEX_QUOTE_UPDATE: {
+            iex_quote_update_t m = {
+                .message_type = type, .timestamp = t, .symbol = s->symbol,
+                .bid_size = round_lots(gen, 20), .bid_price = bid_of(s),
+                .ask_price = ask_of(s), .ask_size = round_lots(gen, 20),
+            };
+            return add_message(gen, &m, sizeof(m), t);
+        }
+        case IEX_TRADE_REPORT:
+        case IEX_TRADE_BREAK: {
+            uint32_t size = rng_below(&gen->rng, 10) == 0 ? 1 + (uint32_t)rng_below(&gen->rng, 99)
+                                                          : round_lots(gen, 10);
+            uint64_t id = (type == IEX_TRADE_BREAK && gen->trade_id > 0)
+                        ? gen->trade_id - rng_below(&gen->rng, gen->trade_id)
+                        : ++gen->trade_id;
+            iex_trade_report_t m = {
+                .message_type = type, .flags = size < 100 ? SALE_ODD_LOT : 0,
+                .timestamp = t, .symbol = s->symbol, .size = size,
+                .price = bid_of(s) + (int64_t)rng_below(&gen->rng, s->spread + 1) * PRICE_TICK,
+                .trade_id = id,
+            };
+            return add_message(gen, &m, sizeof(m), t);
+        }
+        case IEX_PRICE_LEVEL_BUY:
+        case IEX_PRICE_LEVEL_SELL:
+            return emit_price_levels(gen, type, s);
+        case IEX_TRADING_STATUS: {
+            static const uint8_t statuses[] = { 'T', 'T', 'T', 'H', 'P', 'O' };
+            iex_trading_status_t m = {
+                .message_type = type,
+                .flags = statuses[rng_below(&gen->rng, sizeof(statuses))],
+                .timestamp = t, .symbol = s->symbol, .reason = 0x20202020,
+            };
+            return add_message(gen, &m, sizeof(m), t);
+        }
+        case IEX_OPERATIONAL_HALT: {
+            iex_operational_halt_t m = {
+                .message_type = type, .flags = rng_below(&gen->rng, 2) ? 'O' : 'N',
+                .timestamp = t, .symbol = s->symbol,
+            };
+            return add_message(gen, &m, sizeof(m), t);
+        }
+        case IEX_SHORT_SALE_PRICE: {
+            uint8_t active = (uint8_t)rng_below(&gen->rng, 2);
+            iex_short_sale_price_t m = {
+                .message_type = type, .flags = active, .timestamp = t,
+                .symbol = s->symbol, .detail = active ? 'A' : 'D',
+            };
+            return add_message(gen, &m, sizeof(m), t);
+        }
+        case IEX_SECURITY_EVENT: {
+            iex_security_event_t m = {
+                .message_type = type, .flags = rng_below(&gen->rng, 2) ? 'O' : 'C',
+                .timestamp = t, .symbol = s->symbol,
+            };
+            return add_message(gen, &m, sizeof(m), t);
+        }
+        case IEX_OFFICIAL_PRICE: {
+            iex_official_price_t m = {
+                .message_type = type, .flags = rng_below(&gen->rng, 2) ? 'Q' : 'M',
+                .timestamp = t, .symbol = s->symbol, .price = s->mid,
+            };
+            return add_message(gen, &m, sizeof(m), t);
+        }
+        case IEX_AUCTION_INFO: {
+            static const uint8_t auctions[] = { 'O', 'C', 'H', 'I', 'V' };
+            static const uint8_t sides[] = { 'B', 'S', 'N' };
+            int64_t collar = s->mid / 10 / PRICE_TICK * PRICE_TICK;
+            uint8_t auction = auctions[rng_below(&gen->rng, sizeof(auctions))];
+            iex_auction_info_t m = {
+                .message_type = type, .flags = auction, .timestamp = t, .symbol = s->symbol,
+                .paired_shares = round_lots(gen, 100), .reference_price = s->mid,
+                .indicative_clearing_price = s->mid, .imbalance_shares = round_lots(gen, 20),
+                .imbalance_side = sides[rng_below(&gen->rng, sizeof(sides))],
+                .extension_number = 0,
+                .scheduled_auction_time = auction == 'C' ? 57600 : 34200,
+                .auction_book_clearing_price = s->mid, .collar_reference_price = s->mid,
+                .lower_auction_collar = s->mid - collar, .upper_auction_collar = s->mid + collar,
+            };
+            return add_message(gen, &m, sizeof(m), t);
+        }
+        default:
+            return 0;
+    }
+}
+
+// Start of day: system events, the Security Directory and trading status
+static int emit_session_start(generator_t *gen) {
+    static const uint8_t events[] = { 'O', 'S', 'R' };
+    uint64_t t = gen->now;
+
+    for (size_t i = 0; i < sizeof(events); i++) {
+        if (emit_system_event(gen, events[i], t) != 0) return -1;
+    }
+    for (uint32_t i = 0; i < gen->symbol_count; i++) {
+        const symbol_state_t *s = &gen->symbols[i];
+        iex_security_directory_t m = {
+            .message_type = IEX_SECURITY_DIRECTORY,
+            .flags = rng_below(&gen->rng, 20) == 0 ? 0x20 : 0,     // ETP
+            .timestamp = t, .symbol = s->symbol, .round_lot_size = 100,
+            .adjusted_poc_price = s->mid,
+            .luld_tier = s->mid >= 300000 ? 1 : 2,
+        };
+        if (add_message(gen, &m, sizeof(m), t) != 0) return -1;
+    }
+    for (uint32_t i = 0; i < gen->symbol_count; i++) {
+        iex_trading_status_t m = {
+            .message_type = IEX_TRADING_STATUS, .flags = TRADING_STATUS_TRADING,
+            .timestamp = t, .symbol = gen->symbols[i].symbol, .reason = 0x20202020,
+        };
+        if (add_message(gen, &m, sizeof(m), t) != 0) return -1;
+    }
+    return 0;
+}
+
+static int emit_session_end(generator_t *gen) {
+    static const uint8_t events[] = { 'M', 'E', 'C' };
+    for (size_t i = 0; i < sizeof(events); i++) {
+        if (emit_system_event(gen, events[i], gen->now) != 0) return -1;
+    }
+    return flush_segment(gen, gen->segment_last);
+}
+
+static int generate(generator_t *gen) {
+    gen->now = GEN_SESSION_OPEN_NS;
+    gen->last_send = gen->now;
+    gen->phase_end = gen->now;
+    gen->sequence = 1;
+    gen->session_id = (uint32_t)rng_next(&gen->rng);
+    gen->next_progress = GEN_PROGRESS_BYTES;
+
+    if (write_file_header(gen) != 0 || emit_session_start(gen) != 0) return -1;
+
+    // Stop within a couple of packets of the target
+    uint64_t stop = gen->config.target_bytes;
+    uint64_t tail = 2 * (EPB_OVERHEAD + FRAME_HEADERS + gen->config.max_payload);
+    stop = stop > tail ? stop - tail : 0;
+
+    // A DEEP book event spends one arrival per update it carries, so the
+    // rate counts messages, not events
+    uint64_t pending = 0;
+    while (gen->bytes < stop) {
+        do {
+            advance_clock(gen);
+        } while (pending-- > 1);
+        uint64_t before = gen->messages;
+        if (emit_message(gen, pick_type(gen)) != 0) return -1;
+        pending = gen->messages - before;
+    }
+    return emit_session_end(gen);
+}
+
+int main(int argc, char *argv[]) {
+    generator_t gen;
+    memset(&gen, 0, sizeof(gen));
+    generator_config_t *config = &gen.config;
+    config->target_bytes = GEN_DEFAULT_SIZE;
+    config->seed = 1;
+    config->protocol = IEX_TP_PROTOCOL_DEEP;
+    config->symbol_count = GEN_DEFAULT_SYMBOLS;
+    config->skew = 1 << 16;
+    config->profile = PROFILE_INTRADAY;
+    config->rate = GEN_DEFAULT_RATE;
+    config->max_payload = GEN_DEFAULT_PAYLOAD;
+    config->coalesce_ns = GEN_DEFAULT_COALESCE;
+
+    for (int i = 1; i < argc; i++) {
+        const char *option = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        int bad = 0;
+        if (strcmp(argv[i], "-o") == 0 && value) {
+            config->output = argv[++i];
+        } else if (strcmp(argv[i], "-s") == 0 && value) {
+            bad = parse_size(argv[++i], &config->target_bytes) != 0;
+        } else if (strcmp(argv[i], "-r") == 0 && value) {
+            config->seed = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-p") == 0 && value) {
+            i++;
+            if (strcmp(value, "tops") == 0) config->protocol = IEX_TP_PROTOCOL_TOPS;
+            else if (strcmp(value, "deep") == 0) config->protocol = IEX_TP_PROTOCOL_DEEP;
+            else bad = 1;
+        } else if (strcmp(argv[i], "-n") == 0 && value) {
+            config->symbol_count = (uint32_t)strtoul(argv[++i], NULL, 10);
+            bad = config->symbol_count == 0 || config->symbol_count > GEN_MAX_SYMBOLS;
+        } else if (strcmp(argv[i], "-S") == 0 && value) {
+            config->symbol_file = argv[++i];
+        } else if (strcmp(argv[i], "-z") == 0 && value) {
+            bad = parse_fixed16(argv[++i], &config->skew) != 0 || config->skew > (4 << 16);
+        } else if (strcmp(argv[i], "-m") == 0 && value) {
+            config->mix = argv[++i];
+        } else if (strcmp(argv[i], "-b") == 0 && value) {
+            i++;
+            if (strcmp(value, "steady") == 0) config->profile = PROFILE_STEADY;
+            else if (strcmp(value, "intraday") == 0) config->profile = PROFILE_INTRADAY;
+            else if (strcmp(value, "microburst") == 0) config->profile = PROFILE_MICROBURST;
+            else bad = 1;
+        } else if (strcmp(argv[i], "-R") == 0 && value) {
+            config->rate = strtoull(argv[++i], NULL, 10);
+            bad = config->rate == 0 || config->rate > 100000000;
+        } else if (strcmp(argv[i], "-P") == 0 && value) {
+            config->max_payload = (uint32_t)strtoul(argv[++i], NULL, 10);
+            bad = config->max_payload < GEN_MIN_PAYLOAD ||
+                  config->max_payload > 65535 - UDP_HEADER_SIZE - 20;
+        } else if (strcmp(argv[i], "-c") == 0 && value) {
+            config->coalesce_ns = strtoull(argv[++i], NULL, 10);
+        } else {
+            bad = 1;
+        }
+        if (bad) {
+            fprintf(stderr, "Invalid argument: %s\n", option);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!config->output) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (!config->mix) {
+        config->mix = config->protocol == IEX_TP_PROTOCOL_TOPS ? default_mix_tops : default_mix_deep;
+    }
+
+    gen.rng.state = config->seed;
+    if (parse_mix(&gen) != 0 || build_universe(&gen) != 0) return 1;
+
+    gen.frame = malloc(FRAME_HEADERS + IEX_TP_HEADER_SIZE + 65536 + 8);
+    gen.out = fopen(config->output, "wb");
+    if (!gen.frame || !gen.out) {
+        perror(gen.frame ? "open output" : "malloc");
+        return 1;
+    }
+    setvbuf(gen.out, NULL, _IOFBF, GEN_WRITE_BUFFER);
+
+    printf("Generating %s: %s, %u symbols, seed %llu, target %.1f MB\n",
+           config->output, iex_schema_name(config->protocol), gen.symbol_count,
+           (unsigned long long)config->seed, config->target_bytes / (1024.0 * 1024.0));
+
+    int rc = generate(&gen);
+    if (fclose(gen.out) != 0 && rc == 0) {
+        perror("close output");
+        rc = -1;
+    }
+    if (rc != 0) return 1;
+
+    double seconds = (gen.now - GEN_SESSION_OPEN_NS) / 1e9;
+    printf("Wrote %llu bytes: %llu packets (%llu heartbeats), %llu messages, %.3f s of market time\n",
+           (unsigned long long)gen.bytes, (unsigned long long)gen.packets,
+           (unsigned long long)gen.heartbeats, (unsigned long long)gen.messages, seconds);
+    for (size_t k = 0; k < MESSAGE_KIND_COUNT; k++) {
+        uint64_t count = gen.type_counts[message_kinds[k].type];
+        if (count) printf("  %-20s %llu\n", message_kinds[k].name, (unsigned long long)count);
+    }
+
+    free(gen.frame);
+    free(gen.symbols);
+    free(gen.activity_cdf);
+    return 0;
+}
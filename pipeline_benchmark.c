@@ -0,0 +1,371 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "src/include/pcap.h"
+#include "src/include/consumers.h"
+#include "src/include/cpu_dispatch.h"
+#include "src/include/bench_results.h"
+
+// End-to-end pipeline benchmark
+// Times exactly what pcap_parser does with a capture: map it, walk the
+// blocks, decode serially or on -j worker threads, resolve symbols and feed
+// the stock consumers (book builder, trade aggregator) plus a message
+// counter. Every capture runs at every thread count, warm (after one
+// untimed pass) and cold (page cache dropped before each run), and the
+// median of the timed runs is reported as GB/s, messages/s and ns/message.
+
+#define DEFAULT_RUNS        5
+#define MAX_RUNS            100
+#define MAX_THREAD_COUNTS   16
+#define DEFAULT_THREADS     "1,2,4,8"
+
+typedef enum {
+    CACHE_WARM,
+    CACHE_COLD,
+} cache_mode_t;
+
+static const char *const cache_mode_names[] = { "warm", "cold" };
+
+// Consumer that only counts, so every run can be checked against the last
+typedef struct {
+    uint64_t messages;
+    uint64_t packets;
+} run_counter_t;
+
+static void counter_consume(void *state, const message_batch_t *batch, const symbol_id_t *ids) {
+    run_counter_t *counter = (run_counter_t *)state;
+    (void)ids;
+    counter->messages += batch->count;
+    counter->packets += batch->packets;
+}
+
+static void counter_finish(void *state, const message_bus_summary_t *summary) {
+    (void)state;
+    (void)summary;
+}
+
+typedef struct {
+    const char *capture;
+    cache_mode_t mode;
+    int threads;
+    uint64_t bytes;
+    uint64_t packets;
+    uint64_t messages;
+    double resident_before;     // largest page-cache fraction seen before a run
+    double samples[MAX_RUNS];
+    int runs;
+    double median;
+    double min;
+    double mean;
+    double stddev;
+} pipeline_result_t;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void print_usage(const char *prog_name) {
+    printf("Usage: %s [-j 1,2,4,8] [-n runs] [-m warm|cold|both] [--json out.json] "
+           "[--force-isa isa] <capture>...\n", prog_name);
+    printf("Full-pipeline throughput per capture, thread count and cache mode\n");
+    printf("  -j <list>     Decode thread counts (default: %s)\n", DEFAULT_THREADS);
+    printf("  -n <runs>     Timed runs per configuration; the median is reported (default: %d)\n",
+           DEFAULT_RUNS);
+    printf("  -m <mode>     warm, cold (page cache dropped before each run) or both (default)\n");
+    printf("  --json <file> Also write every sample as JSON\n");
+    printf("  --force-isa <isa>  Use scalar, sse4.2, avx2, avx512 or neon kernels\n");
+}
+
+// Fraction of the file's pages in the page cache (1.0 if it cannot be told)
+static double resident_fraction(int fd, size_t size) {
+    if (size == 0) return 0.0;
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t pages = (size + page - 1) / page;
+    unsigned char *vec = malloc(pages);
+    void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    double fraction = 1.0;
+
+    if (vec && map != MAP_FAILED && mincore(map, size, (void *)vec) == 0) {
+        size_t resident = 0;
+        for (size_t i = 0; i < pages; i++) resident += vec[i] & 1;
+        fraction = (double)resident / pages;
+    }
+    if (map != MAP_FAILED) munmap(map, size);
+    free(vec);
+    return fraction;
+}
+
+// Evict the capture from the page cache (written-back pages only, hence
+// the sync); returns the fraction still resident
+static double drop_page_cache(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror("open capture");
+        return 1.0;
+    }
+
+    struct stat st;
+    double fraction = 1.0;
+    if (fstat(fd, &st) == 0) {
+        fsync(fd);
+#ifdef POSIX_FADV_DONTNEED
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+        fraction = resident_fraction(fd, (size_t)st.st_size);
+    }
+    close(fd);
+    return fraction;
+}
+
+// One full pass, timed from consumer setup to the last consumer report
+static int run_pipeline(const char *path, int threads, run_counter_t *counter,
+                        uint64_t *bytes, double *seconds) {
+    memset(counter, 0, sizeof(*counter));
+    message_consumer_t consumer = {
+        .name = "counter",
+        .state = counter,
+        .consume = counter_consume,
+        .finish = counter_finish,
+    };
+
+    double start = now_seconds();
+    if (register_book_builder() != 0 || register_trade_aggregator() != 0 ||
+        message_bus_register(&consumer) != 0) {
+        fprintf(stderr, "Failed to set up message consumers\n");
+        message_bus_reset();
+        return -1;
+    }
+
+    mmap_context_t ctx = {0};
+    if (init_mmap_parser(path, &ctx) != 0) {
+        message_bus_reset();
+        return -1;
+    }
+    int result = (threads > 1) ? parse_pcap_file_parallel(&ctx, threads) : parse_pcap_file(&ctx);
+    *bytes = ctx.size;
+    cleanup_mmap_parser(&ctx);
+    message_bus_reset();
+    *seconds = now_seconds() - start;
+
+    if (result != 0) fprintf(stderr, "Parse of %s failed with result: %d\n", path, result);
+    return result;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void summarize(pipeline_result_t *r) {
+    double sorted[MAX_RUNS];
+    memcpy(sorted, r->samples, r->runs * sizeof(double));
+    qsort(sorted, r->runs, sizeof(double), compare_double);
+
+    r->min = sorted[0];
+    r->median = (r->runs % 2) ? sorted[r->runs / 2]
+                              : (sorted[r->runs / 2 - 1] + sorted[r->runs / 2]) / 2;
+    double sum = 0.0, squares = 0.0;
+    for (int i = 0; i < r->runs; i++) sum += r->samples[i];
+    r->mean = sum / r->runs;
+    for (int i = 0; i < r->runs; i++) squares += (r->samples[i] - r->mean) * (r->samples[i] - r->mean);
+    r->stddev = r->runs > 1 ? sqrt(squares / (r->runs - 1)) : 0.0;
+}
+
+static double gb_per_second(const pipeline_result_t *r) {
+    return r->bytes / 1e9 / r->median;
+}
+
+static double messages_per_second(const pipeline_result_t *r) {
+    return r->messages / r->median;
+}
+
+static double ns_per_message(const pipeline_result_t *r) {
+    return r->messages ? r->median * 1e9 / r->messages : 0.0;
+}
+
+static int measure(pipeline_result_t *r, int runs) {
+    run_counter_t counter;
+    double seconds;
+    uint64_t bytes;
+
+    // Warm: one untimed pass fills the page cache and the allocator
+    if (r->mode == CACHE_WARM &&
+        run_pipeline(r->capture, r->threads, &counter, &bytes, &seconds) != 0) {
+        return -1;
+    }
+
+    for (int run = 0; run < runs; run++) {
+        if (r->mode == CACHE_COLD) {
+            double resident = drop_page_cache(r->capture);
+            if (resident > r->resident_before) r->resident_before = resident;
+        }
+        if (run_pipeline(r->capture, r->threads, &counter, &bytes, &seconds) != 0) return -1;
+
+        if (run > 0 && (counter.messages != r->messages || counter.packets != r->packets)) {
+            fprintf(stderr, "%s: run %d decoded %llu messages, run 1 %llu\n", r->capture, run + 1,
+                    (unsigned long long)counter.messages, (unsigned long long)r->messages);
+            return -1;
+        }
+        r->bytes = bytes;
+        r->messages = counter.messages;
+        r->packets = counter.packets;
+        r->samples[r->runs++] = seconds;
+    }
+    if (r->mode == CACHE_WARM) r->resident_before = 1.0;
+
+    summarize(r);
+    return 0;
+}
+
+static int write_json(const char *path, const pipeline_result_t *results, int count, int runs,
+                      const char *const *captures, int capture_count) {
+    FILE *out = bench_results_open(path, "pipeline", BENCH_GIT_REVISION, captures, capture_count);
+    if (!out) return -1;
+
+    fprintf(out, "  \"runs\": %d,\n  \"results\": [\n", runs);
+    for (int i = 0; i < count; i++) {
+        const pipeline_result_t *r = &results[i];
+        const char *base = strrchr(r->capture, '/');
+        char name[256];
+        snprintf(name, sizeof(name), "%s/%s/j%d", base ? base + 1 : r->capture,
+                 cache_mode_names[r->mode], r->threads);
+
+        fprintf(out, "    {\"name\": ");
+        bench_json_string(out, name);
+        fprintf(out, ", \"capture\": ");
+        bench_json_string(out, r->capture);
+        fprintf(out, ", \"mode\": \"%s\", \"threads\": %d,\n", cache_mode_names[r->mode], r->threads);
+        fprintf(out, "     \"bytes\": %llu, \"packets\": %llu, \"messages\": %llu, "
+                "\"resident_before\": %.3f,\n",
+                (unsigned long long)r->bytes, (unsigned long long)r->packets,
+                (unsigned long long)r->messages, r->resident_before);
+        fprintf(out, "     \"seconds\": [");
+        for (int k = 0; k < r->runs; k++) fprintf(out, "%s%.6f", k ? ", " : "", r->samples[k]);
+        fprintf(out, "],\n     \"seconds_median\": %.6f, \"seconds_min\": %.6f, "
+                "\"seconds_mean\": %.6f, \"seconds_stddev\": %.6f,\n",
+                r->median, r->min, r->mean, r->stddev);
+        fprintf(out, "     \"gb_per_s\": %.4f, \"messages_per_s\": %.0f, \"ns_per_message\": %.2f}%s\n",
+                gb_per_second(r), messages_per_second(r), ns_per_message(r), i + 1 < count ? "," : "");
+    }
+    fprintf(out, "  ]\n");
+    return bench_results_close(out);
+}
+
+int main(int argc, char *argv[]) {
+    const char *captures[64];
+    int capture_count = 0;
+    int threads[MAX_THREAD_COUNTS];
+    int thread_count = 0;
+    const char *thread_list = DEFAULT_THREADS;
+    int runs = DEFAULT_RUNS;
+    int modes[2] = { 1, 1 };
+    const char *json_path = NULL;
+    const char *force_isa = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            thread_list = argv[++i];
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            const char *mode = argv[++i];
+            modes[CACHE_WARM] = strcmp(mode, "cold") != 0;
+            modes[CACHE_COLD] = strcmp(mode, "warm") != 0;
+            if (strcmp(mode, "warm") != 0 && strcmp(mode, "cold") != 0 && strcmp(mode, "both") != 0) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--force-isa") == 0 && i + 1 < argc) {
+            force_isa = argv[++i];
+        } else if (argv[i][0] != '-' && capture_count < (int)(sizeof(captures) / sizeof(captures[0]))) {
+            captures[capture_count++] = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    for (const char *p = thread_list; *p && thread_count < MAX_THREAD_COUNTS; ) {
+        char *end;
+        long n = strtol(p, &end, 10);
+        if (end == p || n < 1 || n > 256) {
+            thread_count = 0;
+            break;
+        }
+        threads[thread_count++] = (int)n;
+        p = (*end == ',') ? end + 1 : end;
+    }
+
+    if (capture_count == 0 || thread_count == 0 || runs < 1 || runs > MAX_RUNS) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (force_isa && cpu_dispatch_force(force_isa) != 0) return 1;
+
+    int total = capture_count * thread_count * 2;
+    pipeline_result_t *results = calloc(total, sizeof(pipeline_result_t));
+    if (!results) {
+        fprintf(stderr, "Failed to allocate results\n");
+        return 1;
+    }
+
+    printf("=== End-to-End Pipeline Benchmark ===\n");
+    printf("CPU kernels: %s; %d timed runs per configuration, median reported\n\n",
+           cpu_isa_name(cpu_kernels.isa), runs);
+    printf("%-32s %9s %5s %4s %10s %8s %9s %8s %8s\n",
+           "Capture", "MB", "Cache", "Thr", "Median s", "GB/s", "Mmsg/s", "ns/msg", "Scaling");
+
+    parser_verbose = 0;
+    int count = 0;
+    int failed = 0;
+    for (int c = 0; c < capture_count && !failed; c++) {
+        for (int mode = CACHE_WARM; mode <= CACHE_COLD && !failed; mode++) {
+            if (!modes[mode]) continue;
+            const pipeline_result_t *baseline = NULL;
+            for (int t = 0; t < thread_count; t++) {
+                pipeline_result_t *r = &results[count];
+                r->capture = captures[c];
+                r->mode = (cache_mode_t)mode;
+                r->threads = threads[t];
+                if (measure(r, runs) != 0) {
+                    failed = 1;
+                    break;
+                }
+                count++;
+                if (!baseline) baseline = r;
+
+                printf("%-32s %9.1f %5s %4d %10.4f %8.3f %9.2f %8.1f %7.2fx\n",
+                       r->capture, r->bytes / (1024.0 * 1024.0), cache_mode_names[r->mode],
+                       r->threads, r->median, gb_per_second(r), messages_per_second(r) / 1e6,
+                       ns_per_message(r), baseline->median / r->median);
+                if (r->mode == CACHE_COLD && r->resident_before > 0.05) {
+                    printf("  warning: %.0f%% of the capture stayed cached; cold numbers are optimistic\n",
+                           r->resident_before * 100.0);
+                }
+                fflush(stdout);
+            }
+        }
+    }
+    parser_verbose = 1;
+
+    if (json_path && count > 0) {
+        if (write_json(json_path, results, count, runs, captures, capture_count) != 0) {
+            failed = 1;
+        } else {
+            printf("\nResults written to %s\n", json_path);
+        }
+    }
+    free(results);
+    return failed ? 1 : 0;
+}
@@ -6,6 +6,14 @@
 #include <unistd.h>
 #include "src/include/simd_optimizer.h"
 #include "src/include/pcap.h"
+#include "src/include/iex_schema.h"
+#include "src/include/cpu_dispatch.h"
+#include "src/include/price_kernels.h"
+#include "src/include/symbol_table.h"
+#include "src/include/bento.h"
+#include "src/include/consumers.h"
+#include "src/include/perf_counters.h"
+#include "src/include/bench_results.h"
 
 // Performance benchmarking tool for SIMD optimizations
 // Compares traditional parsing vs SIMD-accelerated parsing
@@ -170,6 +178,876 @@ void benchmark_iex_extraction(const char* test_name, size_t test_size) {
     free(output_buffer);
 }
 
+// Best of several warm runs of one call (first-touch page faults excluded)
+#define BEST_OF(runs, best_time, call) do {                 \
+        best_time = 1e30;                                   \
+        for (int _run = 0; _run <= (runs); _run++) {        \
+            double _start = get_time();                     \
+            call;                                           \
+            double _elapsed = get_time() - _start;          \
+            if (_run > 0 && _elapsed < best_time) best_time = _elapsed; \
+        }                                                   \
+    } while (0)
+
+// Append one length-prefixed message to a segment body
+static size_t append_message(uint8_t* body, size_t pos, const void* msg, uint16_t length) {
+    memcpy(body + pos, &length, 2);
+    memcpy(body + pos + 2, msg, length);
+    return pos + 2 + length;
+}
+
+// A DEEP-like segment body of up to test_size bytes: 4 quotes, 1 trade and
+// 3 price levels per 8 messages; returns the bytes used
+static size_t build_message_body(uint8_t* body, size_t test_size, uint32_t* quote_count,
+                                 uint32_t* trade_count) {
+    size_t length = 0;
+    uint32_t quotes = 0, trades = 0;
+    for (uint32_t i = 0; length + 64 <= test_size; i++) {
+        uint64_t symbol = 0x2020204C50504141ULL + (uint64_t)(i % 7);    // "AAPL   "-like
+        uint64_t timestamp = 1700000000000000000ULL + i;
+        if (i % 8 < 4) {
+            iex_quote_update_t q = {
+                .message_type = IEX_QUOTE_UPDATE, .flags = (uint8_t)(i & 0xC0),
+                .timestamp = timestamp, .symbol = symbol,
+                .bid_size = 100 + i % 900, .bid_price = 1502500 + (int64_t)(i % 100),
+                .ask_price = 1502600 + (int64_t)(i % 100), .ask_size = 200 + i % 800,
+            };
+            length = append_message(body, length, &q, sizeof(q));
+            quotes++;
+        } else if (i % 8 == 4) {
+            iex_trade_report_t t = {
+                .message_type = IEX_TRADE_REPORT, .flags = (uint8_t)(i & 0xF0),
+                .timestamp = timestamp, .symbol = symbol,
+                .size = 1 + i % 500, .price = 1502550 + (int64_t)(i % 100), .trade_id = i,
+            };
+            length = append_message(body, length, &t, sizeof(t));
+            trades++;
+        } else {
+            iex_price_level_buy_t level = {
+                .message_type = IEX_PRICE_LEVEL_BUY, .flags = 1,
+                .timestamp = timestamp, .symbol = symbol,
+                .size = 100, .price = 1502500,
+            };
+            length = append_message(body, length, &level, sizeof(level));
+        }
+    }
+
+    *quote_count = quotes;
+    *trade_count = trades;
+    return length;
+}
+
+// Benchmark quote/trade field extraction against the scalar references
+void benchmark_quote_trade_decode(const char* test_name, size_t test_size) {
+    printf("\n=== %s Quote/Trade Field Extraction Benchmark ===\n", test_name);
+
+    uint8_t* body = malloc(test_size + 64);
+    uint32_t quotes, trades;
+    size_t length = build_message_body(body, test_size, &quotes, &trades);
+
+    simd_iex_message_t* ref_records = malloc(quotes * sizeof(simd_iex_message_t));
+    simd_iex_message_t* records = malloc(quotes * sizeof(simd_iex_message_t));
+    uint64_t* u64[4];
+    int64_t* i64[4];
+    uint32_t* u32[4];
+    uint8_t* u8[2];
+    for (int k = 0; k < 4; k++) {
+        u64[k] = malloc(quotes * sizeof(uint64_t));
+        i64[k] = malloc(quotes * sizeof(int64_t));
+        u32[k] = malloc(quotes * sizeof(uint32_t));
+    }
+    u8[0] = malloc(quotes);
+    u8[1] = malloc(quotes);
+    simd_quote_columns_t ref_q = { u64[0], u64[1], i64[0], i64[1], u32[0], u32[1], u8[0] };
+    simd_quote_columns_t vec_q = { u64[2], u64[3], i64[2], i64[3], u32[2], u32[3], u8[1] };
+    simd_trade_columns_t ref_t = { u64[0], u64[1], i64[0], u32[0], u8[0] };
+    simd_trade_columns_t vec_t = { u64[2], u64[3], i64[2], u32[2], u8[1] };
+
+    printf("Data size: %.2f MB (%u quotes, %u trades)\n",
+           length / (1024.0 * 1024.0), quotes, trades);
+
+    // Records (AoS)
+    uint32_t ref_count, count;
+    double scalar_time, simd_time;
+    BEST_OF(5, scalar_time, ref_count = simd_process_quote_batch_scalar(body, length, ref_records, quotes));
+    BEST_OF(5, simd_time, count = simd_process_quote_batch(body, length, records, quotes));
+    int match = (count == ref_count &&
+                 memcmp(records, ref_records, count * sizeof(simd_iex_message_t)) == 0);
+    printf("Quote records:  scalar %.6f sec, SIMD %.6f sec, %.2fx, %u records %s\n",
+           scalar_time, simd_time, scalar_time / simd_time, count, match ? "match" : "MISMATCH");
+
+    BEST_OF(5, scalar_time, ref_count = simd_process_trade_batch_scalar(body, length, ref_records, quotes));
+    BEST_OF(5, simd_time, count = simd_process_trade_batch(body, length, records, quotes));
+    match = (count == ref_count &&
+             memcmp(records, ref_records, count * sizeof(simd_iex_message_t)) == 0);
+    printf("Trade records:  scalar %.6f sec, SIMD %.6f sec, %.2fx, %u records %s\n",
+           scalar_time, simd_time, scalar_time / simd_time, count, match ? "match" : "MISMATCH");
+
+    // Columns (SoA): framing, then the transpose on its own
+    uint64_t* offsets = malloc(quotes * sizeof(uint64_t));
+    double frame_time;
+    BEST_OF(5, frame_time, count = simd_frame_messages(body, length, IEX_QUOTE_UPDATE, offsets, quotes));
+    BEST_OF(5, scalar_time, simd_quote_columns_scalar(body, offsets, count, &ref_q));
+    BEST_OF(5, simd_time, simd_quote_columns(body, offsets, count, &vec_q));
+    match = 1;
+    for (int k = 0; k < 2 && match; k++) {
+        match = memcmp(u64[k], u64[k + 2], count * sizeof(uint64_t)) == 0 &&
+                memcmp(i64[k], i64[k + 2], count * sizeof(int64_t)) == 0 &&
+                memcmp(u32[k], u32[k + 2], count * sizeof(uint32_t)) == 0;
+    }
+    match = match && memcmp(u8[0], u8[1], count) == 0;
+    printf("Quote columns:  framing %.6f sec; transpose scalar %.6f sec, SIMD %.6f sec, %.2fx, %u rows %s\n",
+           frame_time, scalar_time, simd_time, scalar_time / simd_time, count,
+           match ? "match" : "MISMATCH");
+
+    BEST_OF(5, frame_time, count = simd_frame_messages(body, length, IEX_TRADE_REPORT, offsets, quotes));
+    BEST_OF(5, scalar_time, simd_trade_columns_scalar(body, offsets, count, &ref_t));
+    BEST_OF(5, simd_time, simd_trade_columns(body, offsets, count, &vec_t));
+    match = (memcmp(u64[0], u64[2], count * sizeof(uint64_t)) == 0 &&
+             memcmp(u64[1], u64[3], count * sizeof(uint64_t)) == 0 &&
+             memcmp(i64[0], i64[2], count * sizeof(int64_t)) == 0 &&
+             memcmp(u32[0], u32[2], count * sizeof(uint32_t)) == 0 &&
+             memcmp(u8[0], u8[1], count) == 0);
+    printf("Trade columns:  framing %.6f sec; transpose scalar %.6f sec, SIMD %.6f sec, %.2fx, %u rows %s\n",
+           frame_time, scalar_time, simd_time, scalar_time / simd_time, count,
+           match ? "match" : "MISMATCH");
+
+    free(offsets);
+    for (int k = 0; k < 4; k++) {
+        free(u64[k]);
+        free(i64[k]);
+        free(u32[k]);
+    }
+    free(u8[0]);
+    free(u8[1]);
+    free(records);
+    free(ref_records);
+    free(body);
+}
+
+// Price kernel check
+// Every supported ISA's price kernels against the scalar ones, on an odd
+// number of prices mixing empty sides, negatives and magnitudes beyond 2^53
+// (where int64 -> double rounds), then on every short length and start
+// offset so each vector tail and unaligned head is exercised.
+
+static iex_price_t test_price(uint64_t* state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    uint64_t r = *state >> 11;
+    switch (r % 8) {
+        case 0:  return 0;                                          // empty side
+        case 1:  return (iex_price_t)((r << 9) | 1);                // odd, up to 2^62
+        case 2:  return -(iex_price_t)((r << 8) | 1);
+        case 3:  return INT64_MAX - (iex_price_t)(r % 1000);
+        case 4:  return INT64_MIN + 1 + (iex_price_t)(r % 1000);
+        default: return 1000000 + (iex_price_t)(r % 5000000);       // $100 .. $600
+    }
+}
+
+static int price_kernels_match(const cpu_kernels_t* ref, const cpu_kernels_t* k,
+                               const iex_price_t* bids, const iex_price_t* asks, size_t count,
+                               double* ref_out, double* out) {
+    iex_price_t ref_min = 1, ref_max = 2, min = 1, max = 2;
+    size_t ref_n = ref->price_range(bids, count, &ref_min, &ref_max);
+    size_t n = k->price_range(bids, count, &min, &max);
+    if (n != ref_n || min != ref_min || max != ref_max) return 0;
+    if (k->price_count_crossed(bids, asks, count) != ref->price_count_crossed(bids, asks, count)) return 0;
+
+    ref->price_to_double(bids, ref_out, count);
+    k->price_to_double(bids, out, count);
+    return memcmp(out, ref_out, count * sizeof(double)) == 0;
+}
+
+void benchmark_price_kernels(const char* test_name, size_t test_size) {
+    printf("\n=== %s Price Kernel Benchmark ===\n", test_name);
+
+    size_t count = (test_size / sizeof(iex_price_t)) | 1;      // odd: leaves a tail
+    iex_price_t* bids = malloc(count * sizeof(iex_price_t));
+    iex_price_t* asks = malloc(count * sizeof(iex_price_t));
+    double* ref_out = malloc(count * sizeof(double));
+    double* out = malloc(count * sizeof(double));
+
+    uint64_t state = 1;
+    for (size_t i = 0; i < count; i++) {
+        bids[i] = test_price(&state);
+        // Mostly a tick or two above the bid, sometimes locked or crossed
+        asks[i] = (i % 5 == 0) ? test_price(&state) : bids[i] + (iex_price_t)(state >> 62);
+    }
+    printf("Prices: %zu\n", count);
+
+    cpu_kernels_t ref;
+    price_kernels_resolve(CPU_ISA_SCALAR, &ref);
+    double scalar_time[3];
+    iex_price_t min, max;
+    volatile size_t sink;
+    BEST_OF(5, scalar_time[0], ref.price_to_double(bids, ref_out, count));
+    BEST_OF(5, scalar_time[1], sink = ref.price_range(bids, count, &min, &max));
+    BEST_OF(5, scalar_time[2], sink = ref.price_count_crossed(bids, asks, count));
+
+    for (int isa = CPU_ISA_SCALAR + 1; isa < CPU_ISA_COUNT; isa++) {
+        if (!cpu_isa_supported((cpu_isa_t)isa)) continue;
+        cpu_kernels_t k;
+        price_kernels_resolve((cpu_isa_t)isa, &k);
+
+        int match = price_kernels_match(&ref, &k, bids, asks, count, ref_out, out);
+        for (size_t offset = 0; offset < 8 && match; offset++) {
+            for (size_t n = 0; n <= 67 && match; n++) {
+                match = price_kernels_match(&ref, &k, bids + offset, asks + offset, n, ref_out, out);
+            }
+        }
+
+        double simd_time[3];
+        BEST_OF(5, simd_time[0], k.price_to_double(bids, out, count));
+        BEST_OF(5, simd_time[1], sink = k.price_range(bids, count, &min, &max));
+        BEST_OF(5, simd_time[2], sink = k.price_count_crossed(bids, asks, count));
+        printf("%-7s to_double %.2fx, range %.2fx, crossed %.2fx, %s\n",
+               cpu_isa_name((cpu_isa_t)isa), scalar_time[0] / simd_time[0],
+               scalar_time[1] / simd_time[1], scalar_time[2] / simd_time[2],
+               match ? "match" : "MISMATCH");
+    }
+
+    (void)sink;
+    free(bids);
+    free(asks);
+    free(ref_out);
+    free(out);
+}
+
+// Symbol hash check
+// The universe is every ticker of one to four letters plus, optionally,
+// every distinct symbol in a capture. The dispatched CRC32C must match the
+// software one and give each symbol its own 32-bit hash.
+
+typedef struct {
+    uint64_t symbol;
+    uint32_t hash;
+} symbol_hash_t;
+
+static int compare_symbol_hash(const void* a, const void* b) {
+    const symbol_hash_t* x = a;
+    const symbol_hash_t* y = b;
+    if (x->hash != y->hash) return x->hash < y->hash ? -1 : 1;
+    return (x->symbol > y->symbol) - (x->symbol < y->symbol);
+}
+
+static void collect_symbol(void* user, const bento_message_t* message) {
+    if (message->symbol != 0) symbol_table_intern(user, message->symbol);
+}
+
+static uint64_t pack_ticker(const char* text, size_t length) {
+    char padded[8];
+    uint64_t word;
+    memset(padded, ' ', sizeof(padded));
+    memcpy(padded, text, length);
+    memcpy(&word, padded, sizeof(word));
+    return word;
+}
+
+int verify_symbol_hashes(const char* capture_path) {
+    printf("\n=== Symbol Hash (CRC32C) Verification ===\n");
+
+    symbol_table_t capture_symbols;
+    if (symbol_table_init(&capture_symbols, SYMBOL_TABLE_MAX) != 0) return 1;
+    if (capture_path) {
+        bento_capture_t* capture = bento_open(capture_path);
+        if (!capture) {
+            symbol_table_free(&capture_symbols);
+            return 1;
+        }
+        bento_on_any(capture, collect_symbol, &capture_symbols);
+        int rc = bento_run(capture, 1);
+        bento_close(capture);
+        if (rc != 0) {
+            symbol_table_free(&capture_symbols);
+            return 1;
+        }
+        printf("Capture symbols: %u distinct in %s\n", capture_symbols.count, capture_path);
+    }
+
+    size_t generated = 26 + 26 * 26 + 26 * 26 * 26 + 26 * 26 * 26 * 26;
+    size_t count = 0;
+    uint64_t* symbols = malloc((generated + capture_symbols.count) * sizeof(uint64_t));
+    uint32_t* hashes = malloc((generated + capture_symbols.count) * sizeof(uint32_t));
+    uint32_t* reference = malloc((generated + capture_symbols.count) * sizeof(uint32_t));
+    symbol_hash_t* sorted = malloc((generated + capture_symbols.count) * sizeof(symbol_hash_t));
+    if (!symbols || !hashes || !reference || !sorted) {
+        fprintf(stderr, "Failed to allocate symbol buffers\n");
+        free(symbols);
+        free(hashes);
+        free(reference);
+        free(sorted);
+        symbol_table_free(&capture_symbols);
+        return 1;
+    }
+
+    for (size_t length = 1; length <= 4; length++) {
+        char text[4];
+        size_t combinations = 1;
+        for (size_t k = 0; k < length; k++) combinations *= 26;
+        for (size_t n = 0; n < combinations; n++) {
+            size_t rest = n;
+            for (size_t k = length; k-- > 0; rest /= 26) text[k] = (char)('A' + rest % 26);
+            symbols[count++] = pack_ticker(text, length);
+        }
+    }
+    // Capture symbols of up to four letters are already in the range above
+    for (uint32_t id = 0; id < capture_symbols.count; id++) {
+        uint64_t symbol = symbol_table_symbol(&capture_symbols, id);
+        char name[9];
+        symbol_table_name(&capture_symbols, id, name);
+        size_t length = strlen(name);
+        int letters = length <= 4;
+        for (size_t k = 0; k < length && letters; k++) letters = name[k] >= 'A' && name[k] <= 'Z';
+        if (!letters || symbol != pack_ticker(name, length)) symbols[count++] = symbol;
+    }
+    printf("Symbols hashed: %zu (%zu generated, %zu more from the capture)\n",
+           count, generated, count - generated);
+
+    double scalar_time, simd_time;
+    BEST_OF(5, scalar_time, simd_hash_symbols_scalar(symbols, reference, count));
+    BEST_OF(5, simd_time, simd_hash_symbols(symbols, hashes, count));
+    size_t mismatches = 0;
+    for (size_t i = 0; i < count; i++) mismatches += hashes[i] != reference[i];
+    printf("Hash batch:     scalar %.2f ns/symbol, %s %.2f ns/symbol, %.2fx, %s\n",
+           scalar_time * 1e9 / count, cpu_isa_name(cpu_kernels.isa), simd_time * 1e9 / count,
+           scalar_time / simd_time, mismatches ? "MISMATCH" : "match");
+
+    for (size_t i = 0; i < count; i++) {
+        sorted[i].symbol = symbols[i];
+        sorted[i].hash = hashes[i];
+    }
+    qsort(sorted, count, sizeof(symbol_hash_t), compare_symbol_hash);
+    size_t collisions = 0;
+    for (size_t i = 1; i < count; i++) {
+        if (sorted[i].hash != sorted[i - 1].hash || sorted[i].symbol == sorted[i - 1].symbol) continue;
+        char a[9], b[9];
+        bento_symbol_text(sorted[i - 1].symbol, a);
+        bento_symbol_text(sorted[i].symbol, b);
+        if (collisions++ < 10) printf("  collision: %s / %s -> 0x%08x\n", a, b, sorted[i].hash);
+    }
+    printf("Collisions:     %zu\n", collisions);
+
+    free(symbols);
+    free(hashes);
+    free(reference);
+    free(sorted);
+    symbol_table_free(&capture_symbols);
+    return (mismatches || collisions) ? 1 : 0;
+}
+
+// Assembly entry point check (--verify-asm)
+// Every Ethernet frame of each capture goes through the x86-64 assembly and
+// through the C decoder: extract_iex_messages_asm against
+// iex_tp_decode_frame (its Quote Updates and Trade Reports), the
+// per-message parse_iex_quote_asm / parse_iex_trade_asm against the same
+// records, hash_symbol_asm against its formula, and parse_pcap_chunk_asm
+// on the frames rewrapped as classic pcap records. Records are compared
+// byte for byte.
+
+#define ASM_FRAME_MESSAGES  8192                    // 64 KB frame of minimal messages
+#define ASM_CHUNK_BYTES     (4 * 1024 * 1024)       // classic pcap records per chunk walk
+#define ASM_CHUNK_MESSAGES  (256 * 1024)
+
+typedef struct {
+    uint64_t frames;
+    uint64_t records;
+    uint64_t frame_mismatches;      // extract_iex_messages_asm
+    uint64_t message_mismatches;    // parse_iex_quote_asm / parse_iex_trade_asm
+    uint64_t hash_mismatches;       // hash_symbol_asm
+    uint64_t chunk_mismatches;      // parse_pcap_chunk_asm
+} asm_check_t;
+
+#if defined(__x86_64__)
+typedef struct {
+    uint8_t* bytes;                 // classic pcap records
+    size_t length;
+    uint32_t packets;
+    parsed_message_t* expected;
+    uint32_t expected_count;
+    parsed_message_t* output;
+} asm_chunk_t;
+
+static void check_asm_chunk(asm_chunk_t* chunk, asm_check_t* check) {
+    if (chunk->packets == 0) return;
+
+    // One extra record: the walk must not write past what it decoded
+    memset(chunk->output, 0xA5, (chunk->expected_count + 1) * sizeof(parsed_message_t));
+    parsed_message_t guard;
+    memset(&guard, 0xA5, sizeof(guard));
+
+    uint32_t packets = parse_pcap_chunk_asm(chunk->bytes, chunk->length, chunk->output);
+    if (packets != chunk->packets ||
+        memcmp(chunk->output, chunk->expected, chunk->expected_count * sizeof(parsed_message_t)) != 0 ||
+        memcmp(&chunk->output[chunk->expected_count], &guard, sizeof(guard)) != 0) {
+        check->chunk_mismatches++;
+    }
+    chunk->length = 0;
+    chunk->packets = 0;
+    chunk->expected_count = 0;
+}
+
+static void check_asm_frame(const uint8_t* frame, uint32_t caplen, parsed_message_t* all,
+                            parsed_message_t* expected, parsed_message_t* output,
+                            asm_chunk_t* chunk, asm_check_t* check) {
+    uint32_t all_count = iex_tp_decode_frame(frame, caplen, all, ASM_FRAME_MESSAGES);
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < all_count; i++) {
+        if (all[i].message_type == IEX_QUOTE_UPDATE || all[i].message_type == IEX_TRADE_REPORT) {
+            expected[count++] = all[i];
+        }
+    }
+    check->frames++;
+    check->records += count;
+
+    uint32_t got = extract_iex_messages_asm(frame, caplen, output);
+    if (got != count || memcmp(output, expected, count * sizeof(parsed_message_t)) != 0) {
+        check->frame_mismatches++;
+    }
+
+    // The same records one message at a time
+    size_t payload_len;
+    const uint8_t* payload = iex_udp_payload(frame, caplen, &payload_len);
+    iex_tp_segment_t segment;
+    const uint8_t* msg;
+    uint16_t msg_len;
+    uint32_t k = 0;
+    if (payload && iex_tp_segment_init(&segment, payload, payload_len) == 0) {
+        while ((msg = iex_tp_next_message(&segment, &msg_len)) != NULL && k < count) {
+            parsed_message_t record;
+            if (msg[0] == IEX_QUOTE_UPDATE && msg_len >= sizeof(iex_quote_update_t)) {
+                parse_iex_quote_asm(msg, &record);
+            } else if (msg[0] == IEX_TRADE_REPORT && msg_len >= sizeof(iex_trade_report_t)) {
+                parse_iex_trade_asm(msg, &record);
+            } else {
+                continue;
+            }
+            if (memcmp(&record, &expected[k], sizeof(record)) != 0) check->message_mismatches++;
+
+            uint64_t word = iex_load_u64(msg + 10);     // symbol follows type, flags, timestamp
+            uint64_t mixed = word ^ 0x9e3779b9ULL;
+            uint64_t hash = ((mixed >> 32) | (mixed << 32)) ^ (word >> 32);
+            if (hash_symbol_asm(msg + 10) != hash) check->hash_mismatches++;
+            k++;
+        }
+    }
+    if (k != count) check->message_mismatches++;
+
+    // Rewrap as a classic pcap record for the chunk walk
+    if (chunk->length + sizeof(pcap_record_header_t) + caplen > ASM_CHUNK_BYTES ||
+        chunk->expected_count + count >= ASM_CHUNK_MESSAGES) {
+        check_asm_chunk(chunk, check);
+    }
+    pcap_record_header_t header = { .ts_sec = 0, .ts_usec = 0, .caplen = caplen, .len = caplen };
+    memcpy(chunk->bytes + chunk->length, &header, sizeof(header));
+    memcpy(chunk->bytes + chunk->length + sizeof(header), frame, caplen);
+    chunk->length += sizeof(header) + caplen;
+    chunk->packets++;
+    memcpy(&chunk->expected[chunk->expected_count], expected, count * sizeof(parsed_message_t));
+    chunk->expected_count += count;
+}
+
+static int verify_asm_capture(const char* capture_path, asm_check_t* check) {
+    mmap_context_t ctx = {0};
+    uint8_t* data;
+    size_t remaining;
+    int saved_verbose = parser_verbose;
+
+    parser_verbose = 0;
+    int opened = init_mmap_parser(capture_path, &ctx) == 0 &&
+                 locate_first_block(&ctx, &data, &remaining) == 0;
+    parser_verbose = saved_verbose;
+    if (!opened || *((const uint32_t*)ctx.data) != PCAPNG_MAGIC) {
+        fprintf(stderr, "%s: assembly check needs a pcapng capture\n", capture_path);
+        cleanup_mmap_parser(&ctx);
+        return -1;
+    }
+
+    parsed_message_t* all = malloc(ASM_FRAME_MESSAGES * sizeof(parsed_message_t));
+    parsed_message_t* expected = malloc(ASM_FRAME_MESSAGES * sizeof(parsed_message_t));
+    parsed_message_t* output = malloc(ASM_FRAME_MESSAGES * sizeof(parsed_message_t));
+    asm_chunk_t chunk = {
+        .bytes = malloc(ASM_CHUNK_BYTES),
+        .expected = malloc(ASM_CHUNK_MESSAGES * sizeof(parsed_message_t)),
+        .output = malloc((ASM_CHUNK_MESSAGES + 1) * sizeof(parsed_message_t)),
+    };
+    int result = 0;
+    if (!all || !expected || !output || !chunk.bytes || !chunk.expected || !chunk.output) {
+        fprintf(stderr, "Failed to allocate assembly check buffers\n");
+        result = -1;
+    }
+
+    while (result == 0 && remaining >= 12) {
+        uint32_t block_len = *((const uint32_t*)(data + 4));
+        if (block_len < 12 || block_len > remaining) break;
+
+        const pcapng_epb_t* epb = (const pcapng_epb_t*)data;
+        if (epb->block_type == PCAPNG_EPB_TYPE && block_len >= sizeof(pcapng_epb_t) &&
+            epb->captured_len <= block_len - sizeof(pcapng_epb_t) && epb->captured_len <= 65535) {
+            check_asm_frame(data + sizeof(pcapng_epb_t), epb->captured_len, all, expected, output,
+                            &chunk, check);
+        }
+        data += block_len;
+        remaining -= block_len;
+    }
+    if (result == 0) check_asm_chunk(&chunk, check);
+
+    free(all);
+    free(expected);
+    free(output);
+    free(chunk.bytes);
+    free(chunk.expected);
+    free(chunk.output);
+    cleanup_mmap_parser(&ctx);
+    return result;
+}
+#endif
+
+int verify_asm(char** capture_paths, int capture_count) {
+    printf("\n=== Assembly Entry Point Verification ===\n");
+#if defined(__x86_64__)
+    int failed = 0;
+    for (int i = 0; i < capture_count; i++) {
+        asm_check_t check = {0};
+        if (verify_asm_capture(capture_paths[i], &check) != 0) return 1;
+
+        uint64_t mismatches = check.frame_mismatches + check.message_mismatches +
+                              check.hash_mismatches + check.chunk_mismatches;
+        printf("%s: %llu frames, %llu quote/trade records\n", capture_paths[i],
+               (unsigned long long)check.frames, (unsigned long long)check.records);
+        printf("  extract_iex_messages_asm %llu, parse_iex_*_asm %llu, hash_symbol_asm %llu, "
+               "parse_pcap_chunk_asm %llu mismatched: %s\n",
+               (unsigned long long)check.frame_mismatches, (unsigned long long)check.message_mismatches,
+               (unsigned long long)check.hash_mismatches, (unsigned long long)check.chunk_mismatches,
+               mismatches ? "MISMATCH" : "match");
+        if (check.frames == 0 || check.records == 0 || mismatches) failed = 1;
+    }
+    return failed;
+#else
+    // The other architectures' assembly predates the current parsed_message_t
+    (void)capture_paths;
+    (void)capture_count;
+    printf("Skipped: only the x86-64 assembly follows the decoder's record layout\n");
+    return 0;
+#endif
+}
+
+// Hardware counter profile (--counters)
+// Every kernel, and with a capture every stage of the pipeline, runs once
+// untimed and then COUNTER_RUNS times under the counters. All run times
+// are kept (for bench_compare), the counters of the fastest run only.
+// "Messages" are what the row processes: headers, messages found, records,
+// rows or symbols for kernels (none for the byte scans), decoded messages
+// of the capture for stages. Stages are cumulative, each adding one step of
+// the parse to the one above, so the step's cost is the difference between
+// two rows.
+
+#define COUNTER_RUNS        5
+#define MAX_PROFILES        16
+#define COUNTER_TEST_SIZE   (16 * 1024 * 1024)
+
+typedef struct {
+    const char* name;
+    uint64_t bytes;
+    uint64_t messages;
+    double samples[COUNTER_RUNS];
+    double seconds;             // fastest sample, the one whose counters are kept
+    perf_sample_t sample;
+} counter_profile_t;
+
+static perf_counters_t profile_counters;
+static counter_profile_t profiles[MAX_PROFILES];
+static int profile_count;
+static volatile uint64_t profile_sink;     // keeps side-effect-free stages alive
+
+#define PROFILE(label, byte_count, message_count, call) do {              \
+        counter_profile_t* _p = &profiles[profile_count++];                 \
+        _p->name = (label);                                                 \
+        _p->seconds = 1e30;                                                 \
+        call;                                                               \
+        for (int _run = 0; _run < COUNTER_RUNS; _run++) {                   \
+            perf_sample_t _sample;                                          \
+            double _start = get_time();                                     \
+            perf_counters_start(&profile_counters);                         \
+            call;                                                           \
+            perf_counters_stop(&profile_counters, &_sample);                \
+            double _elapsed = get_time() - _start;                          \
+            _p->samples[_run] = _elapsed;                                   \
+            if (_elapsed < _p->seconds) {                                   \
+                _p->seconds = _elapsed;                                     \
+                _p->sample = _sample;                                       \
+            }                                                               \
+        }                                                                   \
+        _p->bytes = (byte_count);                                           \
+        _p->messages = (message_count);                                     \
+    } while (0)
+
+static void profile_kernels(void) {
+    const size_t size = COUNTER_TEST_SIZE;
+    uint8_t* input = malloc(size + 64);
+    uint8_t* output = malloc(size + 64);
+    uint32_t count;
+
+    // Header filter: every other header valid
+    const uint32_t header_count = size / sizeof(pcap_header_t);
+    pcap_header_t* headers = (pcap_header_t*)input;
+    for (uint32_t i = 0; i < header_count; i++) {
+        memset(&headers[i], 0, sizeof(pcap_header_t));
+        headers[i].magic = (i % 2) ? PCAP_MAGIC : 0x12345678;
+    }
+    PROFILE("pcap header filter", size, header_count,
+            simd_parse_pcap_batch(headers, output, header_count));
+
+    uint32_t quotes, trades;
+    size_t length = build_message_body(input, size, &quotes, &trades);
+    PROFILE("message type scan", length, 0, simd_extract_iex_messages(input, length, output));
+
+    simd_iex_message_t* records = malloc(quotes * sizeof(simd_iex_message_t));
+    PROFILE("quote records", length, count,
+            count = simd_process_quote_batch(input, length, records, quotes));
+    PROFILE("trade records", length, count,
+            count = simd_process_trade_batch(input, length, records, quotes));
+
+    uint64_t* offsets = malloc(quotes * sizeof(uint64_t));
+    uint64_t* u64[2] = { malloc(quotes * sizeof(uint64_t)), malloc(quotes * sizeof(uint64_t)) };
+    int64_t* i64[2] = { malloc(quotes * sizeof(int64_t)), malloc(quotes * sizeof(int64_t)) };
+    uint32_t* u32[2] = { malloc(quotes * sizeof(uint32_t)), malloc(quotes * sizeof(uint32_t)) };
+    uint8_t* u8 = malloc(quotes);
+    simd_quote_columns_t quote_columns = { u64[0], u64[1], i64[0], i64[1], u32[0], u32[1], u8 };
+    simd_trade_columns_t trade_columns = { u64[0], u64[1], i64[0], u32[0], u8 };
+
+    PROFILE("quote framing", length, count,
+            count = simd_frame_messages(input, length, IEX_QUOTE_UPDATE, offsets, quotes));
+    PROFILE("quote columns", (uint64_t)count * sizeof(iex_quote_update_t), count,
+            simd_quote_columns(input, offsets, count, &quote_columns));
+    count = simd_frame_messages(input, length, IEX_TRADE_REPORT, offsets, quotes);
+    PROFILE("trade columns", (uint64_t)count * sizeof(iex_trade_report_t), count,
+            simd_trade_columns(input, offsets, count, &trade_columns));
+
+    // Symbol words: four-letter tickers, as a large universe would have
+    const size_t symbol_count = size / sizeof(uint64_t) / 4;
+    uint64_t* symbols = (uint64_t*)output;
+    uint32_t* hashes = malloc(symbol_count * sizeof(uint32_t));
+    for (size_t i = 0; i < symbol_count; i++) {
+        symbols[i] = 0x2020202041414141ULL + (i % 26) + ((i / 26 % 26) << 8) +
+                     ((i / 676 % 26) << 16) + ((i / 17576 % 26) << 24);
+    }
+    PROFILE("symbol hashes", symbol_count * sizeof(uint64_t), symbol_count,
+            simd_hash_symbols(symbols, hashes, symbol_count));
+
+    PROFILE("chunk copy", size, 0, cache_optimized_chunk_processor(input, output, size));
+
+    free(hashes);
+    for (int k = 0; k < 2; k++) {
+        free(u64[k]);
+        free(i64[k]);
+        free(u32[k]);
+    }
+    free(u8);
+    free(offsets);
+    free(records);
+    free(input);
+    free(output);
+}
+
+// Stage 1: pcapng block headers only
+static uint64_t walk_blocks(const uint8_t* data, size_t remaining) {
+    uint64_t packets = 0;
+    while (remaining >= 12) {
+        uint32_t block_len = *((const uint32_t*)(data + 4));
+        if (block_len < 12 || block_len > remaining) break;
+        packets += *((const uint32_t*)data) == PCAPNG_EPB_TYPE;
+        data += block_len;
+        remaining -= block_len;
+    }
+    return packets;
+}
+
+// Stage 2: plus Ethernet/IPv4/UDP and the IEX-TP length chain
+static uint64_t frame_blocks(const uint8_t* data, size_t remaining) {
+    uint64_t messages = 0;
+    while (remaining >= 12) {
+        uint32_t block_len = *((const uint32_t*)(data + 4));
+        if (block_len < 12 || block_len > remaining) break;
+
+        const pcapng_epb_t* epb = (const pcapng_epb_t*)data;
+        if (epb->block_type == PCAPNG_EPB_TYPE && block_len >= sizeof(pcapng_epb_t) &&
+            epb->captured_len <= block_len - sizeof(pcapng_epb_t)) {
+            size_t payload_len;
+            const uint8_t* payload = iex_udp_payload(data + sizeof(pcapng_epb_t),
+                                                     epb->captured_len, &payload_len);
+            iex_tp_segment_t segment;
+            uint16_t msg_len;
+            if (payload && iex_tp_segment_init(&segment, payload, payload_len) == 0) {
+                while (iex_tp_next_message(&segment, &msg_len)) messages++;
+            }
+        }
+        data += block_len;
+        remaining -= block_len;
+    }
+    return messages;
+}
+
+// Stage 3: plus decoding into batches, as the parser's producer does
+static uint64_t decode_blocks(const uint8_t* data, size_t remaining, message_batch_t* batch) {
+    const uint8_t* end = data + remaining;
+    uint64_t messages = 0, packets = 0;
+    while (end - data > 16) {
+        size_t chunk = (size_t)(end - data) > PCAP_CHUNK_SIZE ? PCAP_CHUNK_SIZE : (size_t)(end - data);
+        batch->count = 0;
+        const uint8_t* next = decode_pcapng_blocks(data, data + chunk, end, batch, &packets);
+        if (next == data) break;
+        messages += batch->count;
+        data = next;
+    }
+    return messages;
+}
+
+// Stage 4: plus dispatch and the stock consumers, i.e. pcap_parser
+static int run_parse(mmap_context_t* ctx) {
+    if (register_book_builder() != 0 || register_trade_aggregator() != 0) {
+        message_bus_reset();
+        return -1;
+    }
+    ctx->offset = 0;
+    int result = parse_pcap_file(ctx);
+    message_bus_reset();
+    return result;
+}
+
+static int profile_stages(const char* capture_path) {
+    mmap_context_t ctx = {0};
+    uint8_t* data;
+    size_t remaining;
+    int saved_verbose = parser_verbose;
+
+    parser_verbose = 0;
+    if (init_mmap_parser(capture_path, &ctx) != 0 || locate_first_block(&ctx, &data, &remaining) != 0) {
+        parser_verbose = saved_verbose;
+        cleanup_mmap_parser(&ctx);
+        return -1;
+    }
+    if (*((const uint32_t*)ctx.data) != PCAPNG_MAGIC) {
+        fprintf(stderr, "%s: stage counters need a pcapng capture\n", capture_path);
+        parser_verbose = saved_verbose;
+        cleanup_mmap_parser(&ctx);
+        return -1;
+    }
+
+    message_batch_t* batch = NULL;
+    if (posix_memalign((void**)&batch, _Alignof(message_batch_t), sizeof(message_batch_t)) != 0) {
+        parser_verbose = saved_verbose;
+        cleanup_mmap_parser(&ctx);
+        return -1;
+    }
+    uint64_t messages = decode_blocks(data, remaining, batch);
+    int result = 0;
+
+    PROFILE("1 block walk", ctx.size, messages, profile_sink = walk_blocks(data, remaining));
+    PROFILE("2 + framing", ctx.size, messages, profile_sink = frame_blocks(data, remaining));
+    PROFILE("3 + decode", ctx.size, messages, decode_blocks(data, remaining, batch));
+    PROFILE("4 + dispatch, consumers", ctx.size, messages, result |= run_parse(&ctx));
+
+    free(batch);
+    cleanup_mmap_parser(&ctx);
+    parser_verbose = saved_verbose;
+    return result;
+}
+
+// Counter per message / per byte, or -1 if it was not counted
+static double per_unit(const counter_profile_t* p, perf_counter_id_t id, uint64_t units) {
+    if (!perf_sample_has(&p->sample, id) || units == 0) return -1.0;
+    return (double)p->sample.values[id] / units;
+}
+
+static void print_cell(double value, int width, int precision) {
+    if (value < 0) {
+        printf(" %*s", width, "-");
+    } else {
+        printf(" %*.*f", width, precision, value);
+    }
+}
+
+static void print_profiles(void) {
+    printf("\n%-24s %7s %7s %7s %7s %8s %8s %5s %8s %8s %8s %8s %7s\n",
+           "Kernel / stage", "MB", "GB/s", "Mmsg", "ns/msg", "cyc/msg", "ins/msg", "IPC",
+           "L1d/msg", "LLC/msg", "br/msg", "dTLB/msg", "cyc/B");
+    for (int i = 0; i < profile_count; i++) {
+        const counter_profile_t* p = &profiles[i];
+        printf("%-24s %7.1f %7.2f %7.3f", p->name, p->bytes / (1024.0 * 1024.0),
+               p->bytes / 1e9 / p->seconds, p->messages / 1e6);
+        print_cell(p->messages ? p->seconds * 1e9 / p->messages : -1.0, 7, 2);
+        print_cell(per_unit(p, PERF_COUNTER_CYCLES, p->messages), 8, 1);
+        print_cell(per_unit(p, PERF_COUNTER_INSTRUCTIONS, p->messages), 8, 1);
+        print_cell((perf_sample_has(&p->sample, PERF_COUNTER_CYCLES) &&
+                    perf_sample_has(&p->sample, PERF_COUNTER_INSTRUCTIONS) &&
+                    p->sample.values[PERF_COUNTER_CYCLES])
+                   ? (double)p->sample.values[PERF_COUNTER_INSTRUCTIONS] /
+                     p->sample.values[PERF_COUNTER_CYCLES]
+                   : -1.0, 5, 2);
+        print_cell(per_unit(p, PERF_COUNTER_L1D_MISSES, p->messages), 8, 3);
+        print_cell(per_unit(p, PERF_COUNTER_LLC_MISSES, p->messages), 8, 3);
+        print_cell(per_unit(p, PERF_COUNTER_BRANCH_MISSES, p->messages), 8, 3);
+        print_cell(per_unit(p, PERF_COUNTER_DTLB_MISSES, p->messages), 8, 3);
+        print_cell(per_unit(p, PERF_COUNTER_CYCLES, p->bytes), 7, 3);
+        printf("\n");
+    }
+}
+
+static void json_number(FILE* out, double value) {
+    if (value < 0) {
+        fprintf(out, "null");
+    } else {
+        fprintf(out, "%.6g", value);
+    }
+}
+
+static int write_profiles_json(const char* path, const char* capture_path) {
+    FILE* out = bench_results_open(path, "counters", BENCH_GIT_REVISION,
+                                   &capture_path, capture_path ? 1 : 0);
+    if (!out) return -1;
+
+    fprintf(out, "  \"runs\": %d,\n  \"results\": [\n", COUNTER_RUNS);
+    for (int i = 0; i < profile_count; i++) {
+        const counter_profile_t* p = &profiles[i];
+        fprintf(out, "    {\"name\": \"%s\", \"bytes\": %llu, \"messages\": %llu,\n     \"seconds\": [",
+                p->name, (unsigned long long)p->bytes, (unsigned long long)p->messages);
+        for (int k = 0; k < COUNTER_RUNS; k++) fprintf(out, "%s%.6f", k ? ", " : "", p->samples[k]);
+        fprintf(out, "], \"seconds_min\": %.6f,\n", p->seconds);
+        const char* sections[] = { "counters", "per_message", "per_byte" };
+        for (int s = 0; s < 3; s++) {
+            fprintf(out, "     \"%s\": {", sections[s]);
+            for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+                fprintf(out, "%s\"%s\": ", c ? ", " : "", perf_counter_name((perf_counter_id_t)c));
+                json_number(out, s == 0 ? per_unit(p, (perf_counter_id_t)c, 1)
+                                : per_unit(p, (perf_counter_id_t)c, s == 1 ? p->messages : p->bytes));
+            }
+            fprintf(out, "}%s\n", s < 2 ? "," : "");
+        }
+        fprintf(out, "    }%s\n", i + 1 < profile_count ? "," : "");
+    }
+    fprintf(out, "  ]\n");
+    return bench_results_close(out);
+}
+
+int run_counter_profile(const char* capture_path, const char* json_path) {
+    printf("=== Hardware Counter Profile ===\n");
+    if (perf_counters_open(&profile_counters) == 0) {
+        printf("No hardware counters: timing only\n");
+    }
+
+    profile_count = 0;
+    profile_kernels();
+    int result = capture_path ? profile_stages(capture_path) : 0;
+    print_profiles();
+    perf_counters_close(&profile_counters);
+
+    if (result == 0 && json_path) {
+        result = write_profiles_json(json_path, capture_path);
+        if (result == 0) printf("\nResults written to %s\n", json_path);
+    }
+    return result ? 1 : 0;
+}
+
 // Memory bandwidth benchmark
 void benchmark_memory_bandwidth(const char* test_name, size_t test_size) {
     printf("\n=== %s Memory Bandwidth Benchmark ===\n", test_name);
@@ -224,6 +1102,7 @@ void run_comprehensive_benchmark() {
     // Detect system capabilities
     simd_capabilities_t caps;
     detect_simd_capabilities(&caps);
+    print_simd_capabilities(&caps);
     
     simd_tuning_params_t params;
     get_optimal_tuning_params(&caps, &params);
@@ -253,6 +1132,8 @@ void run_comprehensive_benchmark() {
     for (int i = 0; i < num_tests; i++) {
         benchmark_pcap_processing(test_names[i], test_sizes[i]);
         benchmark_iex_extraction(test_names[i], test_sizes[i]);
+        benchmark_quote_trade_decode(test_names[i], test_sizes[i]);
+        benchmark_price_kernels(test_names[i], test_sizes[i]);
         benchmark_memory_bandwidth(test_names[i], test_sizes[i]);
         
         if (i < num_tests - 1) {
@@ -270,10 +1151,54 @@ int main(int argc, char* argv[]) {
     printf("Built: %s %s\n", __DATE__, __TIME__);
     printf("Target: High-frequency trading market data processing\n\n");
     
-    if (argc > 1 && strcmp(argv[1], "--quick") == 0) {
+    int quick = 0;
+    int verify_symbols = 0;
+    int counters = 0;
+    const char* symbol_capture = NULL;
+    const char* counter_capture = NULL;
+    const char* json_path = NULL;
+    int asm_first = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            quick = 1;
+        } else if (strcmp(argv[i], "--verify-symbols") == 0) {
+            verify_symbols = 1;
+            if (i + 1 < argc && argv[i + 1][0] != '-') symbol_capture = argv[++i];
+        } else if (strcmp(argv[i], "--counters") == 0) {
+            counters = 1;
+            if (i + 1 < argc && argv[i + 1][0] != '-') counter_capture = argv[++i];
+        } else if (strcmp(argv[i], "--verify-asm") == 0 && i + 1 < argc) {
+            asm_first = i + 1;      // the remaining arguments are captures
+            break;
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--force-isa") == 0 && i + 1 < argc) {
+            if (cpu_dispatch_force(argv[++i]) != 0) return 1;
+        } else {
+            fprintf(stderr, "Usage: %s [--quick] [--force-isa scalar|sse4.2|avx2|avx512|neon] "
+                    "[--verify-symbols [capture.pcap]] [--counters [capture.pcapng] [--json out.json]] "
+                    "[--verify-asm capture.pcapng...]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    printf("CPU kernels: %s\n\n", cpu_isa_name(cpu_kernels.isa));
+    
+    if (asm_first) {
+        return verify_asm(&argv[asm_first], argc - asm_first);
+    }
+    if (verify_symbols) {
+        return verify_symbol_hashes(symbol_capture);
+    }
+    if (counters) {
+        return run_counter_profile(counter_capture, json_path);
+    }
+    if (quick) {
         printf("Quick benchmark mode - testing small datasets only\n");
         benchmark_pcap_processing("Quick", 1024 * 1024);
         benchmark_iex_extraction("Quick", 1024 * 1024);
+        benchmark_quote_trade_decode("Quick", 1024 * 1024);
+        benchmark_price_kernels("Quick", 1024 * 1024);
     } else {
         run_comprehensive_benchmark();
     }
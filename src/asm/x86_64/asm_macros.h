@@ -0,0 +1,52 @@
+// Shared definitions for the x86-64 assembly (GAS, Intel syntax)
+// Entry points follow the System V AMD64 ABI. Only baseline x86-64
+// instructions (SSE2) are used, so these run wherever the portable build
+// does; wider kernels are chosen at runtime in C (cpu_dispatch.c).
+
+#ifndef ASM_MACROS_H
+#define ASM_MACROS_H
+
+#if defined(__APPLE__)
+#define C_SYMBOL(name)      _##name
+#define FUNCTION(name)      .globl C_SYMBOL(name); .private_extern C_SYMBOL(name); \
+                            .p2align 4; C_SYMBOL(name):
+#define END_FUNCTION(name)
+#define C_EXTERN(name)      C_SYMBOL(name)
+#define RODATA              .section __TEXT,__const
+#else
+#define C_SYMBOL(name)      name
+// Hidden like the C objects of libbento (-fvisibility=hidden)
+#define FUNCTION(name)      .globl name; .hidden name; .type name, @function; \
+                            .p2align 4; name:
+#define END_FUNCTION(name)  .size name, . - name
+#define C_EXTERN(name)      name@PLT
+#define RODATA              .section .rodata
+#endif
+
+// parsed_message_t (iex.h), packed
+#define PARSED_TIMESTAMP    0
+#define PARSED_SYMBOL       8
+#define PARSED_PRICE        16
+#define PARSED_SIZE         24
+#define PARSED_TYPE         28
+#define PARSED_SIDE         29
+#define PARSED_ASK_PRICE    30
+#define PARSED_ASK_SIZE     38
+#define PARSED_FLAGS        42
+#define PARSED_MESSAGE_SIZE 43
+
+// Quote Update (42 bytes) and Trade Report (38 bytes), iex_schema.h
+// Both start flags(1) timestamp(8) symbol(8) size(4) price(8) after the type.
+#define MSG_FLAGS           1
+#define MSG_TIMESTAMP       2
+#define MSG_SIZE            18
+#define MSG_PRICE           22
+#define QUOTE_ASK_PRICE     30
+#define QUOTE_ASK_SIZE      38
+#define QUOTE_LENGTH        42
+#define TRADE_LENGTH        38
+
+#define IEX_QUOTE_UPDATE    0x51
+#define IEX_TRADE_REPORT    0x54
+
+#endif
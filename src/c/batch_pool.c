@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "batch_pool.h"
+
+_Static_assert(sizeof(message_batch_t) % BATCH_POOL_ALIGNMENT == 0,
+               "message_batch_t must be a whole number of cache lines");
+
+int batch_pool_init(batch_pool_t *pool, uint32_t capacity) {
+    memset(pool, 0, sizeof(*pool));
+
+    size_t bytes = (size_t)capacity * sizeof(message_batch_t);
+    if (posix_memalign((void **)&pool->batches, BATCH_POOL_ALIGNMENT, bytes) != 0) {
+        fprintf(stderr, "Failed to allocate batch pool\n");
+        pool->batches = NULL;
+        return -1;
+    }
+
+    if (mpsc_ring_init(&pool->free_ring, capacity) != 0 ||
+        spsc_ring_init(&pool->full_ring, capacity) != 0) {
+        batch_pool_destroy(pool);
+        return -1;
+    }
+
+    pool->capacity = capacity;
+    for (uint32_t i = 0; i < capacity; i++) {
+        pool->batches[i].count = 0;
+        mpsc_ring_push(&pool->free_ring, &pool->batches[i]);
+    }
+    return 0;
+}
+
+void batch_pool_destroy(batch_pool_t *pool) {
+    mpsc_ring_free(&pool->free_ring);
+    spsc_ring_free(&pool->full_ring);
+    free(pool->batches);
+    memset(pool, 0, sizeof(*pool));
+}
+
+message_batch_t *batch_pool_acquire(batch_pool_t *pool) {
+    message_batch_t *batch;
+    unsigned spins = 0;
+
+    while ((batch = mpsc_ring_pop(&pool->free_ring)) == NULL) {
+        ring_backoff(&spins);
+    }
+
+    batch->count = 0;
+    batch->packets = 0;
+    return batch;
+}
+
+void batch_pool_submit(batch_pool_t *pool, message_batch_t *batch) {
+    // Sized for every batch, so this never has to wait
+    spsc_ring_push(&pool->full_ring, batch);
+}
+
+void batch_pool_close(batch_pool_t *pool) {
+    spsc_ring_close(&pool->full_ring);
+}
+
+message_batch_t *batch_pool_next(batch_pool_t *pool) {
+    return spsc_ring_pop_wait(&pool->full_ring);
+}
+
+void batch_pool_release(batch_pool_t *pool, message_batch_t *batch) {
+    mpsc_ring_push(&pool->free_ring, batch);
+}
@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __APPLE__
+#include <sys/sysctl.h>
+#endif
+#include "bench_results.h"
+#include "cpu_dispatch.h"
+
+#define FNV_OFFSET_BASIS    0xcbf29ce484222325ULL
+#define FNV_PRIME           0x100000001b3ULL
+
+void bench_cpu_model(char *buffer, size_t size) {
+    snprintf(buffer, size, "unknown");
+
+#ifdef __APPLE__
+    size_t length = size;
+    if (sysctlbyname("machdep.cpu.brand_string", buffer, &length, NULL, 0) != 0) {
+        snprintf(buffer, size, "unknown");
+    }
+#else
+    FILE *cpuinfo = fopen("/proc/cpuinfo", "r");
+    if (!cpuinfo) return;
+
+    // x86: "model name"; ARM: implementer and part, unless a model name is given
+    char line[256];
+    char implementer[32] = "", part[32] = "";
+    while (fgets(line, sizeof(line), cpuinfo)) {
+        char *value = strchr(line, ':');
+        if (!value) continue;
+        value += strspn(value + 1, " \t") + 1;
+        value[strcspn(value, "\n")] = '\0';
+
+        if (strncmp(line, "model name", 10) == 0) {
+            snprintf(buffer, size, "%s", value);
+            implementer[0] = '\0';
+            break;
+        }
+        if (strncmp(line, "CPU implementer", 15) == 0 && !implementer[0]) {
+            snprintf(implementer, sizeof(implementer), "%s", value);
+        } else if (strncmp(line, "CPU part", 8) == 0 && !part[0]) {
+            snprintf(part, sizeof(part), "%s", value);
+        }
+    }
+    if (implementer[0]) snprintf(buffer, size, "implementer %s part %s", implementer, part);
+    fclose(cpuinfo);
+#endif
+}
+
+int bench_dataset_hash(const char *path, uint64_t *hash, uint64_t *size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror("open capture");
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        perror("stat capture");
+        close(fd);
+        return -1;
+    }
+
+    uint64_t h = FNV_OFFSET_BASIS;
+    size_t length = (size_t)st.st_size;
+    if (length > 0) {
+        const uint8_t *data = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            perror("mmap capture");
+            close(fd);
+            return -1;
+        }
+        madvise((void *)data, length, MADV_SEQUENTIAL);
+
+        size_t i = 0;
+        for (; i + 8 <= length; i += 8) {
+            uint64_t word;
+            memcpy(&word, data + i, sizeof(word));
+            h = (h ^ word) * FNV_PRIME;
+        }
+        if (i < length) {
+            uint64_t word = 0;
+            memcpy(&word, data + i, length - i);
+            h = (h ^ word) * FNV_PRIME;
+        }
+        munmap((void *)data, length);
+    }
+    close(fd);
+
+    *hash = (h ^ (uint64_t)length) * FNV_PRIME;
+    *size = (uint64_t)length;
+    return 0;
+}
+
+void bench_json_string(FILE *out, const char *text) {
+    fputc('"', out);
+    for (const char *c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(out, "\\%c", *c);
+        } else if ((unsigned char)*c < 0x20) {
+            fprintf(out, "\\u%04x", *c);
+        } else {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+FILE *bench_results_open(const char *path, const char *benchmark, const char *git_revision,
+                         const char *const *captures, int capture_count) {
+    char cpu_model[256];
+    char timestamp[32];
+    time_t now = time(NULL);
+    struct tm utc;
+
+    bench_cpu_model(cpu_model, sizeof(cpu_model));
+    gmtime_r(&now, &utc);
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", &utc);
+
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        perror("open JSON output");
+        return NULL;
+    }
+
+    fprintf(out, "{\n  \"schema_version\": %d,\n  \"benchmark\": ", BENCH_RESULTS_SCHEMA_VERSION);
+    bench_json_string(out, benchmark);
+    fprintf(out, ",\n  \"git_revision\": ");
+    bench_json_string(out, git_revision);
+    fprintf(out, ",\n  \"cpu_model\": ");
+    bench_json_string(out, cpu_model);
+    fprintf(out, ",\n  \"cpu_kernels\": \"%s\",\n  \"timestamp\": \"%s\",\n  \"datasets\": [",
+            cpu_isa_name(cpu_kernels.isa), timestamp);
+
+    for (int i = 0; i < capture_count; i++) {
+        uint64_t hash, size;
+        if (bench_dataset_hash(captures[i], &hash, &size) != 0) {
+            fclose(out);
+            return NULL;
+        }
+        fprintf(out, "%s\n    {\"path\": ", i ? "," : "");
+        bench_json_string(out, captures[i]);
+        fprintf(out, ", \"bytes\": %llu, \"hash\": \"fnv1a64:%016llx\"}",
+                (unsigned long long)size, (unsigned long long)hash);
+    }
+    fprintf(out, "%s],\n", capture_count ? "\n  " : "");
+    return out;
+}
+
+int bench_results_close(FILE *out) {
+    fprintf(out, "}\n");
+    if (fclose(out) != 0) {
+        perror("close JSON output");
+        return -1;
+    }
+    return 0;
+}
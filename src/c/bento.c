@@ -0,0 +1,267 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "bento.h"
+#include "pcap.h"
+#include "message_bus.h"
+#include "iex_tp.h"
+#include "top_of_book.h"
+
+// bento_message_t is the public name of parsed_message_t; batches are handed
+// out without copying, so the layouts must stay identical
+_Static_assert(sizeof(bento_message_t) == sizeof(parsed_message_t), "bento_message_t size");
+_Static_assert(offsetof(bento_message_t, symbol) == offsetof(parsed_message_t, symbol_hash),
+               "bento_message_t symbol");
+_Static_assert(offsetof(bento_message_t, message_type) == offsetof(parsed_message_t, message_type),
+               "bento_message_t message_type");
+_Static_assert(offsetof(bento_message_t, ask_price) == offsetof(parsed_message_t, ask_price),
+               "bento_message_t ask_price");
+_Static_assert(offsetof(bento_message_t, flags) == offsetof(parsed_message_t, flags),
+               "bento_message_t flags");
+
+// Held for the length of a run: the segment filter, parser_verbose and the
+// message bus registry a run uses are process-wide
+static atomic_flag run_active = ATOMIC_FLAG_INIT;
+
+// Capture whose batch the calling thread is delivering, so a snapshot taken
+// from a callback reads the book directly instead of waiting on itself
+static _Thread_local const struct bento_capture *delivering;
+
+typedef struct {
+    bento_message_fn fn;
+    void *user;
+} bento_handler_t;
+
+struct bento_capture {
+    mmap_context_t ctx;
+    bento_handler_t handlers[256];      // by message type
+    bento_handler_t any;
+    bento_batch_fn batch_fn;
+    void *batch_user;
+    int handler_count;                  // per-type handlers registered
+    char filter[16];                    // message-type filter set name
+    int verbose;
+    int running;
+    bento_stats_t stats;
+
+    // bento_track_book(): written on the delivery thread during a run
+    int tracking;
+    tob_book_t book;
+    tob_snapshot_t scratch;             // snapshot copied out under snapshot_lock
+    tob_channel_t channel;
+    pthread_mutex_t snapshot_lock;
+};
+
+static void bento_consume(void *state, const message_batch_t *batch, const symbol_id_t *ids) {
+    bento_capture_t *capture = (bento_capture_t *)state;
+    const bento_message_t *messages = (const bento_message_t *)batch->messages;
+
+    capture->stats.packets += batch->packets;
+    capture->stats.messages += batch->count;
+
+    // Snapshot requests are served here, between two batches
+    if (capture->tracking) {
+        tob_apply_batch(&capture->book, batch->messages, ids, batch->count);
+        tob_channel_poll(&capture->channel);
+    }
+
+    delivering = capture;
+    if (capture->batch_fn) capture->batch_fn(capture->batch_user, messages, batch->count);
+    if (capture->handler_count > 0 || capture->any.fn) {
+        for (uint32_t i = 0; i < batch->count; i++) {
+            const bento_handler_t *handler = &capture->handlers[messages[i].message_type];
+            if (handler->fn) {
+                handler->fn(handler->user, &messages[i]);
+            } else if (capture->any.fn) {
+                capture->any.fn(capture->any.user, &messages[i]);
+            }
+        }
+    }
+    delivering = NULL;
+}
+
+static void bento_finish(void *state, const message_bus_summary_t *summary) {
+    // The capture outlives the run; nothing to release
+    (void)state;
+    (void)summary;
+}
+
+bento_capture_t *bento_open(const char *path) {
+    bento_capture_t *capture = calloc(1, sizeof(bento_capture_t));
+    if (!capture) {
+        fprintf(stderr, "Failed to allocate capture\n");
+        return NULL;
+    }
+
+    if (pthread_mutex_init(&capture->snapshot_lock, NULL) != 0) {
+        free(capture);
+        return NULL;
+    }
+    if (init_mmap_parser(path, &capture->ctx) != 0) {
+        pthread_mutex_destroy(&capture->snapshot_lock);
+        free(capture);
+        return NULL;
+    }
+    strcpy(capture->filter, "all");
+    return capture;
+}
+
+void bento_close(bento_capture_t *capture) {
+    if (!capture) return;
+    bento_track_book(capture, 0);
+    pthread_mutex_destroy(&capture->snapshot_lock);
+    cleanup_mmap_parser(&capture->ctx);
+    free(capture);
+}
+
+int bento_on(bento_capture_t *capture, uint8_t message_type, bento_message_fn fn, void *user) {
+    bento_handler_t *handler = &capture->handlers[message_type];
+
+    if (handler->fn && !fn) capture->handler_count--;
+    if (!handler->fn && fn) capture->handler_count++;
+    handler->fn = fn;
+    handler->user = user;
+    return 0;
+}
+
+int bento_on_any(bento_capture_t *capture, bento_message_fn fn, void *user) {
+    capture->any.fn = fn;
+    capture->any.user = user;
+    return 0;
+}
+
+int bento_on_batch(bento_capture_t *capture, bento_batch_fn fn, void *user) {
+    capture->batch_fn = fn;
+    capture->batch_user = user;
+    return 0;
+}
+
+int bento_set_filter(bento_capture_t *capture, const char *filter) {
+    if (strlen(filter) >= sizeof(capture->filter) || !iex_tp_segment_decoder(filter)) return -1;
+    strcpy(capture->filter, filter);
+    return 0;
+}
+
+void bento_set_verbose(bento_capture_t *capture, int verbose) {
+    capture->verbose = verbose;
+}
+
+int bento_track_book(bento_capture_t *capture, int enable) {
+    if (capture->running) return -1;
+    if (!enable == !capture->tracking) return 0;
+
+    pthread_mutex_lock(&capture->snapshot_lock);
+    int result = 0;
+    if (enable) {
+        if (tob_book_init(&capture->book, SYMBOL_TABLE_MAX) != 0 ||
+            tob_book_init(&capture->scratch, SYMBOL_TABLE_MAX) != 0 ||
+            tob_channel_init(&capture->channel, &capture->book) != 0) {
+            tob_book_free(&capture->book);
+            tob_book_free(&capture->scratch);
+            result = -1;
+        } else {
+            capture->tracking = 1;
+        }
+    } else {
+        tob_channel_destroy(&capture->channel);
+        tob_book_free(&capture->book);
+        tob_book_free(&capture->scratch);
+        capture->tracking = 0;
+    }
+    pthread_mutex_unlock(&capture->snapshot_lock);
+    return result;
+}
+
+static int copy_quotes(const tob_book_t *book, bento_quote_t *quotes, uint32_t max) {
+    int quoted = 0;
+    for (uint32_t id = 0; id < book->active; id++) {
+        if (book->last_update[id] == 0) continue;
+        if ((uint32_t)quoted < max) {
+            quotes[quoted] = (bento_quote_t){
+                .symbol = book->symbol[id],
+                .timestamp_ns = book->last_update[id],
+                .bid_price = book->bid_price[id],
+                .ask_price = book->ask_price[id],
+                .bid_size = book->bid_size[id],
+                .ask_size = book->ask_size[id],
+            };
+        }
+        quoted++;
+    }
+    return quoted;
+}
+
+int bento_book_snapshot(bento_capture_t *capture, bento_quote_t *quotes, uint32_t max) {
+    // A callback owns the book for the whole batch and must not wait on
+    // another reader that is itself waiting for this batch to end
+    if (delivering == capture) return capture->tracking ? copy_quotes(&capture->book, quotes, max) : -1;
+
+    pthread_mutex_lock(&capture->snapshot_lock);
+    int result = -1;
+    if (capture->tracking && tob_request_snapshot(&capture->channel, &capture->scratch) == 0) {
+        result = copy_quotes(&capture->scratch, quotes, max);
+    }
+    pthread_mutex_unlock(&capture->snapshot_lock);
+    return result;
+}
+
+int bento_run(bento_capture_t *capture, int threads) {
+    if (atomic_flag_test_and_set_explicit(&run_active, memory_order_acquire)) {
+        fprintf(stderr, "bento_run: another run is active in this process\n");
+        return BENTO_ERR_BUSY;
+    }
+
+    message_consumer_t consumer = {
+        .name = "bento",
+        .state = capture,
+        .consume = bento_consume,
+        .finish = bento_finish,
+    };
+    if (message_bus_register(&consumer) != 0) {
+        atomic_flag_clear_explicit(&run_active, memory_order_release);
+        return -1;
+    }
+
+    memset(&capture->stats, 0, sizeof(capture->stats));
+    capture->running = 1;
+    if (capture->tracking) {
+        pthread_mutex_lock(&capture->snapshot_lock);
+        tob_book_reset(&capture->book);
+        tob_channel_open(&capture->channel);
+        pthread_mutex_unlock(&capture->snapshot_lock);
+    }
+    capture->ctx.offset = 0;
+    capture->ctx.released_to = 0;
+    capture->ctx.prefetched_to = 0;
+
+    int saved_verbose = parser_verbose;
+    parser_verbose = capture->verbose;
+    pcap_set_message_filter(capture->filter);
+    int result = (threads > 1) ? parse_pcap_file_parallel(&capture->ctx, threads)
+                               : parse_pcap_file(&capture->ctx);
+    pcap_set_message_filter("all");
+    parser_verbose = saved_verbose;
+
+    // The delivery thread has exited; the book is the readers' again
+    if (capture->tracking) tob_channel_close(&capture->channel);
+    capture->running = 0;
+
+    // A run that failed before delivery started leaves the consumer registered
+    message_bus_reset();
+    atomic_flag_clear_explicit(&run_active, memory_order_release);
+    return result;
+}
+
+void bento_get_stats(const bento_capture_t *capture, bento_stats_t *stats) {
+    *stats = capture->stats;
+}
+
+void bento_symbol_text(uint64_t symbol, char *out) {
+    memcpy(out, &symbol, 8);
+    int len = 8;
+    while (len > 0 && (out[len - 1] == ' ' || out[len - 1] == '\0')) len--;
+    out[len] = '\0';
+}
@@ -0,0 +1,289 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "pcap.h"
+#include "consumers.h"
+#include "top_of_book.h"
+#include "depth_book.h"
+#include "price_kernels.h"
+
+#define WRITER_BUFFER_SIZE  (1024 * 1024)
+
+// Book builder
+
+typedef struct {
+    tob_book_t book;
+    depth_book_t depth;
+} book_builder_t;
+
+// Set from a signal handler, taken by the builder between batches
+static atomic_int report_requested;
+
+void book_builder_request_report(void) {
+    atomic_store_explicit(&report_requested, 1, memory_order_relaxed);
+}
+
+// Market-wide summary of a book; busiest is SYMBOL_ID_INVALID to skip its line
+static void log_top_of_book(const char *label, const tob_book_t *book,
+                            symbol_id_t busiest, const char *name) {
+    uint32_t quoted = 0;
+    for (uint32_t id = 0; id < book->active; id++) {
+        if (book->last_update[id] != 0) quoted++;
+    }
+    size_t crossed = price_count_crossed(book->bid_price, book->ask_price, book->active);
+    PARSER_LOG("%s: %llu quotes applied, %u symbols quoted, %zu locked or crossed\n", label,
+               (unsigned long long)book->quotes_applied, quoted, crossed);
+
+    char bid[IEX_PRICE_TEXT_MAX], ask[IEX_PRICE_TEXT_MAX];
+    if (busiest < book->active && book->last_update[busiest] != 0) {
+        PARSER_LOG("  %-8s  %10u @ $%s  x  $%s @ %u\n", name,
+                   book->bid_size[busiest], iex_price_text(book->bid_price[busiest], bid),
+                   iex_price_text(book->ask_price[busiest], ask), book->ask_size[busiest]);
+    }
+
+    // Market-wide range of the quotes, straight off the price columns
+    iex_price_t low, high;
+    if (price_range(book->bid_price, book->active, &low, &high) > 0) {
+        PARSER_LOG("  bids $%s .. $%s\n", iex_price_text(low, bid), iex_price_text(high, ask));
+    }
+    if (price_range(book->ask_price, book->active, &low, &high) > 0) {
+        PARSER_LOG("  asks $%s .. $%s\n", iex_price_text(low, bid), iex_price_text(high, ask));
+    }
+}
+
+static void book_builder_consume(void *state, const message_batch_t *batch, const symbol_id_t *ids) {
+    book_builder_t *builder = (book_builder_t *)state;
+    tob_apply_batch(&builder->book, batch->messages, ids, batch->count);
+    depth_apply_batch(&builder->depth, batch->messages, ids, batch->count);
+
+    // This thread owns the book, so between batches it can be read in place
+    if (atomic_load_explicit(&report_requested, memory_order_relaxed) &&
+        atomic_exchange_explicit(&report_requested, 0, memory_order_relaxed)) {
+        log_top_of_book("Top of book (mid-run)", &builder->book, SYMBOL_ID_INVALID, NULL);
+        if (builder->depth.updates_applied > 0) {
+            PARSER_LOG("Depth book (mid-run): %llu level updates, %llu events, %llu crossed\n",
+                       (unsigned long long)builder->depth.updates_applied,
+                       (unsigned long long)builder->depth.events_completed,
+                       (unsigned long long)builder->depth.events_crossed);
+        }
+    }
+}
+
+static void book_builder_finish(void *state, const message_bus_summary_t *summary) {
+    book_builder_t *builder = (book_builder_t *)state;
+    symbol_id_t busiest = summary->busiest;
+
+    if (busiest != SYMBOL_ID_INVALID) {
+        char name[9];
+        symbol_table_name(summary->symbols, busiest, name);
+
+        // Closing top of book, read back through a market snapshot
+        tob_snapshot_t closing;
+        if (builder->book.quotes_applied > 0 &&
+            tob_book_init(&closing, builder->book.capacity) == 0) {
+            tob_snapshot(&builder->book, &closing);
+            log_top_of_book("Top of book", &closing, busiest, name);
+            tob_book_free(&closing);
+        }
+
+        // DEEP feeds: closing depth of the busiest symbol
+        if (builder->depth.updates_applied > 0) {
+            depth_level_t bids[5], asks[5];
+            uint32_t bid_count, ask_count;
+            depth_snapshot(&builder->depth, busiest, 5, bids, &bid_count, asks, &ask_count);
+
+            PARSER_LOG("Depth book: %llu level updates, %llu events, %llu dropped, %llu crossed\n",
+                       (unsigned long long)builder->depth.updates_applied,
+                       (unsigned long long)builder->depth.events_completed,
+                       (unsigned long long)builder->depth.updates_dropped,
+                       (unsigned long long)builder->depth.events_crossed);
+            char text[IEX_PRICE_TEXT_MAX];
+            for (uint32_t i = 0; i < bid_count || i < ask_count; i++) {
+                if (i < bid_count) PARSER_LOG("  %10u @ $%10s", bids[i].size, iex_price_text(bids[i].price, text));
+                else PARSER_LOG("  %25s", "");
+                if (i < ask_count) PARSER_LOG("  |  $%10s @ %u", iex_price_text(asks[i].price, text), asks[i].size);
+                PARSER_LOG("\n");
+            }
+        }
+    }
+
+    tob_book_free(&builder->book);
+    depth_book_free(&builder->depth);
+    free(builder);
+}
+
+int register_book_builder(void) {
+    book_builder_t *builder = calloc(1, sizeof(book_builder_t));
+    if (!builder) {
+        fprintf(stderr, "Failed to allocate book builder\n");
+        return -1;
+    }
+    if (tob_book_init(&builder->book, SYMBOL_TABLE_MAX) != 0 ||
+        depth_book_init(&builder->depth, SYMBOL_TABLE_MAX) != 0) {
+        tob_book_free(&builder->book);
+        free(builder);
+        return -1;
+    }
+
+    message_consumer_t consumer = {
+        .name = "book",
+        .state = builder,
+        .consume = book_builder_consume,
+        .finish = book_builder_finish,
+    };
+    if (message_bus_register(&consumer) != 0) {
+        book_builder_finish(builder, &(message_bus_summary_t){ .busiest = SYMBOL_ID_INVALID });
+        return -1;
+    }
+    return 0;
+}
+
+// Trade aggregator
+
+typedef struct {
+    uint64_t *volume;           // shares traded, indexed by symbol_id_t
+    __int128 *notional;         // sum of price * size in 1/10000 dollars; never wraps
+    uint64_t trades;
+} trade_aggregator_t;
+
+static void trade_aggregator_consume(void *state, const message_batch_t *batch, const symbol_id_t *ids) {
+    trade_aggregator_t *agg = (trade_aggregator_t *)state;
+
+    for (uint32_t i = 0; i < batch->count; i++) {
+        const parsed_message_t *msg = &batch->messages[i];
+        if (msg->message_type != IEX_TRADE_REPORT || ids[i] == SYMBOL_ID_INVALID) continue;
+
+        agg->volume[ids[i]] += msg->size;
+        agg->notional[ids[i]] += (__int128)msg->price * msg->size;
+        agg->trades++;
+    }
+}
+
+static void trade_aggregator_finish(void *state, const message_bus_summary_t *summary) {
+    trade_aggregator_t *agg = (trade_aggregator_t *)state;
+
+    if (agg->trades > 0 && summary->symbols) {
+        uint64_t total = 0;
+        symbol_id_t most_traded = 0;
+        for (uint32_t id = 0; id < summary->symbols->count; id++) {
+            total += agg->volume[id];
+            if (agg->volume[id] > agg->volume[most_traded]) most_traded = (symbol_id_t)id;
+        }
+
+        PARSER_LOG("Trades: %llu (%llu shares)", (unsigned long long)agg->trades,
+                   (unsigned long long)total);
+        if (agg->volume[most_traded] > 0) {
+            char name[9], vwap[IEX_PRICE_TEXT_MAX];
+            symbol_table_name(summary->symbols, most_traded, name);
+
+            // Round half away from zero to the nearest 1/10000
+            __int128 volume = agg->volume[most_traded];
+            __int128 notional = agg->notional[most_traded];
+            __int128 half = notional < 0 ? -volume / 2 : volume / 2;
+            PARSER_LOG("; most traded: %s %llu shares, VWAP $%s", name,
+                       (unsigned long long)agg->volume[most_traded],
+                       iex_price_text((iex_price_t)((notional + half) / volume), vwap));
+        }
+        PARSER_LOG("\n");
+    }
+
+    free(agg->volume);
+    free(agg->notional);
+    free(agg);
+}
+
+int register_trade_aggregator(void) {
+    trade_aggregator_t *agg = calloc(1, sizeof(trade_aggregator_t));
+    if (agg) {
+        agg->volume = calloc(SYMBOL_TABLE_MAX, sizeof(uint64_t));
+        agg->notional = calloc(SYMBOL_TABLE_MAX, sizeof(__int128));
+    }
+    if (!agg || !agg->volume || !agg->notional) {
+        fprintf(stderr, "Failed to allocate trade aggregator\n");
+        if (agg) {
+            free(agg->volume);
+            free(agg->notional);
+            free(agg);
+        }
+        return -1;
+    }
+
+    message_consumer_t consumer = {
+        .name = "trades",
+        .state = agg,
+        .consume = trade_aggregator_consume,
+        .finish = trade_aggregator_finish,
+    };
+    if (message_bus_register(&consumer) != 0) {
+        trade_aggregator_finish(agg, &(message_bus_summary_t){ .busiest = SYMBOL_ID_INVALID });
+        return -1;
+    }
+    return 0;
+}
+
+// Message writer
+
+typedef struct {
+    FILE *out;
+    const char *path;
+    uint64_t written;
+    int failed;
+} message_writer_t;
+
+static void message_writer_consume(void *state, const message_batch_t *batch, const symbol_id_t *ids) {
+    message_writer_t *writer = (message_writer_t *)state;
+    (void)ids;
+
+    if (writer->failed || batch->count == 0) return;
+    if (fwrite(batch->messages, sizeof(parsed_message_t), batch->count, writer->out) != batch->count) {
+        perror("fwrite");
+        writer->failed = 1;
+        return;
+    }
+    writer->written += batch->count;
+}
+
+static void message_writer_finish(void *state, const message_bus_summary_t *summary) {
+    message_writer_t *writer = (message_writer_t *)state;
+    (void)summary;
+
+    if (fclose(writer->out) != 0) {
+        perror("fclose");
+        writer->failed = 1;
+    }
+    if (!writer->failed) {
+        PARSER_LOG("Wrote %llu messages to %s\n", (unsigned long long)writer->written, writer->path);
+    }
+    free(writer);
+}
+
+int register_message_writer(const char *path) {
+    message_writer_t *writer = calloc(1, sizeof(message_writer_t));
+    if (!writer) {
+        fprintf(stderr, "Failed to allocate message writer\n");
+        return -1;
+    }
+
+    writer->out = fopen(path, "wb");
+    if (!writer->out) {
+        perror("fopen");
+        free(writer);
+        return -1;
+    }
+    setvbuf(writer->out, NULL, _IOFBF, WRITER_BUFFER_SIZE);
+    writer->path = path;
+
+    message_consumer_t consumer = {
+        .name = "writer",
+        .state = writer,
+        .consume = message_writer_consume,
+        .finish = message_writer_finish,
+    };
+    if (message_bus_register(&consumer) != 0) {
+        writer->failed = 1;
+        message_writer_finish(writer, NULL);
+        return -1;
+    }
+    return 0;
+}
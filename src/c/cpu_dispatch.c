@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <string.h>
+#include "cpu_dispatch.h"
+
+cpu_kernels_t cpu_kernels;
+
+static const char *const isa_names[CPU_ISA_COUNT] = {
+    [CPU_ISA_SCALAR] = "scalar",
+    [CPU_ISA_SSE42]  = "sse4.2",
+    [CPU_ISA_AVX2]   = "avx2",
+    [CPU_ISA_AVX512] = "avx512",
+    [CPU_ISA_NEON]   = "neon",
+};
+
+const char *cpu_isa_name(cpu_isa_t isa) {
+    return (isa < CPU_ISA_COUNT) ? isa_names[isa] : "unknown";
+}
+
+int cpu_isa_supported(cpu_isa_t isa) {
+    simd_capabilities_t caps;
+    detect_simd_capabilities(&caps);
+
+    switch (isa) {
+        case CPU_ISA_SCALAR: return 1;
+        case CPU_ISA_SSE42:  return caps.has_sse42;
+        case CPU_ISA_AVX2:   return caps.has_sse42 && caps.has_avx2;
+        case CPU_ISA_AVX512: return caps.has_sse42 && caps.has_avx2 && caps.has_avx512;
+        case CPU_ISA_NEON:   return caps.has_neon;
+        default:             return 0;
+    }
+}
+
+cpu_isa_t cpu_isa_best(void) {
+    static const cpu_isa_t preference[] = {
+        CPU_ISA_AVX512, CPU_ISA_AVX2, CPU_ISA_SSE42, CPU_ISA_NEON
+    };
+
+    for (size_t i = 0; i < sizeof(preference) / sizeof(preference[0]); i++) {
+        if (cpu_isa_supported(preference[i])) return preference[i];
+    }
+    return CPU_ISA_SCALAR;
+}
+
+void cpu_dispatch_select(cpu_isa_t isa) {
+    cpu_kernels_t kernels;
+    memset(&kernels, 0, sizeof(kernels));
+    kernels.isa = isa;
+
+    pcapng_kernels_resolve(isa, &kernels);
+    iex_tp_kernels_resolve(isa, &kernels);
+    symbol_table_kernels_resolve(isa, &kernels);
+    price_kernels_resolve(isa, &kernels);
+    simd_kernels_resolve(isa, &kernels);
+
+    cpu_kernels = kernels;
+}
+
+int cpu_dispatch_force(const char *name) {
+    for (int isa = 0; isa < CPU_ISA_COUNT; isa++) {
+        if (strcmp(name, isa_names[isa]) != 0) continue;
+
+        if (!cpu_isa_supported((cpu_isa_t)isa)) {
+            fprintf(stderr, "This CPU does not support %s kernels\n", name);
+            return -1;
+        }
+        cpu_dispatch_select((cpu_isa_t)isa);
+        return 0;
+    }
+
+    fprintf(stderr, "Unknown ISA: %s (scalar, sse4.2, avx2, avx512 or neon)\n", name);
+    return -1;
+}
+
+// Selected once, before main() or when the library is loaded
+__attribute__((constructor))
+static void cpu_dispatch_startup(void) {
+    cpu_dispatch_select(cpu_isa_best());
+}
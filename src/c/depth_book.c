@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "iex.h"
+#include "iex_tp.h"
+#include "depth_book.h"
+
+#define DEPTH_ALIGNMENT 64
+
+// The size classes in depth_book.h assume 16-byte levels
+_Static_assert(sizeof(depth_level_t) == 16, "depth_level_t layout");
+
+static inline size_t class_levels(uint8_t size_class) {
+    return (size_t)DEPTH_MIN_LEVELS << size_class;
+}
+
+static depth_level_t *pool_alloc(depth_pool_t *pool, uint8_t size_class) {
+    void *block = pool->free_lists[size_class];
+    if (block) {
+        pool->free_lists[size_class] = *(void **)block;
+        return block;
+    }
+
+    size_t bytes = class_levels(size_class) * sizeof(depth_level_t);
+    if (pool->cursor_remaining < bytes) {
+        if (pool->slab_count == pool->slab_capacity) {
+            size_t grown = pool->slab_capacity ? pool->slab_capacity * 2 : 64;
+            void **slabs = realloc(pool->slabs, grown * sizeof(void *));
+            if (!slabs) return NULL;
+            pool->slabs = slabs;
+            pool->slab_capacity = grown;
+        }
+
+        void *slab = NULL;
+        size_t slab_size = bytes > DEPTH_POOL_SLAB_SIZE ? bytes : DEPTH_POOL_SLAB_SIZE;
+        if (posix_memalign(&slab, DEPTH_ALIGNMENT, slab_size) != 0) return NULL;
+
+        pool->slabs[pool->slab_count++] = slab;
+        pool->cursor = slab;
+        pool->cursor_remaining = slab_size;
+    }
+
+    // Blocks are powers of two >= 64 bytes, so carving keeps them aligned
+    block = pool->cursor;
+    pool->cursor += bytes;
+    pool->cursor_remaining -= bytes;
+    return block;
+}
+
+static void pool_release(depth_pool_t *pool, depth_level_t *levels, uint8_t size_class) {
+    *(void **)levels = pool->free_lists[size_class];
+    pool->free_lists[size_class] = levels;
+}
+
+// Sort key: ascending for both sides with the best price last
+static inline int64_t level_key(iex_price_t price, int is_bid) {
+    return is_bid ? price : ~price;
+}
+
+static uint32_t lower_bound(const depth_side_t *side, int64_t key, int is_bid) {
+    uint32_t lo = 0, hi = side->count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (level_key(side->levels[mid].price, is_bid) < key) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// Returns 0, or -1 if the level could not be stored
+static int update_side(depth_pool_t *pool, depth_side_t *side, int is_bid,
+                       iex_price_t price, uint32_t size) {
+    uint32_t pos = lower_bound(side, level_key(price, is_bid), is_bid);
+    int found = pos < side->count && side->levels[pos].price == price;
+
+    if (size == 0) {
+        if (found) {
+            memmove(&side->levels[pos], &side->levels[pos + 1],
+                    (side->count - pos - 1) * sizeof(depth_level_t));
+            side->count--;
+        }
+        return 0;
+    }
+
+    if (found) {
+        side->levels[pos].size = size;
+        return 0;
+    }
+
+    if (!side->levels) {
+        side->levels = pool_alloc(pool, 0);
+        if (!side->levels) return -1;
+        side->size_class = 0;
+    } else if (side->count == class_levels(side->size_class)) {
+        if (side->size_class + 1 >= DEPTH_SIZE_CLASSES) return -1;
+
+        depth_level_t *grown = pool_alloc(pool, side->size_class + 1);
+        if (!grown) return -1;
+        memcpy(grown, side->levels, side->count * sizeof(depth_level_t));
+        pool_release(pool, side->levels, side->size_class);
+        side->levels = grown;
+        side->size_class++;
+    }
+
+    memmove(&side->levels[pos + 1], &side->levels[pos],
+            (side->count - pos) * sizeof(depth_level_t));
+    side->levels[pos].price = price;
+    side->levels[pos].size = size;
+    side->count++;
+    return 0;
+}
+
+static void apply_level(depth_book_t *book, symbol_id_t id, uint8_t side,
+                        iex_price_t price, uint32_t size) {
+    depth_symbol_t *sym = &book->symbols[id];
+    int is_bid = (side == 'B');
+
+    if (update_side(&book->pool, is_bid ? &sym->bids : &sym->asks, is_bid, price, size) != 0) {
+        book->updates_dropped++;
+        return;
+    }
+    book->updates_applied++;
+}
+
+int depth_book_init(depth_book_t *book, uint32_t capacity) {
+    memset(book, 0, sizeof(*book));
+
+    book->symbols = calloc(capacity, sizeof(depth_symbol_t));
+    book->staged = malloc(DEPTH_STAGING_CAPACITY * sizeof(depth_staged_update_t));
+    if (!book->symbols || !book->staged) {
+        fprintf(stderr, "Failed to allocate depth book\n");
+        depth_book_free(book);
+        return -1;
+    }
+
+    book->capacity = capacity;
+    return 0;
+}
+
+void depth_book_free(depth_book_t *book) {
+    for (size_t i = 0; i < book->pool.slab_count; i++) {
+        free(book->pool.slabs[i]);
+    }
+    free(book->pool.slabs);
+    free(book->symbols);
+    free(book->staged);
+    memset(book, 0, sizeof(*book));
+}
+
+void depth_apply_update(depth_book_t *book, symbol_id_t id, uint8_t side,
+                        iex_price_t price, uint32_t size, uint64_t timestamp, uint8_t flags) {
+    if (id >= book->capacity) return;
+
+    if (!(flags & IEX_DEEP_EVENT_COMPLETE)) {
+        if (book->staged_count < DEPTH_STAGING_CAPACITY) {
+            depth_staged_update_t *staged = &book->staged[book->staged_count++];
+            staged->id = id;
+            staged->side = side;
+            staged->price = price;
+            staged->size = size;
+            staged->timestamp = timestamp;
+            return;
+        }
+        // Staging full: fall through and apply without waiting for the event
+    }
+
+    // Event complete: release this symbol's staged updates in arrival order
+    if (book->staged_count > 0) {
+        uint32_t kept = 0;
+        for (uint32_t i = 0; i < book->staged_count; i++) {
+            depth_staged_update_t *staged = &book->staged[i];
+            if (staged->id == id) {
+                apply_level(book, id, staged->side, staged->price, staged->size);
+            } else {
+                book->staged[kept++] = *staged;
+            }
+        }
+        book->staged_count = kept;
+    }
+
+    apply_level(book, id, side, price, size);
+
+    if (flags & IEX_DEEP_EVENT_COMPLETE) {
+        depth_symbol_t *sym = &book->symbols[id];
+        sym->last_update = timestamp;
+        book->events_completed++;
+
+        // A consistent feed never leaves the touch locked or crossed
+        if (sym->bids.count > 0 && sym->asks.count > 0 &&
+            sym->bids.levels[sym->bids.count - 1].price >= sym->asks.levels[sym->asks.count - 1].price) {
+            book->events_crossed++;
+        }
+    }
+}
+
+void depth_apply_batch(depth_book_t *book, const parsed_message_t *messages,
+                       const symbol_id_t *ids, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        const parsed_message_t *msg = &messages[i];
+        if (msg->message_type != IEX_PRICE_LEVEL_BUY && msg->message_type != IEX_PRICE_LEVEL_SELL) continue;
+        if (ids[i] == SYMBOL_ID_INVALID) continue;
+
+        depth_apply_update(book, ids[i], msg->side, msg->price, msg->size,
+                           msg->timestamp_ns, msg->flags);
+    }
+}
+
+static uint32_t copy_best_first(const depth_side_t *side, uint32_t max_levels, depth_level_t *out) {
+    uint32_t n = side->count < max_levels ? side->count : max_levels;
+    for (uint32_t i = 0; i < n; i++) {
+        out[i] = side->levels[side->count - 1 - i];
+    }
+    return n;
+}
+
+void depth_snapshot(const depth_book_t *book, symbol_id_t id, uint32_t max_levels,
+                    depth_level_t *bids, uint32_t *bid_count,
+                    depth_level_t *asks, uint32_t *ask_count) {
+    if (id >= book->capacity) {
+        *bid_count = 0;
+        *ask_count = 0;
+        return;
+    }
+
+    const depth_symbol_t *sym = &book->symbols[id];
+    *bid_count = copy_best_first(&sym->bids, max_levels, bids);
+    *ask_count = copy_best_first(&sym->asks, max_levels, asks);
+}
@@ -0,0 +1,209 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "iex.h"
+#include "iex_tp.h"
+#include "cpu_dispatch.h"
+
+// How each schema message fills a parsed_message_t
+// P(name, price, size, side, ask_price, ask_size), expressions over msg.
+// Prices keep the schema's full 8-byte fixed-point value.
+#define IEX_PROJECTIONS(P)                                                          \
+    P(quote_update,       iex_quote_update_bid_price(msg),                          \
+                          iex_quote_update_bid_size(msg), 'B',                      \
+                          iex_quote_update_ask_price(msg),                          \
+                          iex_quote_update_ask_size(msg))                           \
+    /* IEX does not publish the aggressor side */                                   \
+    P(trade_report,       iex_trade_report_price(msg),                              \
+                          iex_trade_report_size(msg), ' ', 0, 0)                    \
+    P(trade_break,        iex_trade_break_price(msg),                               \
+                          iex_trade_break_size(msg), ' ', 0, 0)                     \
+    P(price_level_buy,    iex_price_level_buy_price(msg),                           \
+                          iex_price_level_buy_size(msg), 'B', 0, 0)                 \
+    P(price_level_sell,   iex_price_level_sell_price(msg),                          \
+                          iex_price_level_sell_size(msg), 'S', 0, 0)                \
+    /* side: 'Q' opening, 'M' closing */                                            \
+    P(official_price,     iex_official_price_price(msg), 0,                         \
+                          iex_official_price_flags(msg), 0, 0)                      \
+    P(security_directory, iex_security_directory_adjusted_poc_price(msg),           \
+                          iex_security_directory_round_lot_size(msg),               \
+                          iex_security_directory_flags(msg), 0, 0)                  \
+    /* side: auction type */                                                        \
+    P(auction_info,       iex_auction_info_reference_price(msg),                    \
+                          iex_auction_info_paired_shares(msg),                      \
+                          iex_auction_info_flags(msg), 0, 0)                        \
+    /* side: status or event code */                                                \
+    P(trading_status,     0, 0, iex_trading_status_flags(msg), 0, 0)                \
+    P(operational_halt,   0, 0, iex_operational_halt_flags(msg), 0, 0)              \
+    P(short_sale_price,   0, 0, iex_short_sale_price_flags(msg), 0, 0)              \
+    P(security_event,     0, 0, iex_security_event_flags(msg), 0, 0)                \
+    P(system_event,       0, 0, iex_system_event_flags(msg), 0, 0)
+
+// Fill one parsed_message_t from a framed message
+// Only messages in types are decoded; with types a constant the switch
+// keeps just their cases. Messages without a symbol (system events) also
+// carry no flags beyond the event code in side.
+// Returns 1 if the message was recognised and written, 0 otherwise.
+static inline __attribute__((always_inline))
+int decode_message(const uint8_t *msg, uint16_t len, parsed_message_t *out, uint64_t types) {
+    uint8_t type = msg[IEX_MSG_TYPE_OFFSET];
+
+    switch (type) {
+#define IEX_DECODE_CASE(name, price_, size_, side_, ask_price_, ask_size_)                  \
+        case IEX_TYPE(name): {                                                          \
+            int has_symbol = IEX_LENGTH(name) >= IEX_MSG_HEADER_LENGTH;                 \
+            if (!(types & IEX_TYPE_BIT(IEX_TYPE(name))) || len < IEX_LENGTH(name)) return 0; \
+            out->timestamp_ns = iex_##name##_timestamp(msg);                            \
+            out->symbol_hash = has_symbol ? iex_msg_symbol(msg) : 0;                    \
+            out->price = (price_);                                                      \
+            out->size = (size_);                                                        \
+            out->message_type = type;                                                   \
+            out->side = (side_);                                                        \
+            out->ask_price = (ask_price_);                                              \
+            out->ask_size = (ask_size_);                                                \
+            out->flags = has_symbol ? iex_##name##_flags(msg) : 0;                      \
+            return 1;                                                                   \
+        }
+        IEX_PROJECTIONS(IEX_DECODE_CASE)
+#undef IEX_DECODE_CASE
+        default:
+            return 0;
+    }
+}
+
+// Compile-time filtered segment walk
+// Inlined into one function per filter set with type_mask a constant. The
+// protocol ID picks one of three copies of the loop, each with the filter
+// intersected with that feed's schema, so decode_message keeps only the
+// wanted cases and every other message costs only the length-prefix hop.
+static inline __attribute__((always_inline))
+uint32_t decode_messages(iex_tp_segment_t *seg, parsed_message_t *out, uint32_t max_out,
+                         uint64_t types) {
+    uint32_t count = 0;
+    const uint8_t *msg;
+    uint16_t msg_len;
+
+    if (types == 0) return 0;
+    while (count < max_out && (msg = iex_tp_next_message(seg, &msg_len)) != NULL) {
+        count += decode_message(msg, msg_len, &out[count], types);
+    }
+
+    return count;
+}
+
+static inline __attribute__((always_inline))
+uint32_t decode_segment_filtered(const uint8_t *udp_payload, size_t len,
+                                 parsed_message_t *out, uint32_t max_out, uint64_t type_mask) {
+    iex_tp_segment_t seg;
+    if (iex_tp_segment_init(&seg, udp_payload, len) != 0) return 0;
+
+    switch (seg.header->message_protocol_id) {
+        case IEX_TP_PROTOCOL_TOPS:
+            return decode_messages(&seg, out, max_out, type_mask & IEX_TOPS_1_6_TYPES);
+        case IEX_TP_PROTOCOL_DEEP:
+            return decode_messages(&seg, out, max_out, type_mask & IEX_DEEP_1_0_TYPES);
+        default:
+            return decode_messages(&seg, out, max_out, type_mask & IEX_SCHEMA_ALL_TYPES);
+    }
+}
+
+// One copy of every filtered decoder per instruction set
+// The loops are plain C; compiling them for a wider target lets the compiler
+// use its registers and moves for the record stores. IEX_ISA and
+// IEX_ISA_TARGET name the copy being expanded.
+#define IEX_CAT3(a, b, c) IEX_CAT3_(a, b, c)
+#define IEX_CAT3_(a, b, c) a##b##c
+#define IEX_VARIANT(name) IEX_CAT3(decode_##name, _, IEX_ISA)
+
+#define IEX_DEFINE_VARIANT(name, mask)                                                  \
+    static IEX_ISA_TARGET uint32_t IEX_VARIANT(name)(const uint8_t *udp_payload,        \
+                                                     size_t len, parsed_message_t *out, \
+                                                     uint32_t max_out) {                \
+        return decode_segment_filtered(udp_payload, len, out, max_out, (mask));          \
+    }
+#define IEX_VARIANT_ENTRY(name, mask) IEX_VARIANT(name),
+
+#define IEX_DEFINE_VARIANTS()                                                           \
+    IEX_DEFINE_VARIANT(all, IEX_FILTER_ALL)                                             \
+    IEX_FILTER_SETS(IEX_DEFINE_VARIANT)                                                 \
+    static const iex_segment_decoder_fn IEX_CAT3(decoders_, IEX_ISA, )[IEX_FILTER_COUNT] = { \
+        IEX_VARIANT(all), IEX_FILTER_SETS(IEX_VARIANT_ENTRY)                            \
+    };
+
+#define IEX_ISA scalar
+#define IEX_ISA_TARGET
+IEX_DEFINE_VARIANTS()
+#undef IEX_ISA
+#undef IEX_ISA_TARGET
+
+#if defined(__x86_64__)
+#define IEX_ISA sse42
+#define IEX_ISA_TARGET CPU_TARGET_SSE42
+IEX_DEFINE_VARIANTS()
+#undef IEX_ISA
+#undef IEX_ISA_TARGET
+
+#define IEX_ISA avx2
+#define IEX_ISA_TARGET CPU_TARGET_AVX2
+IEX_DEFINE_VARIANTS()
+#undef IEX_ISA
+#undef IEX_ISA_TARGET
+
+#define IEX_ISA avx512
+#define IEX_ISA_TARGET CPU_TARGET_AVX512
+IEX_DEFINE_VARIANTS()
+#undef IEX_ISA
+#undef IEX_ISA_TARGET
+#endif
+
+void iex_tp_kernels_resolve(cpu_isa_t isa, cpu_kernels_t *kernels) {
+    const iex_segment_decoder_fn *decoders = decoders_scalar;
+#if defined(__x86_64__)
+    if (isa == CPU_ISA_SSE42) decoders = decoders_sse42;
+    if (isa == CPU_ISA_AVX2) decoders = decoders_avx2;
+    if (isa == CPU_ISA_AVX512) decoders = decoders_avx512;
+#else
+    (void)isa;      // ARMv8 baseline already includes NEON
+#endif
+    memcpy(kernels->decode_segment, decoders, sizeof(kernels->decode_segment));
+}
+
+// Public entry points go through the active copy
+uint32_t iex_tp_decode_segment(const uint8_t *udp_payload, size_t len,
+                               parsed_message_t *out, uint32_t max_out) {
+    return cpu_kernels.decode_segment[IEX_FILTER_INDEX_all](udp_payload, len, out, max_out);
+}
+
+#define IEX_DEFINE_FILTERED(name, mask)                                                  \
+    uint32_t iex_tp_decode_segment_##name(const uint8_t *udp_payload, size_t len,       \
+                                          parsed_message_t *out, uint32_t max_out) {     \
+        return cpu_kernels.decode_segment[IEX_FILTER_INDEX_##name](udp_payload, len,     \
+                                                                   out, max_out);        \
+    }
+IEX_FILTER_SETS(IEX_DEFINE_FILTERED)
+#undef IEX_DEFINE_FILTERED
+
+iex_segment_decoder_fn iex_tp_segment_decoder(const char *filter) {
+    if (strcmp(filter, "all") == 0) return iex_tp_decode_segment;
+#define IEX_MATCH_FILTER(name, mask) if (strcmp(filter, #name) == 0) return iex_tp_decode_segment_##name;
+    IEX_FILTER_SETS(IEX_MATCH_FILTER)
+#undef IEX_MATCH_FILTER
+    return NULL;
+}
+
+int iex_tp_filter_index(const char *filter) {
+    if (strcmp(filter, "all") == 0) return IEX_FILTER_INDEX_all;
+#define IEX_MATCH_INDEX(name, mask) if (strcmp(filter, #name) == 0) return IEX_FILTER_INDEX_##name;
+    IEX_FILTER_SETS(IEX_MATCH_INDEX)
+#undef IEX_MATCH_INDEX
+    return -1;
+}
+
+uint32_t iex_tp_decode_frame(const uint8_t *frame, size_t caplen,
+                             parsed_message_t *out, uint32_t max_out) {
+    size_t payload_len;
+    const uint8_t *payload = iex_udp_payload(frame, caplen, &payload_len);
+    if (!payload) return 0;
+
+    return iex_tp_decode_segment(payload, payload_len, out, max_out);
+}
@@ -1,34 +1,188 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <signal.h>
 #include <time.h>
 #include <sys/time.h>
+#include <sys/resource.h>
 #include "pcap.h"
+#include "pcap_index.h"
+#include "uring_reader.h"
+#include "consumers.h"
+#include "cpu_dispatch.h"
+#include "pipeline_stats.h"
 
 void print_usage(const char *prog_name) {
-    printf("Usage: %s <pcap_file>\n", prog_name);
+    printf("Usage: %s [-j threads] [-i] [-t HH:MM:SS.fff | -s seq] [-u HH:MM:SS.fff] [-S SYM,...] [-T filter] [-o out.bin] [--force-isa isa] <pcap_file>\n",
+           prog_name);
     printf("High-performance IEX PCAP parser for HFT systems\n");
+    printf("  -j <threads>  Decode pcapng partitions on N worker threads (default: 1)\n");
+    printf("  -i            Build or load the <pcap_file>.idx packet index\n");
+    printf("  -t <time>     Start at a UTC time of day (uses the packet index)\n");
+    printf("  -s <seq>      Start at an IEX-TP sequence number (uses the packet index)\n");
+    printf("  -u <time>     Stop after a UTC time of day; skips chunks via zone maps (no -j)\n");
+    printf("  -S <symbols>  Only decode chunks that may contain these symbols (comma separated, no -j)\n");
+    printf("  -R <reader>   mmap (default), uring, or uring-direct (io_uring with O_DIRECT)\n");
+    printf("  -w <MB>       Keep only a sliding window of the mapping resident\n");
+    printf("  -T <filter>   Decode only trades, quotes, depth or book messages (default: all)\n");
+    printf("  -o <file>     Also write decoded messages as packed records\n");
+    printf("  --force-isa <isa>  Use scalar, sse4.2, avx2, avx512 or neon kernels (default: best supported)\n");
+    printf("Send SIGUSR1 while running to print the current top of book\n");
+}
+
+static void on_report_signal(int sig) {
+    (void)sig;
+    book_builder_request_report();
 }
 
 double get_time_diff(struct timeval *start, struct timeval *end) {
     return (end->tv_sec - start->tv_sec) + (end->tv_usec - start->tv_usec) / 1000000.0;
 }
 
+// Peak resident set size in MB
+double get_peak_rss_mb(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / (1024.0 * 1024.0);   // bytes
+#else
+    return usage.ru_maxrss / 1024.0;              // kilobytes
+#endif
+}
+
 int main(int argc, char *argv[]) {
-    if (argc != 2) {
+    const char *filename = NULL;
+    int num_threads = 1;
+    int use_index = 0;
+    const char *seek_time = NULL;
+    const char *seek_seq = NULL;
+    const char *until_time = NULL;
+    char *symbols = NULL;
+    int use_uring = 0;
+    int uring_direct = 0;
+    size_t window_mb = 0;
+    const char *output_path = NULL;
+    const char *filter = NULL;
+    const char *force_isa = NULL;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-i") == 0) {
+            use_index = 1;
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            seek_time = argv[++i];
+            use_index = 1;
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seek_seq = argv[++i];
+            use_index = 1;
+        } else if (strcmp(argv[i], "-u") == 0 && i + 1 < argc) {
+            until_time = argv[++i];
+            use_index = 1;
+        } else if (strcmp(argv[i], "-S") == 0 && i + 1 < argc) {
+            symbols = argv[++i];
+            use_index = 1;
+        } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            window_mb = (size_t)strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-T") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--force-isa") == 0 && i + 1 < argc) {
+            force_isa = argv[++i];
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (strcmp(argv[i], "-R") == 0 && i + 1 < argc) {
+            const char *reader = argv[++i];
+            if (strcmp(reader, "uring") == 0) {
+                use_uring = 1;
+            } else if (strcmp(reader, "uring-direct") == 0) {
+                use_uring = 1;
+                uring_direct = 1;
+            } else if (strcmp(reader, "mmap") != 0) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (argv[i][0] != '-' && !filename) {
+            filename = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    
+    // Zone-map queries take their time window from -t/-u, not from a seek
+    int query_mode = (until_time || symbols);
+    if (!filename || num_threads < 1 || (seek_time && seek_seq) || (query_mode && seek_seq)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    // The io_uring reader streams the file once, front to back
+    if (use_uring && (use_index || num_threads > 1)) {
+        fprintf(stderr, "-R uring cannot be combined with -j or index options\n");
+        return 1;
+    }
+    
+    // Zone-map queries decode the matching chunks on one thread
+    if (query_mode && num_threads > 1) {
+        fprintf(stderr, "-S and -u queries cannot be combined with -j\n");
+        return 1;
+    }
+    
+    if (force_isa && cpu_dispatch_force(force_isa) != 0) {
         print_usage(argv[0]);
         return 1;
     }
     
-    const char *filename = argv[1];
+    if (filter && pcap_set_message_filter(filter) != 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    // Downstream consumers, each fed from its own ring
+    if (register_book_builder() != 0 || register_trade_aggregator() != 0 ||
+        (output_path && register_message_writer(output_path) != 0)) {
+        fprintf(stderr, "Failed to set up message consumers\n");
+        return 1;
+    }
+    
+    struct sigaction report_action = { .sa_handler = on_report_signal };
+    sigemptyset(&report_action.sa_mask);
+    report_action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &report_action, NULL);
+    
     mmap_context_t ctx = {0};
     struct timeval start, end;
     
     printf("Initializing high-performance PCAP parser...\n");
     printf("Target file: %s\n", filename);
+    printf("CPU kernels: %s\n", cpu_isa_name(cpu_kernels.isa));
     
     gettimeofday(&start, NULL);
     
+    if (use_uring) {
+        size_t file_size = 0;
+        int result = parse_pcap_file_uring(filename, uring_direct, &file_size);
+        
+        if (result != URING_UNAVAILABLE) {
+            gettimeofday(&end, NULL);
+            double elapsed = get_time_diff(&start, &end);
+            
+            if (result != 0) {
+                fprintf(stderr, "Parse failed with result: %d\n", result);
+            }
+            printf("\nPerformance Results:\n");
+            printf("File size: %.2f MB\n", file_size / (1024.0 * 1024.0));
+            printf("Parse time: %.3f seconds\n", elapsed);
+            printf("Throughput: %.2f MB/s\n", (file_size / (1024.0 * 1024.0)) / elapsed);
+            printf("Peak RSS: %.1f MB\n", get_peak_rss_mb());
+#if PIPELINE_STATS
+            pipeline_stats_report(stdout);
+#endif
+            return (result == 0) ? 0 : 1;
+        }
+        printf("io_uring unavailable, falling back to mmap\n");
+    }
+    
     // Initialize memory-mapped parser
     if (init_mmap_parser(filename, &ctx) != 0) {
         fprintf(stderr, "Failed to initialize parser\n");
@@ -37,8 +191,69 @@ int main(int argc, char *argv[]) {
     
     printf("File mapped successfully, size: %zu bytes\n", ctx.size);
     
+    if (window_mb > 0) {
+        ctx.window_size = window_mb * 1024 * 1024;
+        printf("Residency window: %zu MB\n", window_mb);
+    }
+    
+    pcap_index_t index = {0};
+    pcap_query_t query;
+    pcap_query_init(&query);
+    
+    if (use_index) {
+        if (pcap_index_open(filename, &ctx, PCAP_INDEX_DEFAULT_STRIDE, &index) != 0) {
+            fprintf(stderr, "Failed to open packet index\n");
+            cleanup_mmap_parser(&ctx);
+            return 1;
+        }
+        
+        const char *times[2] = { seek_time, until_time };
+        uint64_t *bounds[2] = { &query.from_timestamp, &query.until_timestamp };
+        for (int i = 0; i < 2; i++) {
+            uint64_t tod_ns;
+            if (!times[i]) continue;
+            if (pcap_parse_time_of_day(times[i], &tod_ns) != 0) {
+                fprintf(stderr, "Invalid time of day: %s\n", times[i]);
+                pcap_index_free(&index);
+                cleanup_mmap_parser(&ctx);
+                return 1;
+            }
+            *bounds[i] = pcap_index_time_of_day(&index, tod_ns);
+        }
+        
+        for (char *sym = symbols ? strtok(symbols, ",") : NULL; sym; sym = strtok(NULL, ",")) {
+            if (pcap_query_add_symbol(&query, sym) != 0) {
+                fprintf(stderr, "At most %d symbols per query\n", PCAP_QUERY_MAX_SYMBOLS);
+                pcap_index_free(&index);
+                cleanup_mmap_parser(&ctx);
+                return 1;
+            }
+        }
+        
+        int seek_result = 0;
+        if (query_mode) {
+            // parse_pcap_file_query walks the zone maps itself
+        } else if (seek_time) {
+            seek_result = pcap_index_seek_time(&index, &ctx, query.from_timestamp);
+        } else if (seek_seq) {
+            seek_result = pcap_index_seek_sequence(&index, &ctx, strtoull(seek_seq, NULL, 10));
+        }
+        
+        if (seek_result != 0) {
+            printf("Seek target precedes the first indexed packet, starting from the beginning\n");
+        }
+    }
+    
     // Parse the PCAP file
-    int result = parse_pcap_file(&ctx);
+    int result;
+    if (query_mode) {
+        result = parse_pcap_file_query(&ctx, &index, &query);
+    } else if (num_threads > 1) {
+        result = parse_pcap_file_parallel(&ctx, num_threads);
+    } else {
+        result = parse_pcap_file(&ctx);
+    }
+    pcap_index_free(&index);
     
     if (result != 0) {
         fprintf(stderr, "Parse failed with result: %d\n", result);
@@ -54,6 +269,10 @@ int main(int argc, char *argv[]) {
     printf("File size: %.2f MB\n", ctx.size / (1024.0 * 1024.0));
     printf("Parse time: %.3f seconds\n", elapsed);
     printf("Throughput: %.2f MB/s\n", throughput_mbps);
+    printf("Peak RSS: %.1f MB\n", get_peak_rss_mb());
+#if PIPELINE_STATS
+    pipeline_stats_report(stdout);
+#endif
     
     // Cleanup
     cleanup_mmap_parser(&ctx);
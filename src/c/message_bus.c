@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "message_bus.h"
+#include "pcap.h"
+#include "pipeline_stats.h"
+
+// Consumers registered for the next run
+static message_consumer_t registry[MESSAGE_BUS_MAX_CONSUMERS];
+static uint32_t registry_count;
+
+int message_bus_register(const message_consumer_t *consumer) {
+    if (registry_count == MESSAGE_BUS_MAX_CONSUMERS) {
+        fprintf(stderr, "Too many message consumers (max %d)\n", MESSAGE_BUS_MAX_CONSUMERS);
+        return -1;
+    }
+    registry[registry_count++] = *consumer;
+    return 0;
+}
+
+void message_bus_reset(void) {
+    registry_count = 0;
+}
+
+static inline symbol_id_t *batch_ids(message_pipeline_t *pipeline, const message_batch_t *batch) {
+    return &pipeline->ids[(size_t)batch_pool_index(&pipeline->pool, batch) * MAX_MESSAGES_PER_CHUNK];
+}
+
+// Display sample trading data from the first batches carrying trades
+static void show_trade_samples(message_pipeline_t *pipeline, const message_batch_t *batch) {
+    if (pipeline->samples_shown >= 2) return;
+
+    int trade_samples = 0;
+    for (uint32_t i = 0; i < batch->count && trade_samples < 5; i++) {
+        const parsed_message_t *msg = &batch->messages[i];
+        if (msg->message_type != IEX_TRADE_REPORT) continue;
+
+        if (trade_samples == 0) {
+            pipeline->samples_shown++;
+            PARSER_LOG("\n=== Sample Trading Data %d ===\n", pipeline->samples_shown);
+            PARSER_LOG("TRADES:\n");
+        }
+
+        char ticker[9], price[IEX_PRICE_TEXT_MAX];
+        memcpy(ticker, &msg->symbol_hash, 8);
+        ticker[8] = '\0';
+        PARSER_LOG("  %-8s  $%10s  %10u shares\n", ticker, iex_price_text(msg->price, price), msg->size);
+        trade_samples++;
+    }
+    if (trade_samples > 0) {
+        PARSER_LOG("  (%d trade samples shown)\n", trade_samples);
+    }
+}
+
+static void *dispatcher_thread(void *arg) {
+    message_pipeline_t *pipeline = (message_pipeline_t *)arg;
+    message_batch_t *batch;
+
+    while ((batch = batch_pool_next(&pipeline->pool)) != NULL) {
+        show_trade_samples(pipeline, batch);
+        PARSER_LOG("Processed %llu packets, %u messages in chunk\n",
+                   (unsigned long long)batch->packets, batch->count);
+
+        // Resolve symbols to dense IDs once; consumers index flat arrays by them
+        STAGE_CLOCK(clock);
+        STAGE_START(clock);
+        symbol_id_t *ids = batch_ids(pipeline, batch);
+        symbol_table_intern_batch(&pipeline->symbols, batch->messages, batch->count, ids);
+        for (uint32_t i = 0; i < batch->count; i++) {
+            if (ids[i] != SYMBOL_ID_INVALID) pipeline->message_counts[ids[i]]++;
+        }
+
+        if (pipeline->lane_count == 0) {
+            STAGE_LAP(clock, PIPELINE_STAGE_DISPATCH);
+            batch_pool_release(&pipeline->pool, batch);
+            continue;
+        }
+
+        atomic_store_explicit(&pipeline->readers[batch_pool_index(&pipeline->pool, batch)],
+                              pipeline->lane_count, memory_order_relaxed);
+        for (uint32_t c = 0; c < pipeline->lane_count; c++) {
+            // Lanes hold every pooled batch, so this only waits on a stalled consumer
+            unsigned spins = 0;
+            while (spsc_ring_push(&pipeline->lanes[c].ring, batch) != 0) {
+                ring_backoff(&spins);
+            }
+        }
+        STAGE_LAP(clock, PIPELINE_STAGE_DISPATCH);
+    }
+
+    for (uint32_t c = 0; c < pipeline->lane_count; c++) {
+        spsc_ring_close(&pipeline->lanes[c].ring);
+    }
+    return NULL;
+}
+
+static void *consumer_thread(void *arg) {
+    consumer_lane_t *lane = (consumer_lane_t *)arg;
+    message_pipeline_t *pipeline = lane->pipeline;
+    message_batch_t *batch;
+
+    while ((batch = spsc_ring_pop_wait(&lane->ring)) != NULL) {
+        STAGE_CLOCK(clock);
+        STAGE_START(clock);
+        lane->consumer.consume(lane->consumer.state, batch, batch_ids(pipeline, batch));
+        STAGE_LAP(clock, PIPELINE_STAGE_CONSUMER);
+
+        // Last reader hands the batch back to the decoder
+        uint32_t index = batch_pool_index(&pipeline->pool, batch);
+        if (atomic_fetch_sub_explicit(&pipeline->readers[index], 1, memory_order_acq_rel) == 1) {
+            batch_pool_release(&pipeline->pool, batch);
+        }
+    }
+
+    return NULL;
+}
+
+static void release_pipeline(message_pipeline_t *pipeline) {
+    for (uint32_t c = 0; c < pipeline->lane_count; c++) {
+        spsc_ring_free(&pipeline->lanes[c].ring);
+    }
+    free(pipeline->readers);
+    free(pipeline->ids);
+    free(pipeline->message_counts);
+    symbol_table_free(&pipeline->symbols);
+    batch_pool_destroy(&pipeline->pool);
+}
+
+// Stop and join the first started lanes after a failed start
+static void abandon_lanes(message_pipeline_t *pipeline, uint32_t started) {
+    for (uint32_t c = 0; c < started; c++) {
+        spsc_ring_close(&pipeline->lanes[c].ring);
+        pthread_join(pipeline->lanes[c].thread, NULL);
+    }
+}
+
+int start_message_delivery(message_pipeline_t *pipeline, uint32_t batch_count) {
+    memset(pipeline, 0, sizeof(*pipeline));
+
+    if (batch_pool_init(&pipeline->pool, batch_count) != 0 ||
+        symbol_table_init(&pipeline->symbols, SYMBOL_TABLE_MAX) != 0) {
+        release_pipeline(pipeline);
+        return -1;
+    }
+
+    pipeline->message_counts = calloc(pipeline->symbols.max_symbols, sizeof(uint64_t));
+    pipeline->ids = malloc((size_t)batch_count * MAX_MESSAGES_PER_CHUNK * sizeof(symbol_id_t));
+    pipeline->readers = calloc(batch_count, sizeof(atomic_uint));
+    if (!pipeline->message_counts || !pipeline->ids || !pipeline->readers) {
+        fprintf(stderr, "Failed to allocate delivery state\n");
+        release_pipeline(pipeline);
+        return -1;
+    }
+
+    for (uint32_t c = 0; c < registry_count; c++) {
+        consumer_lane_t *lane = &pipeline->lanes[c];
+        lane->pipeline = pipeline;
+        lane->consumer = registry[c];
+        if (spsc_ring_init(&lane->ring, batch_count) != 0) {
+            release_pipeline(pipeline);
+            return -1;
+        }
+        pipeline->lane_count++;
+    }
+
+    uint32_t started = 0;
+    for (; started < pipeline->lane_count; started++) {
+        if (pthread_create(&pipeline->lanes[started].thread, NULL, consumer_thread,
+                           &pipeline->lanes[started]) != 0) {
+            break;
+        }
+    }
+    if (started < pipeline->lane_count ||
+        pthread_create(&pipeline->dispatcher, NULL, dispatcher_thread, pipeline) != 0) {
+        perror("pthread_create");
+        abandon_lanes(pipeline, started);
+        release_pipeline(pipeline);
+        return -1;
+    }
+
+    return 0;
+}
+
+void drain_message_delivery(message_pipeline_t *pipeline) {
+    batch_pool_close(&pipeline->pool);
+    pthread_join(pipeline->dispatcher, NULL);
+    for (uint32_t c = 0; c < pipeline->lane_count; c++) {
+        pthread_join(pipeline->lanes[c].thread, NULL);
+    }
+}
+
+void finish_message_delivery(message_pipeline_t *pipeline) {
+    message_bus_summary_t summary = {
+        .symbols = &pipeline->symbols,
+        .message_counts = pipeline->message_counts,
+        .busiest = SYMBOL_ID_INVALID,
+    };
+
+    if (pipeline->symbols.count > 0) {
+        symbol_id_t busiest = 0;
+        for (uint32_t id = 1; id < pipeline->symbols.count; id++) {
+            if (pipeline->message_counts[id] > pipeline->message_counts[busiest]) {
+                busiest = (symbol_id_t)id;
+            }
+        }
+
+        char name[9];
+        symbol_table_name(&pipeline->symbols, busiest, name);
+        PARSER_LOG("Distinct symbols: %u (busiest: %s, %llu messages)\n", pipeline->symbols.count,
+                   name, (unsigned long long)pipeline->message_counts[busiest]);
+        summary.busiest = busiest;
+    }
+
+    for (uint32_t c = 0; c < pipeline->lane_count; c++) {
+        const message_consumer_t *consumer = &pipeline->lanes[c].consumer;
+        if (consumer->finish) consumer->finish(consumer->state, &summary);
+    }
+
+    // Consumer state went with its report; the next run registers afresh
+    message_bus_reset();
+    release_pipeline(pipeline);
+}
@@ -0,0 +1,57 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "message_ring.h"
+
+static size_t ring_capacity(size_t min_capacity) {
+    size_t capacity = 2;
+    while (capacity < min_capacity) capacity <<= 1;
+    return capacity;
+}
+
+int spsc_ring_init(spsc_ring_t *ring, size_t min_capacity) {
+    memset(ring, 0, sizeof(*ring));
+
+    size_t capacity = ring_capacity(min_capacity);
+    ring->slots = calloc(capacity, sizeof(message_batch_t *));
+    if (!ring->slots) {
+        fprintf(stderr, "Failed to allocate message ring\n");
+        return -1;
+    }
+
+    ring->mask = capacity - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->closed, 0);
+    return 0;
+}
+
+void spsc_ring_free(spsc_ring_t *ring) {
+    free(ring->slots);
+    ring->slots = NULL;
+}
+
+int mpsc_ring_init(mpsc_ring_t *ring, size_t min_capacity) {
+    memset(ring, 0, sizeof(*ring));
+
+    size_t capacity = ring_capacity(min_capacity);
+    ring->cells = malloc(capacity * sizeof(mpsc_cell_t));
+    if (!ring->cells) {
+        fprintf(stderr, "Failed to allocate message ring\n");
+        return -1;
+    }
+
+    // Cell i is free for the producer that claims position i
+    for (size_t i = 0; i < capacity; i++) {
+        atomic_init(&ring->cells[i].sequence, i);
+        ring->cells[i].batch = NULL;
+    }
+    ring->mask = capacity - 1;
+    atomic_init(&ring->tail, 0);
+    return 0;
+}
+
+void mpsc_ring_free(mpsc_ring_t *ring) {
+    free(ring->cells);
+    ring->cells = NULL;
+}
@@ -5,8 +5,34 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
+#include <string.h>
 #include "pcap.h"
 #include "iex.h"
+#include "iex_tp.h"
+#include "cpu_dispatch.h"
+#include "pipeline_stats.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+int parser_verbose = 1;
+
+// Selected message-type filter set; its decoder is taken from cpu_kernels
+// at each call so a later --force-isa still applies
+static int segment_filter = IEX_FILTER_INDEX_all;
+
+int pcap_set_message_filter(const char *filter) {
+    int index = iex_tp_filter_index(filter);
+    if (index < 0) {
+        fprintf(stderr, "Unknown message filter: %s\n", filter);
+        return -1;
+    }
+    segment_filter = index;
+    return 0;
+}
 
 int init_mmap_parser(const char *filename, mmap_context_t *ctx) {
     struct stat st;
@@ -34,13 +60,52 @@ int init_mmap_parser(const char *filename, mmap_context_t *ctx) {
         return -1;
     }
     
-    // Advise sequential access
-    madvise(ctx->data, ctx->size, MADV_SEQUENTIAL | MADV_WILLNEED);
+    // Advise sequential access; readahead is requested window by window
+    // as the parse advances rather than for the whole file up front
+    madvise(ctx->data, ctx->size, MADV_SEQUENTIAL);
     
     ctx->offset = 0;
+    ctx->window_size = 0;
+    ctx->released_to = 0;
+    ctx->prefetched_to = 0;
     return 0;
 }
 
+void mmap_release_behind(mmap_context_t *ctx, size_t cursor) {
+    if (ctx->window_size == 0) return;
+    
+    // Keep one window behind as well so a block straddling the cursor stays mapped
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t release_to = cursor > ctx->window_size ? (cursor - ctx->window_size) & ~(page - 1) : 0;
+    if (release_to <= ctx->released_to) return;
+    
+    size_t len = release_to - ctx->released_to;
+    madvise((uint8_t *)ctx->data + ctx->released_to, len, MADV_DONTNEED);
+#ifdef POSIX_FADV_DONTNEED
+    posix_fadvise(ctx->fd, (off_t)ctx->released_to, (off_t)len, POSIX_FADV_DONTNEED);
+#endif
+    ctx->released_to = release_to;
+}
+
+void mmap_window_advance(mmap_context_t *ctx, size_t cursor) {
+    mmap_release_behind(ctx, cursor);
+    
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t ahead = ctx->window_size ? ctx->window_size : MMAP_DEFAULT_PREFETCH;
+    size_t target = cursor + ahead < ctx->size ? cursor + ahead : ctx->size;
+    
+    // Top up only once less than half a window is left, to keep syscalls rare
+    if (ctx->prefetched_to >= target ||
+        (target < ctx->size && ctx->prefetched_to >= cursor + ahead / 2)) return;
+    
+    size_t from = ctx->prefetched_to > cursor ? ctx->prefetched_to : cursor;
+    from &= ~(page - 1);
+    if (target > from) {
+        madvise((uint8_t *)ctx->data + from, target - from, MADV_WILLNEED);
+    }
+    ctx->prefetched_to = target;
+}
+
 void cleanup_mmap_parser(mmap_context_t *ctx) {
     if (ctx->data != MAP_FAILED) {
         munmap(ctx->data, ctx->size);
@@ -50,7 +115,9 @@ void cleanup_mmap_parser(mmap_context_t *ctx) {
     }
 }
 
-int parse_pcap_file(mmap_context_t *ctx) {
+// Validate the file header and locate the first packet/block
+// Returns 0 and sets *start/*remaining on success, -1 on a malformed file.
+int locate_first_block(mmap_context_t *ctx, uint8_t **start, size_t *remaining) {
     uint32_t *magic = (uint32_t *)ctx->data;
     
     // Validate PCAP/PCAPNG header
@@ -59,176 +126,301 @@ int parse_pcap_file(mmap_context_t *ctx) {
         return -1;
     }
     
-    printf("PCAP file size: %zu bytes\n", ctx->size);
-    
-    uint8_t *data_ptr;
-    size_t remaining;
+    PARSER_LOG("PCAP file size: %zu bytes\n", ctx->size);
     
     if (*magic == PCAPNG_MAGIC) {
-        printf("Detected PCAPNG format\n");
-        data_ptr = (uint8_t *)ctx->data;
-        remaining = ctx->size;
+        PARSER_LOG("Detected PCAPNG format\n");
         
         // Read Section Header Block length safely
-        if (remaining < 12) {
+        if (ctx->size < 12) {
             fprintf(stderr, "File too small for pcapng header\n");
             return -1;
         }
         
-        uint32_t block_len = *((uint32_t *)(data_ptr + 4));
-        printf("Section Header Block length: %u bytes\n", block_len);
+        uint32_t block_len = *((uint32_t *)((uint8_t *)ctx->data + 4));
+        PARSER_LOG("Section Header Block length: %u bytes\n", block_len);
         
-        if (block_len > remaining || block_len < 28) {
+        if (block_len > ctx->size || block_len < 28) {
             fprintf(stderr, "Invalid SHB length: %u\n", block_len);
             return -1;
         }
         
-        data_ptr += block_len;
-        remaining -= block_len;
+        *start = (uint8_t *)ctx->data + block_len;
+        *remaining = ctx->size - block_len;
+        
+        // Resume from a block positioned by the packet index
+        if (ctx->offset > block_len && ctx->offset < ctx->size) {
+            PARSER_LOG("Starting at file offset %zu\n", ctx->offset);
+            *start = (uint8_t *)ctx->data + ctx->offset;
+            *remaining = ctx->size - ctx->offset;
+        }
     } else {
-        printf("Detected classic PCAP format\n");
+        PARSER_LOG("Detected classic PCAP format\n");
         pcap_header_t *header = (pcap_header_t *)ctx->data;
-        printf("Network type: %u\n", header->network);
-        data_ptr = (uint8_t *)ctx->data + sizeof(pcap_header_t);
-        remaining = ctx->size - sizeof(pcap_header_t);
+        PARSER_LOG("Network type: %u\n", header->network);
+        *start = (uint8_t *)ctx->data + sizeof(pcap_header_t);
+        *remaining = ctx->size - sizeof(pcap_header_t);
     }
     
-    message_batch_t batch = {0};
-    uint64_t total_packets = 0;
-    uint64_t total_messages = 0;
+    return 0;
+}
+
+// Block types that may legitimately follow an EPB inside a section
+static int is_known_block_type(uint32_t block_type) {
+    switch (block_type) {
+        case PCAPNG_EPB_TYPE:
+        case PCAPNG_IDB_TYPE:
+        case PCAPNG_SPB_TYPE:
+        case PCAPNG_NRB_TYPE:
+        case PCAPNG_ISB_TYPE:
+        case PCAPNG_DSB_TYPE:
+        case PCAPNG_MAGIC:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// Leading and trailing length agree and the block fits before end
+static int is_framed_block(const uint8_t *ptr, const uint8_t *end) {
+    if (end - ptr < 12) return 0;
     
-    // Process in chunks for better cache performance
-    while (remaining > 16) {  // Need at least 16 bytes for any packet
-        size_t chunk_size = (remaining > PCAP_CHUNK_SIZE) ? PCAP_CHUNK_SIZE : remaining;
+    uint32_t block_len = *((const uint32_t *)(ptr + 4));
+    if (block_len < 12 || (block_len & 3) != 0 || block_len > (size_t)(end - ptr)) return 0;
+    
+    return *((const uint32_t *)(ptr + block_len - 4)) == block_len;
+}
+
+// EPB candidate scan: first aligned word equal to value, one vector of
+// words per compare
+static const uint8_t *find_word_scalar(const uint8_t *from, const uint8_t *end, uint32_t value) {
+    for (; from + 4 <= end; from += 4) {
+        uint32_t word;
+        memcpy(&word, from, 4);
+        if (word == value) return from;
+    }
+    return end;
+}
+
+#if defined(__x86_64__)
+CPU_TARGET_SSE42
+static const uint8_t *find_word_sse42(const uint8_t *from, const uint8_t *end, uint32_t value) {
+    const __m128i needle = _mm_set1_epi32((int)value);
+    for (; from + 16 <= end; from += 16) {
+        int hits = _mm_movemask_ps(_mm_castsi128_ps(
+            _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)from), needle)));
+        if (hits) return from + 4 * __builtin_ctz(hits);
+    }
+    return find_word_scalar(from, end, value);
+}
+
+CPU_TARGET_AVX2
+static const uint8_t *find_word_avx2(const uint8_t *from, const uint8_t *end, uint32_t value) {
+    const __m256i needle = _mm256_set1_epi32((int)value);
+    for (; from + 32 <= end; from += 32) {
+        int hits = _mm256_movemask_ps(_mm256_castsi256_ps(
+            _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)from), needle)));
+        if (hits) return from + 4 * __builtin_ctz(hits);
+    }
+    return find_word_scalar(from, end, value);
+}
+
+CPU_TARGET_AVX512
+static const uint8_t *find_word_avx512(const uint8_t *from, const uint8_t *end, uint32_t value) {
+    const __m512i needle = _mm512_set1_epi32((int)value);
+    for (; from + 64 <= end; from += 64) {
+        __mmask16 hits = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(from), needle);
+        if (hits) return from + 4 * __builtin_ctz(hits);
+    }
+    return find_word_scalar(from, end, value);
+}
+#elif defined(__aarch64__)
+static const uint8_t *find_word_neon(const uint8_t *from, const uint8_t *end, uint32_t value) {
+    const uint32x4_t needle = vdupq_n_u32(value);
+    for (; from + 16 <= end; from += 16) {
+        uint32x4_t hits = vceqq_u32(vld1q_u32((const uint32_t *)from), needle);
+        if (vmaxvq_u32(hits)) break;
+    }
+    return find_word_scalar(from, end, value);
+}
+#endif
+
+void pcapng_kernels_resolve(cpu_isa_t isa, cpu_kernels_t *kernels) {
+    kernels->find_word = find_word_scalar;
+#if defined(__x86_64__)
+    if (isa == CPU_ISA_SSE42) kernels->find_word = find_word_sse42;
+    if (isa == CPU_ISA_AVX2) kernels->find_word = find_word_avx2;
+    if (isa == CPU_ISA_AVX512) kernels->find_word = find_word_avx512;
+#elif defined(__aarch64__)
+    if (isa == CPU_ISA_NEON) kernels->find_word = find_word_neon;
+#endif
+}
+
+const uint8_t *pcapng_resync(const uint8_t *base, const uint8_t *from, const uint8_t *end) {
+    // Blocks are 32-bit aligned relative to the start of the file
+    size_t misalign = (size_t)(from - base) & 3;
+    const uint8_t *ptr = misalign ? from + (4 - misalign) : from;
+    if (end - ptr < (ptrdiff_t)(sizeof(pcapng_epb_t) + 4)) return end;
+    const uint8_t *last = end - sizeof(pcapng_epb_t) - 4;    // last candidate
+    
+    for (; (ptr = cpu_kernels.find_word(ptr, last + 4, PCAPNG_EPB_TYPE)) <= last; ptr += 4) {
+        const pcapng_epb_t *epb = (const pcapng_epb_t *)ptr;
+        if (!is_framed_block(ptr, end)) continue;
         
-        // Reset batch for this chunk
-        batch.count = 0;
+        // Captured bytes (padded to 32 bits) must fit inside the block
+        size_t padded = ((size_t)epb->captured_len + 3) & ~(size_t)3;
+        if (epb->captured_len > epb->packet_len ||
+            sizeof(pcapng_epb_t) + padded + 4 > epb->block_length) continue;
         
-        printf("Processing chunk: %zu bytes, remaining: %zu\n", chunk_size, remaining);
+        // Chain forward: the following blocks must frame up as well
+        const uint8_t *next = ptr + epb->block_length;
+        int confirmed = 1;
+        for (int depth = 0; depth < PCAPNG_RESYNC_DEPTH && next < end; depth++) {
+            if (!is_framed_block(next, end) || !is_known_block_type(*((const uint32_t *)next))) {
+                confirmed = 0;
+                break;
+            }
+            next += *((const uint32_t *)(next + 4));
+        }
         
-        // For pcapng, we need different parsing logic
-        if (*magic == PCAPNG_MAGIC) {
-            // Parse pcapng blocks
-            uint8_t *chunk_end = data_ptr + chunk_size;
-            uint64_t packets_in_chunk = 0;
+        if (confirmed) return ptr;
+    }
+    
+    return end;
+}
+
+const uint8_t *decode_pcapng_blocks(const uint8_t *data, const uint8_t *stop, const uint8_t *limit,
+                                    message_batch_t *batch, uint64_t *packets) {
+    while (data < stop && data + 8 <= limit) {
+        STAGE_CLOCK(clock);
+        STAGE_SAMPLE(clock);
+        uint32_t block_type = *((const uint32_t *)data);
+        uint32_t block_len = *((const uint32_t *)(data + 4));
+        
+        if (block_len < 12 || block_len > (size_t)(limit - data)) {
+            break; // Invalid or incomplete block
+        }
+        
+        if (block_type == PCAPNG_EPB_TYPE && block_len >= sizeof(pcapng_epb_t)) {
+            // Enhanced Packet Block - contains actual network data
+            const pcapng_epb_t *epb = (const pcapng_epb_t *)data;
+            const uint8_t *packet_data = data + sizeof(pcapng_epb_t);
             
-            while (data_ptr + 8 <= chunk_end) {
-                uint32_t block_type = *((uint32_t *)data_ptr);
-                uint32_t block_len = *((uint32_t *)(data_ptr + 4));
-                
-                if (block_len < 12 || data_ptr + block_len > chunk_end) {
-                    break; // Invalid or incomplete block
-                }
+            if (epb->captured_len > 0 && epb->captured_len <= block_len - sizeof(pcapng_epb_t)) {
+                STAGE_LAP(clock, PIPELINE_STAGE_BLOCK_WALK);
+                size_t payload_len;
+                const uint8_t *payload = iex_udp_payload(packet_data, epb->captured_len, &payload_len);
                 
-                if (block_type == PCAPNG_EPB_TYPE) {
-                    // Enhanced Packet Block - contains actual network data
-                    if (block_len >= sizeof(pcapng_epb_t)) {
-                        pcapng_epb_t *epb = (pcapng_epb_t *)data_ptr;
-                        uint8_t *packet_data = data_ptr + sizeof(pcapng_epb_t);
-                        
-                        // Call IEX parser on the packet data
-                        if (epb->captured_len > 0 && epb->captured_len < 65536) {
-                            // Process all packets for IEX messages
-                            uint32_t msg_count = extract_iex_messages_asm(packet_data, epb->captured_len, &batch);
-                            batch.count += msg_count;  // Update count in C code
-                            
-                            // Display sample trading data from large packets
-                            static int trading_samples_shown = 0;
-                            if (epb->captured_len > 1000 && trading_samples_shown < 2) {
-                                trading_samples_shown++;
-                                
-                                printf("\n=== Sample Trading Data from Packet %d ===\n", trading_samples_shown);
-                                
-                                const uint8_t *udp_payload = packet_data + 42;
-                                size_t payload_len = epb->captured_len - 42;
-                                
-                                int trade_samples = 0;
-                                printf("TRADES:\n");
-                                
-                                // Look for trade messages (0x54)
-                                for (size_t i = 0; i < payload_len - 30 && trade_samples < 5; i++) {
-                                    if (udp_payload[i] == 0x54) {
-                                        // Find symbol after the 0x54 marker
-                                        for (int offset = 1; offset <= 5; offset++) {
-                                            if (i + offset + 15 < payload_len) {
-                                                const uint8_t *symbol_area = &udp_payload[i + offset];
-                                                if (symbol_area[0] >= 'A' && symbol_area[0] <= 'Z') {
-                                                    // Extract symbol
-                                                    char ticker[16] = {0};
-                                                    int len = 0;
-                                                    for (int j = 0; j < 8; j++) {
-                                                        if (symbol_area[j] >= 'A' && symbol_area[j] <= 'Z') {
-                                                            ticker[len++] = symbol_area[j];
-                                                        } else if (symbol_area[j] >= '0' && symbol_area[j] <= '9') {
-                                                            ticker[len++] = symbol_area[j];
-                                                        } else if (symbol_area[j] == '+' || symbol_area[j] == '-') {
-                                                            ticker[len++] = symbol_area[j];
-                                                        } else break;
-                                                    }
-                                                    
-                                                    if (len > 0) {
-                                                        // Extract price and size
-                                                        uint32_t price_raw = *(uint32_t*)(symbol_area + 8);
-                                                        uint32_t size = *(uint32_t*)(symbol_area + 12);
-                                                        double price = (double)price_raw / 100.0; // Adjusted scaling
-                                                        
-                                                        if (price > 0.01 && price < 1000.0) {
-                                                            printf("  %-8s  $%8.2f  %10u shares\n", ticker, price, size);
-                                                            trade_samples++;
-                                                            break;
-                                                        }
-                                                    }
-                                                }
-                                            }
-                                        }
-                                    }
-                                }
-                                printf("  (%d trade samples shown)\n", trade_samples);
-                            }
-                            packets_in_chunk++;
-                        }
-                    }
+                if (payload) {
+                    // Leave the packet for the next batch rather than truncating it
+                    uint32_t announced = iex_tp_message_count(payload, payload_len);
+                    if (batch->count + announced > MAX_MESSAGES_PER_CHUNK) break;
+                    STAGE_LAP(clock, PIPELINE_STAGE_FRAMING);
+                    
+                    batch->count += cpu_kernels.decode_segment[segment_filter](
+                        payload, payload_len, &batch->messages[batch->count], announced);
+                    STAGE_LAP(clock, PIPELINE_STAGE_DECODE);
                 }
-                
-                data_ptr += block_len;
-                remaining -= block_len;
+                (*packets)++;
             }
-            
-            total_packets += packets_in_chunk;
-            total_messages += batch.count;
-            printf("Processed %llu packets, %u messages in chunk\n", packets_in_chunk, batch.count);
-            
-            // Continue to next chunk
-            if (remaining <= 16) break;
-            continue;
-        } else {
-            // Parse chunk with assembly optimizations  
-            parse_pcap_chunk_asm(data_ptr, chunk_size, &batch);
-            total_packets += 1;  // placeholder
         }
         
-        // This line is handled separately for pcapng above
+        data += block_len;
+    }
+    
+    return data;
+}
+
+const uint8_t *decode_pcap_records(const uint8_t *data, const uint8_t *stop, const uint8_t *limit,
+                                   message_batch_t *batch, uint64_t *packets) {
+    while (data < stop && (size_t)(limit - data) >= sizeof(pcap_record_header_t)) {
+        STAGE_CLOCK(clock);
+        STAGE_SAMPLE(clock);
+        const pcap_record_header_t *record = (const pcap_record_header_t *)data;
+        const uint8_t *packet_data = data + sizeof(pcap_record_header_t);
         
-        // Process parsed messages (write to file, send to trading system, etc.)
-        for (uint32_t i = 0; i < batch.count; i++) {
-            parsed_message_t *msg = &batch.messages[i];
+        if (record->caplen > MAX_PACKET_SIZE ||
+            record->caplen > (size_t)(limit - packet_data)) {
+            break; // Invalid or incomplete record
+        }
+        STAGE_LAP(clock, PIPELINE_STAGE_BLOCK_WALK);
+        
+        size_t payload_len;
+        const uint8_t *payload = iex_udp_payload(packet_data, record->caplen, &payload_len);
+        
+        if (payload) {
+            // Leave the packet for the next batch rather than overflowing this one
+            uint32_t announced = iex_tp_message_count(payload, payload_len);
+            if (batch->count + announced > MAX_MESSAGES_PER_CHUNK) break;
+            STAGE_LAP(clock, PIPELINE_STAGE_FRAMING);
             
-            // Example: print high-value trades
-            if (msg->message_type == IEX_TRADE_REPORT && msg->price > 10000) {
-                printf("High-value trade: symbol_hash=%llx, price=%u, size=%u, side=%c\n",
-                       msg->symbol_hash, msg->price, msg->size, msg->side);
-            }
+            batch->count += cpu_kernels.decode_segment[segment_filter](
+                payload, payload_len, &batch->messages[batch->count], announced);
+            STAGE_LAP(clock, PIPELINE_STAGE_DECODE);
         }
+        (*packets)++;
+        
+        data = packet_data + record->caplen;
+    }
+    
+    return data;
+}
+
+int parse_pcap_file(mmap_context_t *ctx) {
+    uint32_t *magic = (uint32_t *)ctx->data;
+    uint8_t *data_ptr;
+    size_t remaining;
+    
+    if (locate_first_block(ctx, &data_ptr, &remaining) != 0) {
+        return -1;
+    }
+    
+    message_pipeline_t pipeline;
+    if (start_message_delivery(&pipeline, BATCH_POOL_DEPTH) != 0) {
+        return -1;
+    }
+    
+    int is_pcapng = (*magic == PCAPNG_MAGIC);
+    uint64_t total_packets = 0;
+    uint64_t total_messages = 0;
+    int result = 0;
+    
+    mmap_window_advance(ctx, (size_t)(data_ptr - (uint8_t *)ctx->data));
+    
+    // Process in chunks for better cache performance
+    while (remaining > 16) {  // Need at least 16 bytes for any packet
+        size_t chunk_size = (remaining > PCAP_CHUNK_SIZE) ? PCAP_CHUNK_SIZE : remaining;
+        
+        PARSER_LOG("Processing chunk: %zu bytes, remaining: %zu\n", chunk_size, remaining);
         
-        data_ptr += chunk_size;
-        remaining -= chunk_size;
+        // Blocks here while the delivery thread is behind
+        message_batch_t *batch = batch_pool_acquire(&pipeline.pool);
+        const uint8_t *next = is_pcapng
+            ? decode_pcapng_blocks(data_ptr, data_ptr + chunk_size, data_ptr + remaining,
+                                   batch, &batch->packets)
+            : decode_pcap_records(data_ptr, data_ptr + chunk_size, data_ptr + remaining,
+                                  batch, &batch->packets);
         
-        // Progress update for large files
-        if (total_packets % 1000000 == 0) {
-            printf("Processed %llu packets, %llu messages\n", total_packets, total_messages);
+        if (next == data_ptr) {
+            fprintf(stderr, "Invalid or truncated block at offset %zu\n",
+                    (size_t)(data_ptr - (uint8_t *)ctx->data));
+            batch_pool_release(&pipeline.pool, batch);
+            result = -1;
+            break;
         }
+        
+        remaining -= next - data_ptr;
+        data_ptr = (uint8_t *)next;
+        mmap_window_advance(ctx, (size_t)(data_ptr - (uint8_t *)ctx->data));
+        
+        total_packets += batch->packets;
+        total_messages += batch->count;
+        batch_pool_submit(&pipeline.pool, batch);
     }
     
-    printf("Final stats: %llu packets, %llu messages parsed\n", total_packets, total_messages);
-    return 0;
-}
\ No newline at end of file
+    drain_message_delivery(&pipeline);
+    PARSER_LOG("Final stats: %llu packets, %llu messages parsed\n",
+               (unsigned long long)total_packets, (unsigned long long)total_messages);
+    finish_message_delivery(&pipeline);
+    return result;
+}
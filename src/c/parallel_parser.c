@@ -0,0 +1,274 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "pcap.h"
+#include "iex.h"
+
+// Parallel pcapng parsing
+// The mapped file is cut into fixed PCAP_CHUNK_SIZE byte ranges. Each worker
+// resynchronizes on its own: it scans forward from the nominal range start
+// for a well-framed EPB (pcapng_resync), does the same for the next range's
+// start, and decodes the blocks in between. No serial pre-pass over the file
+// is needed, so start-up cost does not grow with file size.
+//
+// The calling thread drains results strictly in partition order and keeps
+// the true block cursor. A partition is accepted only if its speculative
+// start equals the cursor left by its predecessor; otherwise (a false resync,
+// which the chain check makes very unlikely) the worker's batch is dropped
+// and the range is re-decoded in order from the true cursor.
+//
+// Batches come from the delivery pool, which has a single acquiring thread:
+// the consumer. It gives every slot a batch up front and, after submitting
+// an accepted one, a fresh batch before the slot is handed out again. A
+// rejected batch simply stays with its slot.
+
+#define REORDER_SLOTS_PER_THREAD 2
+
+typedef struct {
+    message_batch_t *batch;     // filled by the worker, submitted by the consumer
+    const uint8_t *start;       // speculative first block of the partition
+    const uint8_t *end;         // speculative first block of the next partition
+    const uint8_t *resume;      // first block not decoded by the worker
+    size_t partition;
+    int ready;
+} reorder_slot_t;
+
+typedef struct {
+    const uint8_t *base;        // start of the mapping (alignment reference)
+    const uint8_t *first;       // first block after the SHB
+    const uint8_t *limit;       // end of the mapping
+    batch_pool_t *pool;
+    size_t partition_count;
+    reorder_slot_t *slots;
+    size_t slot_count;
+    size_t next_partition;      // next partition to hand to a worker
+    size_t next_delivery;       // next partition the consumer will drain
+    int aborted;
+    pthread_mutex_t lock;
+    pthread_cond_t slot_free;
+    pthread_cond_t slot_ready;
+} parallel_ctx_t;
+
+// Speculative start of partition idx
+static const uint8_t *partition_start(const parallel_ctx_t *pc, size_t idx) {
+    if (idx == 0) return pc->first;
+    if (idx >= pc->partition_count) return pc->limit;
+
+    const uint8_t *nominal = pc->first + idx * (size_t)PCAP_CHUNK_SIZE;
+    return pcapng_resync(pc->base, nominal, pc->limit);
+}
+
+static void *partition_worker(void *arg) {
+    parallel_ctx_t *pc = (parallel_ctx_t *)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&pc->lock);
+        if (pc->next_partition >= pc->partition_count) {
+            pthread_mutex_unlock(&pc->lock);
+            break;
+        }
+
+        size_t idx = pc->next_partition++;
+        reorder_slot_t *slot = &pc->slots[idx % pc->slot_count];
+
+        // The slot is ours once partition idx - slot_count has been drained;
+        // testing the slot itself would race with a faster worker a lap ahead
+        while (!pc->aborted && idx >= pc->next_delivery + pc->slot_count) {
+            pthread_cond_wait(&pc->slot_free, &pc->lock);
+        }
+        if (pc->aborted) {
+            pthread_mutex_unlock(&pc->lock);
+            break;
+        }
+        slot->ready = 0;
+        slot->partition = idx;
+        pthread_mutex_unlock(&pc->lock);
+
+        slot->start = partition_start(pc, idx);
+        slot->end = partition_start(pc, idx + 1);
+        slot->batch->count = 0;
+        slot->batch->packets = 0;
+        slot->resume = decode_pcapng_blocks(slot->start, slot->end, pc->limit,
+                                            slot->batch, &slot->batch->packets);
+
+        pthread_mutex_lock(&pc->lock);
+        slot->ready = 1;
+        pthread_cond_broadcast(&pc->slot_ready);
+        pthread_mutex_unlock(&pc->lock);
+    }
+
+    return NULL;
+}
+
+int parse_pcap_file_parallel(mmap_context_t *ctx, int num_threads) {
+    uint8_t *data_ptr;
+    size_t remaining;
+
+    if (num_threads < 1) num_threads = 1;
+
+    if (locate_first_block(ctx, &data_ptr, &remaining) != 0) {
+        return -1;
+    }
+
+    if (*((uint32_t *)ctx->data) != PCAPNG_MAGIC) {
+        PARSER_LOG("Parallel mode requires pcapng, falling back to serial parser\n");
+        return parse_pcap_file(ctx);
+    }
+
+    parallel_ctx_t pc;
+    memset(&pc, 0, sizeof(pc));
+    pc.base = (const uint8_t *)ctx->data;
+    pc.first = data_ptr;
+    pc.limit = data_ptr + remaining;
+    pc.partition_count = (remaining + PCAP_CHUNK_SIZE - 1) / PCAP_CHUNK_SIZE;
+    pc.slot_count = (size_t)num_threads * REORDER_SLOTS_PER_THREAD;
+    pc.slots = calloc(pc.slot_count, sizeof(reorder_slot_t));
+    pthread_mutex_init(&pc.lock, NULL);
+    pthread_cond_init(&pc.slot_free, NULL);
+    pthread_cond_init(&pc.slot_ready, NULL);
+
+    PARSER_LOG("Parallel decode: %d threads, %zu partitions\n", num_threads, pc.partition_count);
+
+    int result = 0;
+    pthread_t *threads = calloc((size_t)num_threads, sizeof(pthread_t));
+    int started = 0;
+    int delivering = 0;
+    message_pipeline_t pipeline;
+
+    if (!pc.slots || !threads) {
+        fprintf(stderr, "Failed to allocate worker state\n");
+        result = -1;
+        goto cleanup;
+    }
+
+    // One batch per reorder slot plus the delivery thread's backlog
+    if (start_message_delivery(&pipeline, (uint32_t)pc.slot_count + BATCH_POOL_DEPTH) != 0) {
+        result = -1;
+        goto cleanup;
+    }
+    delivering = 1;
+    pc.pool = &pipeline.pool;
+    for (size_t i = 0; i < pc.slot_count; i++) {
+        pc.slots[i].batch = batch_pool_acquire(pc.pool);
+    }
+
+    for (started = 0; started < num_threads; started++) {
+        if (pthread_create(&threads[started], NULL, partition_worker, &pc) != 0) {
+            perror("pthread_create");
+            break;
+        }
+    }
+    if (started == 0) {
+        result = -1;
+        goto cleanup;
+    }
+
+    uint64_t total_packets = 0;
+    uint64_t total_messages = 0;
+    size_t resynced = 0;
+    const uint8_t *cursor = pc.first;   // true position of the next block
+    
+    // Workers run up to slot_count partitions ahead of the cursor
+    if (ctx->window_size > 0 && ctx->window_size < pc.slot_count * (size_t)PCAP_CHUNK_SIZE) {
+        ctx->window_size = pc.slot_count * (size_t)PCAP_CHUNK_SIZE;
+        PARSER_LOG("Residency window raised to %zu MB to cover in-flight partitions\n",
+                   ctx->window_size >> 20);
+    }
+    mmap_window_advance(ctx, (size_t)(cursor - pc.base));
+
+    // Drain partitions strictly in capture order
+    for (size_t idx = 0; idx < pc.partition_count; idx++) {
+        reorder_slot_t *slot = &pc.slots[idx % pc.slot_count];
+
+        pthread_mutex_lock(&pc.lock);
+        while (!slot->ready || slot->partition != idx) {
+            pthread_cond_wait(&pc.slot_ready, &pc.lock);
+        }
+        pthread_mutex_unlock(&pc.lock);
+
+        if (slot->start == cursor) {
+            // Predecessor's chain landed on our speculative start: confirmed
+            if (slot->start < slot->end) {
+                total_packets += slot->batch->packets;
+                total_messages += slot->batch->count;
+                batch_pool_submit(pc.pool, slot->batch);
+                slot->batch = NULL;
+            }
+            cursor = slot->resume;
+        } else if (slot->start < slot->end || cursor < slot->end) {
+            resynced++;
+        }
+
+        // Finish the partition in order: covers a full batch and a false resync
+        while (cursor < slot->end && result == 0) {
+            message_batch_t *batch = batch_pool_acquire(pc.pool);
+            const uint8_t *next = decode_pcapng_blocks(cursor, slot->end, pc.limit,
+                                                       batch, &batch->packets);
+            if (next == cursor) {
+                fprintf(stderr, "Invalid or truncated block at offset %zu\n",
+                        (size_t)(cursor - pc.base));
+                batch_pool_release(pc.pool, batch);
+                result = -1;
+                break;
+            }
+            cursor = next;
+
+            total_packets += batch->packets;
+            total_messages += batch->count;
+            batch_pool_submit(pc.pool, batch);
+        }
+
+        mmap_window_advance(ctx, (size_t)(cursor - pc.base));
+        
+        // Refill the slot before its next partition can be claimed
+        if (!slot->batch && result == 0 && idx + pc.slot_count < pc.partition_count) {
+            slot->batch = batch_pool_acquire(pc.pool);
+        }
+        
+        pthread_mutex_lock(&pc.lock);
+        slot->ready = 0;
+        pc.next_delivery = idx + 1;
+        if (result != 0) {
+            // Stop handing out partitions so the workers can be joined
+            pc.aborted = 1;
+        }
+        pthread_cond_broadcast(&pc.slot_free);
+        pthread_mutex_unlock(&pc.lock);
+
+        if (result != 0) break;
+    }
+
+    // Workers may still be decoding into slot batches until joined
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    started = 0;
+    for (size_t i = 0; i < pc.slot_count; i++) {
+        if (pc.slots[i].batch) batch_pool_release(pc.pool, pc.slots[i].batch);
+    }
+
+    drain_message_delivery(&pipeline);
+    if (resynced > 0) {
+        PARSER_LOG("Partition boundaries re-decoded after false resync: %zu\n", resynced);
+    }
+    PARSER_LOG("Final stats: %llu packets, %llu messages parsed\n",
+               (unsigned long long)total_packets, (unsigned long long)total_messages);
+    finish_message_delivery(&pipeline);
+    delivering = 0;
+
+cleanup:
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    if (delivering) {
+        drain_message_delivery(&pipeline);
+        finish_message_delivery(&pipeline);
+    }
+    pthread_cond_destroy(&pc.slot_ready);
+    pthread_cond_destroy(&pc.slot_free);
+    pthread_mutex_destroy(&pc.lock);
+    free(pc.slots);
+    free(threads);
+    return result;
+}
@@ -0,0 +1,665 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "pcap.h"
+#include "pcap_index.h"
+#include "iex_tp.h"
+
+#define MAX_INTERFACES          16
+#define IDB_OPTIONS_OFFSET      16
+#define IDB_OPT_END             0
+#define IDB_OPT_TSRESOL         9
+#define NS_PER_DAY              86400000000000ULL
+#define SYMBOL_BITMAP_MAX_WORDS PCAP_SYMBOL_WORDS(SYMBOL_TABLE_MAX)
+
+// Capture timestamp units of one interface
+typedef struct {
+    uint8_t tsresol;            // if_tsresol; default 6 (microseconds)
+} interface_info_t;
+
+// Read if_tsresol from an Interface Description Block's options
+static uint8_t parse_idb_tsresol(const uint8_t *block, uint32_t block_len) {
+    const uint8_t *opt = block + IDB_OPTIONS_OFFSET;
+    const uint8_t *end = block + block_len - 4;
+
+    while (opt + 4 <= end) {
+        uint16_t code = iex_load_u16(opt);
+        uint16_t len = iex_load_u16(opt + 2);
+        if (code == IDB_OPT_END || opt + 4 + len > end) break;
+        if (code == IDB_OPT_TSRESOL && len >= 1) return opt[4];
+        opt += 4 + ((len + 3) & ~3);
+    }
+
+    return 6;
+}
+
+// Convert raw EPB timestamp units to nanoseconds
+static uint64_t timestamp_to_ns(uint64_t ts, uint8_t tsresol) {
+    if (tsresol & 0x80) {
+        // Negative power of two
+        uint8_t shift = tsresol & 0x7F;
+        if (shift >= 64) return 0;
+        uint64_t whole = ts >> shift;
+        uint64_t frac = ts & ((1ULL << shift) - 1);
+        return whole * 1000000000ULL + (uint64_t)(((unsigned __int128)frac * 1000000000ULL) >> shift);
+    }
+
+    uint64_t scale = 1;
+    if (tsresol <= 9) {
+        for (uint8_t i = tsresol; i < 9; i++) scale *= 10;
+        return ts * scale;
+    }
+    for (uint8_t i = 9; i < tsresol && i < 28; i++) scale *= 10;
+    return ts / scale;
+}
+
+static int append_entry(pcap_index_t *index, size_t *capacity, const pcap_index_entry_t *entry) {
+    if (index->header.entry_count == *capacity) {
+        size_t grown = *capacity ? *capacity * 2 : 4096;
+        pcap_index_entry_t *entries = realloc(index->entries, grown * sizeof(pcap_index_entry_t));
+        if (!entries) return -1;
+        index->entries = entries;
+        *capacity = grown;
+    }
+
+    index->entries[index->header.entry_count++] = *entry;
+    return 0;
+}
+
+static int append_zone(pcap_index_t *index, size_t *capacity, uint64_t start_offset) {
+    if (index->header.zone_count == *capacity) {
+        size_t grown = *capacity ? *capacity * 2 : 256;
+        pcap_zone_map_t *zones = realloc(index->zones, grown * sizeof(pcap_zone_map_t));
+        if (!zones) return -1;
+        index->zones = zones;
+        *capacity = grown;
+    }
+
+    pcap_zone_map_t *zone = &index->zones[index->header.zone_count++];
+    memset(zone, 0, sizeof(*zone));
+    zone->start_offset = start_offset;
+    zone->end_offset = start_offset;
+    zone->min_timestamp = UINT64_MAX;
+    zone->min_sequence = UINT64_MAX;
+    return 0;
+}
+
+// Symbol bitmaps of the zones walked so far, stride words per row; the
+// stride doubles as the dictionary grows and is trimmed once it is final
+typedef struct {
+    uint64_t current[SYMBOL_BITMAP_MAX_WORDS];  // zone being walked
+    size_t rows;
+    size_t capacity;            // rows
+    uint32_t stride;
+} symbol_rows_t;
+
+// Store the walked zone's bitmap as the next row
+static int append_symbol_row(pcap_index_t *index, symbol_rows_t *rows) {
+    uint32_t needed = PCAP_SYMBOL_WORDS(index->symbols.count);
+    uint32_t stride = rows->stride;
+    size_t capacity = rows->capacity;
+
+    while (stride < needed) stride = stride ? stride * 2 : 1;
+    if (rows->rows == capacity) capacity = capacity ? capacity * 2 : 256;
+
+    if (stride != rows->stride || capacity != rows->capacity) {
+        uint64_t *grown = realloc(index->symbol_bitmaps, capacity * stride * sizeof(uint64_t));
+        if (!grown) return -1;
+
+        // Spread the stored rows to the wider stride, last row first
+        if (stride != rows->stride) {
+            for (size_t r = rows->rows; r-- > 0;) {
+                memmove(grown + r * stride, grown + r * rows->stride, rows->stride * sizeof(uint64_t));
+                memset(grown + r * stride + rows->stride, 0, (stride - rows->stride) * sizeof(uint64_t));
+            }
+        }
+        index->symbol_bitmaps = grown;
+        rows->stride = stride;
+        rows->capacity = capacity;
+    }
+
+    memcpy(index->symbol_bitmaps + rows->rows * stride, rows->current, stride * sizeof(uint64_t));
+    memset(rows->current, 0, stride * sizeof(uint64_t));
+    rows->rows++;
+    return 0;
+}
+
+// Repack the rows at exactly the final dictionary's width
+static void finish_symbol_rows(pcap_index_t *index, const symbol_rows_t *rows) {
+    uint32_t words = PCAP_SYMBOL_WORDS(index->symbols.count);
+
+    for (size_t r = 0; r < rows->rows; r++) {
+        memmove(index->symbol_bitmaps + r * words, index->symbol_bitmaps + r * rows->stride,
+                words * sizeof(uint64_t));
+    }
+    index->header.symbol_count = index->symbols.count;
+    index->header.symbol_words = words;
+}
+
+// Fold every message of one segment into the chunk's zone map
+static void update_zone(pcap_zone_map_t *zone, uint64_t *zone_symbols, symbol_table_t *symbols,
+                        const uint8_t *payload, size_t payload_len) {
+    iex_tp_segment_t seg;
+    if (iex_tp_segment_init(&seg, payload, payload_len) != 0) return;
+
+    const uint8_t *msg;
+    uint16_t msg_len;
+
+    while ((msg = iex_tp_next_message(&seg, &msg_len)) != NULL) {
+        uint64_t sequence = seg.sequence - 1;
+        if (sequence < zone->min_sequence) zone->min_sequence = sequence;
+        if (sequence > zone->max_sequence) zone->max_sequence = sequence;
+
+        zone->type_bitmap |= PCAP_ZONE_TYPE_BIT(msg[IEX_MSG_TYPE_OFFSET]);
+        zone->message_count++;
+
+        if (msg_len < IEX_MSG_SYMBOL_OFFSET) continue;
+        uint64_t timestamp = iex_msg_timestamp(msg);
+        if (timestamp < zone->min_timestamp) zone->min_timestamp = timestamp;
+        if (timestamp > zone->max_timestamp) zone->max_timestamp = timestamp;
+
+        if (msg_len < IEX_MSG_HEADER_LENGTH) continue;  // system events carry no symbol
+        uint64_t symbol = iex_msg_symbol(msg);
+        symbol_id_t id = symbol_table_intern(symbols, symbol);
+        if (id != SYMBOL_ID_INVALID) {
+            zone_symbols[id >> 6] |= 1ULL << (id & 63);
+        } else if (symbol != SYMBOL_EMPTY_KEY) {
+            zone->flags |= PCAP_ZONE_ALL_SYMBOLS;
+        }
+    }
+}
+
+// Modification time in ns, so a rewrite within the same second is noticed
+static int source_mtime(int fd, int64_t *mtime) {
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        perror("fstat");
+        return -1;
+    }
+#ifdef __APPLE__
+    *mtime = (int64_t)st.st_mtimespec.tv_sec * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+    *mtime = (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+    return 0;
+}
+
+int pcap_index_build(const mmap_context_t *ctx, uint32_t stride, pcap_index_t *index) {
+    const uint8_t *base = (const uint8_t *)ctx->data;
+
+    memset(index, 0, sizeof(*index));
+    if (stride == 0) stride = PCAP_INDEX_DEFAULT_STRIDE;
+
+    if (ctx->size < 12 || *((const uint32_t *)base) != PCAPNG_MAGIC) {
+        fprintf(stderr, "Packet index requires a pcapng capture\n");
+        return -1;
+    }
+
+    index->header.magic = PCAP_INDEX_MAGIC;
+    index->header.version = PCAP_INDEX_VERSION;
+    index->header.stride = stride;
+    index->header.chunk_size = PCAP_CHUNK_SIZE;
+    index->header.source_size = ctx->size;
+    int64_t mtime;
+    if (source_mtime(ctx->fd, &mtime) != 0) return -1;
+    index->header.source_mtime_ns = mtime;
+
+    symbol_rows_t *rows = calloc(1, sizeof(symbol_rows_t));
+    if (!rows || symbol_table_init(&index->symbols, SYMBOL_TABLE_MAX) != 0) {
+        fprintf(stderr, "Failed to allocate symbol bitmaps\n");
+        free(rows);
+        return -1;
+    }
+
+    interface_info_t interfaces[MAX_INTERFACES];
+    uint32_t interface_count = 0;
+    for (int i = 0; i < MAX_INTERFACES; i++) interfaces[i].tsresol = 6;
+
+    size_t capacity = 0;
+    size_t zone_capacity = 0;
+    uint64_t segments = 0;
+    const uint8_t *ptr = base;
+    const uint8_t *end = base + ctx->size;
+
+    while (ptr + 12 <= end) {
+        uint32_t block_type = *((const uint32_t *)ptr);
+        uint32_t block_len = *((const uint32_t *)(ptr + 4));
+
+        if (block_len < 12 || block_len > (size_t)(end - ptr)) {
+            fprintf(stderr, "Index stopped at invalid block, offset %zu\n", (size_t)(ptr - base));
+            break;
+        }
+
+        // Blocks belong to the chunk their first byte falls in
+        size_t offset = (size_t)(ptr - base);
+        if (index->header.zone_count == 0 ||
+            offset / PCAP_CHUNK_SIZE != index->zones[index->header.zone_count - 1].start_offset / PCAP_CHUNK_SIZE) {
+            if ((index->header.zone_count > 0 && append_symbol_row(index, rows) != 0) ||
+                append_zone(index, &zone_capacity, offset) != 0) {
+                fprintf(stderr, "Failed to allocate zone maps\n");
+                free(rows);
+                pcap_index_free(index);
+                return -1;
+            }
+        }
+        pcap_zone_map_t *zone = &index->zones[index->header.zone_count - 1];
+        zone->end_offset = offset + block_len;
+
+        if (block_type == PCAPNG_MAGIC) {
+            interface_count = 0;  // interface ids restart with each section
+        } else if (block_type == PCAPNG_IDB_TYPE) {
+            if (interface_count < MAX_INTERFACES) {
+                interfaces[interface_count].tsresol = parse_idb_tsresol(ptr, block_len);
+            }
+            interface_count++;
+        } else if (block_type == PCAPNG_EPB_TYPE && block_len >= sizeof(pcapng_epb_t)) {
+            const pcapng_epb_t *epb = (const pcapng_epb_t *)ptr;
+            size_t payload_len;
+            const uint8_t *payload = NULL;
+
+            if (epb->captured_len <= block_len - sizeof(pcapng_epb_t)) {
+                payload = iex_udp_payload(ptr + sizeof(pcapng_epb_t), epb->captured_len, &payload_len);
+            }
+
+            if (payload && payload_len >= IEX_TP_HEADER_SIZE && payload[0] == IEX_TP_VERSION) {
+                update_zone(zone, rows->current, &index->symbols, payload, payload_len);
+
+                if (segments % stride == 0) {
+                    uint8_t tsresol = epb->interface_id < MAX_INTERFACES
+                                    ? interfaces[epb->interface_id].tsresol : 6;
+                    uint64_t raw = ((uint64_t)epb->timestamp_high << 32) | epb->timestamp_low;
+                    pcap_index_entry_t entry = {
+                        .offset = (uint64_t)(ptr - base),
+                        .timestamp_ns = timestamp_to_ns(raw, tsresol),
+                        .first_sequence = iex_load_u64(payload + IEX_TP_FIRST_SEQUENCE_OFFSET),
+                    };
+
+                    if (append_entry(index, &capacity, &entry) != 0) {
+                        fprintf(stderr, "Failed to allocate index entries\n");
+                        free(rows);
+                        pcap_index_free(index);
+                        return -1;
+                    }
+                }
+                segments++;
+            }
+        }
+
+        ptr += block_len;
+    }
+
+    if (index->header.zone_count > 0 && append_symbol_row(index, rows) != 0) {
+        fprintf(stderr, "Failed to allocate zone maps\n");
+        free(rows);
+        pcap_index_free(index);
+        return -1;
+    }
+    finish_symbol_rows(index, rows);
+    free(rows);
+
+    PARSER_LOG("Indexed %llu segments, %llu entries (stride %u), %llu zone maps, %u symbols\n",
+               (unsigned long long)segments, (unsigned long long)index->header.entry_count, stride,
+               (unsigned long long)index->header.zone_count, index->header.symbol_count);
+    return 0;
+}
+
+int pcap_index_save(const pcap_index_t *index, const char *path) {
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        perror("fopen");
+        return -1;
+    }
+
+    size_t count = (size_t)index->header.entry_count;
+    size_t zones = (size_t)index->header.zone_count;
+    size_t symbols = index->header.symbol_count;
+    size_t bitmap_words = zones * index->header.symbol_words;
+    int ok = fwrite(&index->header, sizeof(index->header), 1, fp) == 1 &&
+             (count == 0 || fwrite(index->entries, sizeof(pcap_index_entry_t), count, fp) == count) &&
+             (zones == 0 || fwrite(index->zones, sizeof(pcap_zone_map_t), zones, fp) == zones) &&
+             (symbols == 0 || fwrite(index->symbols.symbols, sizeof(uint64_t), symbols, fp) == symbols) &&
+             (bitmap_words == 0 ||
+              fwrite(index->symbol_bitmaps, sizeof(uint64_t), bitmap_words, fp) == bitmap_words);
+
+    if (fclose(fp) != 0) ok = 0;
+    if (!ok) {
+        fprintf(stderr, "Failed to write index %s\n", path);
+        remove(path);
+        return -1;
+    }
+
+    return 0;
+}
+
+// Every stored offset must lie inside the capture the index describes
+static int index_offsets_valid(const pcap_index_t *index) {
+    uint64_t size = index->header.source_size;
+
+    for (uint64_t i = 0; i < index->header.entry_count; i++) {
+        if (index->entries[i].offset >= size) return 0;
+    }
+    for (uint64_t z = 0; z < index->header.zone_count; z++) {
+        const pcap_zone_map_t *zone = &index->zones[z];
+        if (zone->start_offset > zone->end_offset || zone->end_offset > size) return 0;
+    }
+    return 1;
+}
+
+int pcap_index_load(const char *path, const mmap_context_t *ctx, pcap_index_t *index) {
+    memset(index, 0, sizeof(*index));
+
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return -1;
+
+    int64_t mtime;
+    struct stat st;
+    if (fstat(fileno(fp), &st) == -1 ||
+        (uint64_t)st.st_size < sizeof(index->header) ||
+        fread(&index->header, sizeof(index->header), 1, fp) != 1 ||
+        index->header.magic != PCAP_INDEX_MAGIC ||
+        index->header.version != PCAP_INDEX_VERSION ||
+        source_mtime(ctx->fd, &mtime) != 0 ||
+        index->header.source_size != ctx->size ||
+        index->header.source_mtime_ns != mtime ||
+        index->header.chunk_size != PCAP_CHUNK_SIZE) {
+        fclose(fp);
+        memset(index, 0, sizeof(*index));
+        return -1;
+    }
+
+    // The counts must describe exactly the bytes that follow the header;
+    // checked by division so a corrupt count cannot overflow the products
+    uint64_t body = (uint64_t)st.st_size - sizeof(index->header);
+    uint64_t count = index->header.entry_count;
+    uint64_t zones = index->header.zone_count;
+    uint32_t symbols = index->header.symbol_count;
+    uint32_t words = index->header.symbol_words;
+    uint64_t zone_bytes = sizeof(pcap_zone_map_t) + (uint64_t)words * sizeof(uint64_t);
+    uint64_t rest = 0;
+    if (count <= body / sizeof(pcap_index_entry_t)) {
+        rest = body - count * sizeof(pcap_index_entry_t);
+    }
+    if (count > body / sizeof(pcap_index_entry_t) ||
+        symbols > SYMBOL_TABLE_MAX || words != PCAP_SYMBOL_WORDS(symbols) ||
+        rest < symbols * sizeof(uint64_t) ||
+        zones != (rest - symbols * sizeof(uint64_t)) / zone_bytes ||
+        rest != symbols * sizeof(uint64_t) + zones * zone_bytes) {
+        fclose(fp);
+        memset(index, 0, sizeof(*index));
+        return -1;
+    }
+
+    if (count > 0) {
+        index->entries = malloc((size_t)count * sizeof(pcap_index_entry_t));
+        if (!index->entries || fread(index->entries, sizeof(pcap_index_entry_t), (size_t)count, fp) != count) {
+            fclose(fp);
+            pcap_index_free(index);
+            return -1;
+        }
+    }
+
+    if (zones > 0) {
+        index->zones = malloc((size_t)zones * sizeof(pcap_zone_map_t));
+        if (!index->zones || fread(index->zones, sizeof(pcap_zone_map_t), (size_t)zones, fp) != zones) {
+            fclose(fp);
+            pcap_index_free(index);
+            return -1;
+        }
+    }
+
+    // Rebuild the dictionary in ID order; a repeated or zero word is corrupt
+    uint64_t *words_in_order = malloc(((size_t)symbols + 1) * sizeof(uint64_t));
+    int ok = words_in_order &&
+             fread(words_in_order, sizeof(uint64_t), symbols, fp) == symbols &&
+             symbol_table_init(&index->symbols, symbols ? symbols : 1) == 0;
+    for (uint32_t i = 0; ok && i < symbols; i++) {
+        ok = symbol_table_intern(&index->symbols, words_in_order[i]) == i;
+    }
+    free(words_in_order);
+
+    size_t bitmap_words = (size_t)zones * words;
+    if (ok && bitmap_words > 0) {
+        index->symbol_bitmaps = malloc(bitmap_words * sizeof(uint64_t));
+        ok = index->symbol_bitmaps &&
+             fread(index->symbol_bitmaps, sizeof(uint64_t), bitmap_words, fp) == bitmap_words;
+    }
+    if (!ok) {
+        fclose(fp);
+        pcap_index_free(index);
+        return -1;
+    }
+
+    fclose(fp);
+    if (!index_offsets_valid(index)) {
+        pcap_index_free(index);
+        return -1;
+    }
+    return 0;
+}
+
+int pcap_index_open(const char *pcap_path, const mmap_context_t *ctx,
+                    uint32_t stride, pcap_index_t *index) {
+    size_t len = strlen(pcap_path);
+    char *path = malloc(len + sizeof(PCAP_INDEX_SUFFIX));
+    if (!path) return -1;
+    memcpy(path, pcap_path, len);
+    memcpy(path + len, PCAP_INDEX_SUFFIX, sizeof(PCAP_INDEX_SUFFIX));
+
+    if (pcap_index_load(path, ctx, index) == 0) {
+        PARSER_LOG("Loaded packet index %s (%llu entries)\n",
+                   path, (unsigned long long)index->header.entry_count);
+        free(path);
+        return 0;
+    }
+
+    PARSER_LOG("Building packet index %s\n", path);
+    int result = pcap_index_build(ctx, stride, index);
+    if (result == 0 && pcap_index_save(index, path) != 0) {
+        // The in-memory index is still usable for this run
+        fprintf(stderr, "Continuing without a saved index\n");
+    }
+
+    free(path);
+    return result;
+}
+
+void pcap_index_free(pcap_index_t *index) {
+    free(index->entries);
+    free(index->zones);
+    free(index->symbol_bitmaps);
+    symbol_table_free(&index->symbols);
+    index->entries = NULL;
+    index->zones = NULL;
+    index->symbol_bitmaps = NULL;
+    index->header.entry_count = 0;
+    index->header.zone_count = 0;
+}
+
+static inline uint64_t entry_key(const pcap_index_entry_t *entry, int by_sequence) {
+    return by_sequence ? entry->first_sequence : entry->timestamp_ns;
+}
+
+// Point ctx at the last entry whose key is <= target
+static int seek_entry(const pcap_index_t *index, mmap_context_t *ctx,
+                      uint64_t target, int by_sequence) {
+    size_t lo = 0;
+    size_t hi = (size_t)index->header.entry_count;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (entry_key(&index->entries[mid], by_sequence) <= target) lo = mid + 1;
+        else hi = mid;
+    }
+
+    if (lo == 0) return -1;  // target precedes the first entry
+
+    ctx->offset = (size_t)index->entries[lo - 1].offset;
+    return 0;
+}
+
+int pcap_index_seek_time(const pcap_index_t *index, mmap_context_t *ctx, uint64_t timestamp_ns) {
+    return seek_entry(index, ctx, timestamp_ns, 0);
+}
+
+int pcap_index_seek_sequence(const pcap_index_t *index, mmap_context_t *ctx, uint64_t sequence) {
+    return seek_entry(index, ctx, sequence, 1);
+}
+
+void pcap_query_init(pcap_query_t *query) {
+    memset(query, 0, sizeof(*query));
+    query->until_timestamp = UINT64_MAX;
+    query->type_mask = UINT64_MAX;
+}
+
+int pcap_query_add_symbol(pcap_query_t *query, const char *ticker) {
+    if (query->symbol_count >= PCAP_QUERY_MAX_SYMBOLS) return -1;
+
+    char padded[8];
+    memset(padded, ' ', sizeof(padded));
+    size_t len = strlen(ticker);
+    memcpy(padded, ticker, len < sizeof(padded) ? len : sizeof(padded));
+
+    memcpy(&query->symbols[query->symbol_count++], padded, sizeof(padded));
+    return 0;
+}
+
+int pcap_query_match_zone(const pcap_query_t *query, const pcap_index_t *index, uint64_t z) {
+    const pcap_zone_map_t *zone = &index->zones[z];
+
+    if (zone->message_count == 0) return 0;
+    if (!(zone->type_bitmap & query->type_mask)) return 0;
+    if (zone->max_timestamp < query->from_timestamp ||
+        zone->min_timestamp > query->until_timestamp) return 0;
+
+    if (query->symbol_count == 0 || (zone->flags & PCAP_ZONE_ALL_SYMBOLS)) return 1;
+
+    // A symbol missing from the dictionary appears in no chunk
+    const uint64_t *bitmap = index->symbol_bitmaps + z * index->header.symbol_words;
+    for (uint32_t i = 0; i < query->symbol_count; i++) {
+        symbol_id_t id = symbol_table_find(&index->symbols, query->symbols[i]);
+        if (id != SYMBOL_ID_INVALID && (bitmap[id >> 6] & (1ULL << (id & 63)))) return 1;
+    }
+    return 0;
+}
+
+int pcap_query_match_message(const pcap_query_t *query, const parsed_message_t *msg) {
+    if (!(PCAP_ZONE_TYPE_BIT(msg->message_type) & query->type_mask)) return 0;
+    if (msg->timestamp_ns < query->from_timestamp ||
+        msg->timestamp_ns > query->until_timestamp) return 0;
+
+    if (query->symbol_count == 0) return 1;
+    for (uint32_t i = 0; i < query->symbol_count; i++) {
+        if (msg->symbol_hash == query->symbols[i]) return 1;
+    }
+    return 0;
+}
+
+int parse_pcap_file_query(mmap_context_t *ctx, const pcap_index_t *index,
+                          const pcap_query_t *query) {
+    const uint8_t *base = (const uint8_t *)ctx->data;
+    const uint8_t *limit = base + ctx->size;
+
+    message_pipeline_t pipeline;
+    if (start_message_delivery(&pipeline, BATCH_POOL_DEPTH) != 0) {
+        return -1;
+    }
+
+    // Only the chunks we decode should be read; undo the whole-file readahead
+    long page = sysconf(_SC_PAGESIZE);
+    madvise(ctx->data, ctx->size, MADV_RANDOM);
+
+    uint64_t total_packets = 0;
+    uint64_t total_messages = 0;
+    uint64_t bytes_skipped = 0;
+    size_t zones_skipped = 0;
+    int result = 0;
+
+    for (uint64_t z = 0; z < index->header.zone_count && result == 0; z++) {
+        const pcap_zone_map_t *zone = &index->zones[z];
+
+        if (!pcap_query_match_zone(query, index, z)) {
+            zones_skipped++;
+            bytes_skipped += zone->end_offset - zone->start_offset;
+            continue;
+        }
+
+        size_t aligned = (size_t)zone->start_offset & ~((size_t)page - 1);
+        madvise((uint8_t *)ctx->data + aligned, (size_t)(zone->end_offset - aligned), MADV_WILLNEED);
+
+        const uint8_t *data = base + zone->start_offset;
+        const uint8_t *stop = base + zone->end_offset;
+
+        while (data < stop) {
+            message_batch_t *batch = batch_pool_acquire(&pipeline.pool);
+            const uint8_t *next = decode_pcapng_blocks(data, stop, limit, batch, &batch->packets);
+
+            if (next == data) {
+                fprintf(stderr, "Invalid or truncated block at offset %zu\n", (size_t)(data - base));
+                batch_pool_release(&pipeline.pool, batch);
+                result = -1;
+                break;
+            }
+            data = next;
+
+            // Keep only the messages the query asked for
+            uint32_t kept = 0;
+            for (uint32_t i = 0; i < batch->count; i++) {
+                if (pcap_query_match_message(query, &batch->messages[i])) {
+                    batch->messages[kept++] = batch->messages[i];
+                }
+            }
+            batch->count = kept;
+
+            total_packets += batch->packets;
+            total_messages += kept;
+            batch_pool_submit(&pipeline.pool, batch);
+        }
+        mmap_release_behind(ctx, (size_t)zone->end_offset);
+    }
+
+    drain_message_delivery(&pipeline);
+    PARSER_LOG("Zone maps skipped %zu of %llu chunks (%.1f%% of file)\n",
+               zones_skipped, (unsigned long long)index->header.zone_count,
+               ctx->size ? 100.0 * bytes_skipped / ctx->size : 0.0);
+    PARSER_LOG("Final stats: %llu packets, %llu messages matched\n",
+               (unsigned long long)total_packets, (unsigned long long)total_messages);
+    finish_message_delivery(&pipeline);
+    return result;
+}
+
+int pcap_parse_time_of_day(const char *text, uint64_t *ns) {
+    unsigned hours = 0, minutes = 0, seconds = 0;
+    int consumed = 0;
+
+    if (sscanf(text, "%u:%u%n", &hours, &minutes, &consumed) != 2) return -1;
+    text += consumed;
+
+    if (*text == ':') {
+        if (sscanf(text + 1, "%u%n", &seconds, &consumed) != 1) return -1;
+        text += 1 + consumed;
+    }
+
+    uint64_t fraction = 0;
+    if (*text == '.') {
+        uint64_t scale = 100000000ULL;
+        for (text++; *text >= '0' && *text <= '9'; text++) {
+            fraction += (uint64_t)(*text - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    if (*text != '\0' || hours > 23 || minutes > 59 || seconds > 59) return -1;
+
+    *ns = ((uint64_t)hours * 3600 + minutes * 60 + seconds) * 1000000000ULL + fraction;
+    return 0;
+}
+
+uint64_t pcap_index_time_of_day(const pcap_index_t *index, uint64_t ns_since_midnight) {
+    if (index->header.entry_count == 0) return ns_since_midnight;
+
+    uint64_t first = index->entries[0].timestamp_ns;
+    return first - first % NS_PER_DAY + ns_since_midnight;
+}
@@ -0,0 +1,130 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "perf_counters.h"
+
+static const char *const counter_names[PERF_COUNTER_COUNT] = {
+    "cycles", "instructions", "L1d-misses", "LLC-misses", "branch-misses", "dTLB-misses",
+};
+
+const char *perf_counter_name(perf_counter_id_t id) {
+    return (id < PERF_COUNTER_COUNT) ? counter_names[id] : "unknown";
+}
+
+#ifdef __linux__
+
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#define CACHE_READ_MISS(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} counter_events[PERF_COUNTER_COUNT] = {
+    [PERF_COUNTER_CYCLES]        = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    [PERF_COUNTER_INSTRUCTIONS]  = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    [PERF_COUNTER_L1D_MISSES]    = { PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D) },
+    [PERF_COUNTER_LLC_MISSES]    = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    [PERF_COUNTER_BRANCH_MISSES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    [PERF_COUNTER_DTLB_MISSES]   = { PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB) },
+};
+
+static int open_event(perf_counter_id_t id) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = counter_events[id].type;
+    attr.config = counter_events[id].config;
+    attr.disabled = 1;
+    attr.inherit = 1;               // worker threads started while counting
+    attr.exclude_kernel = 1;        // allowed at perf_event_paranoid 2
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+}
+
+int perf_counters_open(perf_counters_t *counters) {
+    int last_errno = 0;
+    counters->open_count = 0;
+
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        counters->fds[i] = open_event((perf_counter_id_t)i);
+        if (counters->fds[i] >= 0) {
+            counters->open_count++;
+        } else {
+            last_errno = errno;
+        }
+    }
+
+    if (counters->open_count == 0) {
+        fprintf(stderr, "perf_event_open: %s (no PMU, or kernel.perf_event_paranoid > 2)\n",
+                strerror(last_errno));
+    }
+    return counters->open_count;
+}
+
+void perf_counters_close(perf_counters_t *counters) {
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        if (counters->fds[i] >= 0) close(counters->fds[i]);
+        counters->fds[i] = -1;
+    }
+    counters->open_count = 0;
+}
+
+void perf_counters_start(perf_counters_t *counters) {
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        if (counters->fds[i] < 0) continue;
+        ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void perf_counters_stop(perf_counters_t *counters, perf_sample_t *sample) {
+    memset(sample, 0, sizeof(*sample));
+
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        if (counters->fds[i] >= 0) ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        uint64_t values[3];     // value, time enabled, time running
+        if (counters->fds[i] < 0 ||
+            read(counters->fds[i], values, sizeof(values)) != (ssize_t)sizeof(values) ||
+            values[2] == 0) {
+            continue;
+        }
+        sample->values[i] = (values[2] < values[1])
+            ? (uint64_t)((double)values[0] * values[1] / values[2])
+            : values[0];
+        sample->valid |= 1u << i;
+    }
+}
+
+#else
+
+int perf_counters_open(perf_counters_t *counters) {
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) counters->fds[i] = -1;
+    counters->open_count = 0;
+    fprintf(stderr, "Hardware counters require Linux perf_event_open\n");
+    return 0;
+}
+
+void perf_counters_close(perf_counters_t *counters) {
+    (void)counters;
+}
+
+void perf_counters_start(perf_counters_t *counters) {
+    (void)counters;
+}
+
+void perf_counters_stop(perf_counters_t *counters, perf_sample_t *sample) {
+    (void)counters;
+    memset(sample, 0, sizeof(*sample));
+}
+
+#endif
@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "pipeline_stats.h"
+
+_Thread_local pipeline_thread_stats_t *pipeline_stats_local;
+
+// Every block ever claimed; blocks of exited threads are reused, counts kept
+static pipeline_thread_stats_t *registry;
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t release_key;
+static pthread_once_t release_once = PTHREAD_ONCE_INIT;
+
+// Tick rate calibration: both clocks at first use (or reset)
+static uint64_t calibration_ticks;
+static uint64_t calibration_ns;
+
+static const char *const stage_names[PIPELINE_STAGE_COUNT] = {
+    [PIPELINE_STAGE_BLOCK_WALK] = "block walk",
+    [PIPELINE_STAGE_FRAMING]    = "framing",
+    [PIPELINE_STAGE_DECODE]     = "decode",
+    [PIPELINE_STAGE_DISPATCH]   = "dispatch",
+    [PIPELINE_STAGE_CONSUMER]   = "consumer",
+};
+
+const char *pipeline_stage_name(pipeline_stage_t stage) {
+    return (stage < PIPELINE_STAGE_COUNT) ? stage_names[stage] : "unknown";
+}
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void calibrate_start(void) {
+    calibration_ns = monotonic_ns();
+    calibration_ticks = pipeline_ticks();
+}
+
+static void release_stats(void *block) {
+    pthread_mutex_lock(&registry_lock);
+    ((pipeline_thread_stats_t *)block)->in_use = 0;
+    pthread_mutex_unlock(&registry_lock);
+}
+
+static void init_release_key(void) {
+    pthread_key_create(&release_key, release_stats);
+}
+
+pipeline_thread_stats_t *pipeline_stats_attach(void) {
+    pthread_once(&release_once, init_release_key);
+    pthread_mutex_lock(&registry_lock);
+
+    pipeline_thread_stats_t *stats = registry;
+    while (stats && stats->in_use) stats = stats->next;
+    if (!stats) {
+        stats = calloc(1, sizeof(pipeline_thread_stats_t));
+        if (!stats) {
+            pthread_mutex_unlock(&registry_lock);
+            fprintf(stderr, "Failed to allocate pipeline stats\n");
+            abort();
+        }
+        if (!registry) calibrate_start();
+        stats->next = registry;
+        registry = stats;
+    }
+    stats->in_use = 1;
+
+    pthread_mutex_unlock(&registry_lock);
+    pthread_setspecific(release_key, stats);
+    pipeline_stats_local = stats;
+    return stats;
+}
+
+void pipeline_stats_merge(pipeline_stats_t *merged) {
+    memset(merged, 0, sizeof(*merged));
+
+    pthread_mutex_lock(&registry_lock);
+    for (const pipeline_thread_stats_t *stats = registry; stats; stats = stats->next) {
+        merged->threads++;
+        for (int s = 0; s < PIPELINE_STAGE_COUNT; s++) {
+            const stats_histogram_t *from = &stats->stages[s];
+            stats_histogram_t *to = &merged->stages[s];
+            if (from->count == 0) continue;
+            to->count += from->count;
+            to->total += from->total;
+            if (from->max > to->max) to->max = from->max;
+            for (uint32_t b = 0; b < PIPELINE_STATS_BUCKETS; b++) to->buckets[b] += from->buckets[b];
+        }
+    }
+
+    // Ticks per ns over everything seen so far; 1:1 for the fallback clock
+#if defined(__x86_64__) || defined(__aarch64__)
+    uint64_t elapsed_ns = monotonic_ns() - calibration_ns;
+    uint64_t elapsed_ticks = pipeline_ticks() - calibration_ticks;
+    merged->ns_per_tick = (registry && elapsed_ticks > 0) ? (double)elapsed_ns / elapsed_ticks : 0.0;
+#else
+    merged->ns_per_tick = 1.0;
+#endif
+    pthread_mutex_unlock(&registry_lock);
+}
+
+void pipeline_stats_reset(void) {
+    pthread_mutex_lock(&registry_lock);
+    for (pipeline_thread_stats_t *stats = registry; stats; stats = stats->next) {
+        memset(stats->stages, 0, sizeof(stats->stages));
+    }
+    calibrate_start();
+    pthread_mutex_unlock(&registry_lock);
+}
+
+uint64_t pipeline_stats_quantile(const stats_histogram_t *histogram, double q) {
+    if (histogram->count == 0) return 0;
+
+    // Highest value of the bucket holding the rank, as HdrHistogram reports it
+    uint64_t rank = (uint64_t)(q * histogram->count);
+    if (rank >= histogram->count) rank = histogram->count - 1;
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < PIPELINE_STATS_BUCKETS; b++) {
+        seen += histogram->buckets[b];
+        if (seen > rank) {
+            uint64_t top = (b + 1 < PIPELINE_STATS_BUCKETS) ? stats_bucket_floor(b + 1) - 1 : UINT64_MAX;
+            return top < histogram->max ? top : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+void pipeline_stats_report(FILE *out) {
+    pipeline_stats_t *merged = malloc(sizeof(pipeline_stats_t));
+    if (!merged) return;
+    pipeline_stats_merge(merged);
+
+    double scale = merged->ns_per_tick;
+    fprintf(out, "\nPipeline stage latency (%u threads; 1 in %u packets timed, every batch):\n",
+            merged->threads, PIPELINE_STATS_SAMPLE_EVERY);
+    fprintf(out, "%-11s %6s %10s %9s %9s %9s %9s %9s %11s %9s\n", "Stage", "Per", "Samples",
+            "Mean ns", "p50 ns", "p90 ns", "p99 ns", "p99.9 ns", "Max ns", "Total ms");
+
+    for (int s = 0; s < PIPELINE_STAGE_COUNT; s++) {
+        const stats_histogram_t *h = &merged->stages[s];
+        int per_packet = s <= PIPELINE_STAGE_DECODE;
+        if (h->count == 0) continue;
+
+        // Sampled stages: total extrapolated to every packet
+        double total_ms = h->total * scale / 1e6 * (per_packet ? PIPELINE_STATS_SAMPLE_EVERY : 1);
+        fprintf(out, "%-11s %6s %10llu %9.1f %9.0f %9.0f %9.0f %9.0f %11.0f %9.1f\n",
+                pipeline_stage_name((pipeline_stage_t)s), per_packet ? "packet" : "batch",
+                (unsigned long long)h->count, (double)h->total / h->count * scale,
+                pipeline_stats_quantile(h, 0.50) * scale, pipeline_stats_quantile(h, 0.90) * scale,
+                pipeline_stats_quantile(h, 0.99) * scale, pipeline_stats_quantile(h, 0.999) * scale,
+                h->max * scale, total_ms);
+    }
+    free(merged);
+}
@@ -0,0 +1,336 @@
+#include <stdint.h>
+#include <stddef.h>
+#include "price_kernels.h"
+#include "cpu_dispatch.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// Scalar reference (and tail) versions
+
+static void to_double_scalar(const iex_price_t *prices, double *dollars, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dollars[i] = (double)prices[i] / IEX_PRICE_SCALE;
+    }
+}
+
+static size_t range_scalar(const iex_price_t *prices, size_t count,
+                           iex_price_t *min, iex_price_t *max) {
+    size_t quoted = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (prices[i] == 0) continue;
+        if (prices[i] < *min) *min = prices[i];
+        if (prices[i] > *max) *max = prices[i];
+        quoted++;
+    }
+    return quoted;
+}
+
+static size_t crossed_scalar(const iex_price_t *bids, const iex_price_t *asks, size_t count) {
+    size_t crossed = 0;
+    for (size_t i = 0; i < count; i++) {
+        crossed += (bids[i] != 0 && asks[i] != 0 && bids[i] >= asks[i]);
+    }
+    return crossed;
+}
+
+#if defined(__x86_64__)
+// SSE4.2: pcmpgtq gives signed 64-bit compares two lanes at a time
+
+CPU_TARGET_SSE42
+static size_t range_sse42(const iex_price_t *prices, size_t count,
+                          iex_price_t *min, iex_price_t *max) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i vlo = _mm_set1_epi64x(INT64_MAX), vhi = _mm_set1_epi64x(INT64_MIN);
+    __m128i vquoted = zero;
+    size_t i = 0;
+
+    // Empty (0) slots are replaced by the identity of each reduction
+    for (; i + 2 <= count; i += 2) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(prices + i));
+        __m128i empty = _mm_cmpeq_epi64(v, zero);
+        __m128i as_lo = _mm_blendv_epi8(v, _mm_set1_epi64x(INT64_MAX), empty);
+        __m128i as_hi = _mm_blendv_epi8(v, _mm_set1_epi64x(INT64_MIN), empty);
+        vlo = _mm_blendv_epi8(vlo, as_lo, _mm_cmpgt_epi64(vlo, as_lo));
+        vhi = _mm_blendv_epi8(vhi, as_hi, _mm_cmpgt_epi64(as_hi, vhi));
+        vquoted = _mm_sub_epi64(vquoted, _mm_andnot_si128(empty, _mm_set1_epi64x(-1)));
+    }
+    int64_t lanes_lo[2], lanes_hi[2], lanes_quoted[2];
+    _mm_storeu_si128((__m128i *)lanes_lo, vlo);
+    _mm_storeu_si128((__m128i *)lanes_hi, vhi);
+    _mm_storeu_si128((__m128i *)lanes_quoted, vquoted);
+    iex_price_t lo = lanes_lo[0] < lanes_lo[1] ? lanes_lo[0] : lanes_lo[1];
+    iex_price_t hi = lanes_hi[0] > lanes_hi[1] ? lanes_hi[0] : lanes_hi[1];
+    size_t quoted = (size_t)(lanes_quoted[0] + lanes_quoted[1]);
+
+    quoted += range_scalar(prices + i, count - i, &lo, &hi);
+    if (quoted > 0) {
+        *min = lo;
+        *max = hi;
+    }
+    return quoted;
+}
+
+CPU_TARGET_SSE42
+static size_t crossed_sse42(const iex_price_t *bids, const iex_price_t *asks, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t crossed = 0, i = 0;
+
+    for (; i + 2 <= count; i += 2) {
+        __m128i b = _mm_loadu_si128((const __m128i *)(bids + i));
+        __m128i a = _mm_loadu_si128((const __m128i *)(asks + i));
+        // bid >= ask is !(ask > bid); empty sides are masked out
+        __m128i empty = _mm_or_si128(_mm_cmpeq_epi64(b, zero), _mm_cmpeq_epi64(a, zero));
+        __m128i not_crossed = _mm_or_si128(empty, _mm_cmpgt_epi64(a, b));
+        int lanes = _mm_movemask_pd(_mm_castsi128_pd(not_crossed));
+        crossed += (size_t)(2 - __builtin_popcount(lanes));
+    }
+    return crossed + crossed_scalar(bids + i, asks + i, count - i);
+}
+
+// Exact int64 -> double without AVX-512DQ: split at bit 48. The signed
+// high 16 bits ride in the mantissa of 3*2^67 (ulp 2^16, so exactly
+// x >> 48 times 2^48) and the low 48 bits in that of 2^52 (ulp 1). The
+// subtraction of both magic numbers is exact; the final add rounds once
+CPU_TARGET_AVX2
+static inline __m256d avx2_cvt_i64_pd(__m256i x) {
+    __m256i high = _mm256_srai_epi32(x, 16);
+    high = _mm256_blend_epi16(high, _mm256_setzero_si256(), 0x33);
+    high = _mm256_add_epi64(high, _mm256_castpd_si256(_mm256_set1_pd(442721857769029238784.0)));  // 3*2^67
+    __m256i low = _mm256_blend_epi16(x, _mm256_castpd_si256(_mm256_set1_pd(4503599627370496.0)), 0x88);  // 2^52
+    __m256d f = _mm256_sub_pd(_mm256_castsi256_pd(high),
+                              _mm256_set1_pd(442726361368656609280.0));  // 3*2^67 + 2^52
+    return _mm256_add_pd(f, _mm256_castsi256_pd(low));
+}
+
+CPU_TARGET_AVX2
+static void to_double_avx2(const iex_price_t *prices, double *dollars, size_t count) {
+    const __m256d scale = _mm256_set1_pd(IEX_PRICE_SCALE);
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m256d v = avx2_cvt_i64_pd(_mm256_loadu_si256((const __m256i *)(prices + i)));
+        _mm256_storeu_pd(dollars + i, _mm256_div_pd(v, scale));
+    }
+    to_double_scalar(prices + i, dollars + i, count - i);
+}
+
+CPU_TARGET_AVX2
+static size_t range_avx2(const iex_price_t *prices, size_t count,
+                         iex_price_t *min, iex_price_t *max) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i vlo = _mm256_set1_epi64x(INT64_MAX), vhi = _mm256_set1_epi64x(INT64_MIN);
+    __m256i vquoted = zero;
+    iex_price_t lo = INT64_MAX, hi = INT64_MIN;
+    size_t quoted = 0, i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(prices + i));
+        __m256i empty = _mm256_cmpeq_epi64(v, zero);
+        __m256i as_lo = _mm256_blendv_epi8(v, _mm256_set1_epi64x(INT64_MAX), empty);
+        __m256i as_hi = _mm256_blendv_epi8(v, _mm256_set1_epi64x(INT64_MIN), empty);
+        vlo = _mm256_blendv_epi8(vlo, as_lo, _mm256_cmpgt_epi64(vlo, as_lo));
+        vhi = _mm256_blendv_epi8(vhi, as_hi, _mm256_cmpgt_epi64(as_hi, vhi));
+        vquoted = _mm256_sub_epi64(vquoted, _mm256_andnot_si256(empty, _mm256_set1_epi64x(-1)));
+    }
+    int64_t lanes_lo[4], lanes_hi[4], lanes_quoted[4];
+    _mm256_storeu_si256((__m256i *)lanes_lo, vlo);
+    _mm256_storeu_si256((__m256i *)lanes_hi, vhi);
+    _mm256_storeu_si256((__m256i *)lanes_quoted, vquoted);
+    for (int lane = 0; lane < 4; lane++) {
+        if (lanes_lo[lane] < lo) lo = lanes_lo[lane];
+        if (lanes_hi[lane] > hi) hi = lanes_hi[lane];
+        quoted += (size_t)lanes_quoted[lane];
+    }
+
+    quoted += range_scalar(prices + i, count - i, &lo, &hi);
+    if (quoted > 0) {
+        *min = lo;
+        *max = hi;
+    }
+    return quoted;
+}
+
+CPU_TARGET_AVX2
+static size_t crossed_avx2(const iex_price_t *bids, const iex_price_t *asks, size_t count) {
+    const __m256i zero = _mm256_setzero_si256();
+    size_t crossed = 0, i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m256i b = _mm256_loadu_si256((const __m256i *)(bids + i));
+        __m256i a = _mm256_loadu_si256((const __m256i *)(asks + i));
+        __m256i empty = _mm256_or_si256(_mm256_cmpeq_epi64(b, zero), _mm256_cmpeq_epi64(a, zero));
+        __m256i not_crossed = _mm256_or_si256(empty, _mm256_cmpgt_epi64(a, b));
+        int lanes = _mm256_movemask_pd(_mm256_castsi256_pd(not_crossed));
+        crossed += (size_t)(4 - __builtin_popcount(lanes));
+    }
+    return crossed + crossed_scalar(bids + i, asks + i, count - i);
+}
+
+CPU_TARGET_AVX512
+static void to_double_avx512(const iex_price_t *prices, double *dollars, size_t count) {
+    const __m512d scale = _mm512_set1_pd(IEX_PRICE_SCALE);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m512d v = _mm512_cvtepi64_pd(_mm512_loadu_si512(prices + i));
+        _mm512_storeu_pd(dollars + i, _mm512_div_pd(v, scale));
+    }
+    to_double_scalar(prices + i, dollars + i, count - i);
+}
+
+CPU_TARGET_AVX512
+static size_t range_avx512(const iex_price_t *prices, size_t count,
+                           iex_price_t *min, iex_price_t *max) {
+    __m512i vlo = _mm512_set1_epi64(INT64_MAX), vhi = _mm512_set1_epi64(INT64_MIN);
+    size_t quoted = 0, i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m512i v = _mm512_loadu_si512(prices + i);
+        __mmask8 set = _mm512_test_epi64_mask(v, v);
+        vlo = _mm512_mask_min_epi64(vlo, set, vlo, v);
+        vhi = _mm512_mask_max_epi64(vhi, set, vhi, v);
+        quoted += (size_t)__builtin_popcount(set);
+    }
+    iex_price_t lo = _mm512_reduce_min_epi64(vlo);
+    iex_price_t hi = _mm512_reduce_max_epi64(vhi);
+
+    quoted += range_scalar(prices + i, count - i, &lo, &hi);
+    if (quoted > 0) {
+        *min = lo;
+        *max = hi;
+    }
+    return quoted;
+}
+
+CPU_TARGET_AVX512
+static size_t crossed_avx512(const iex_price_t *bids, const iex_price_t *asks, size_t count) {
+    size_t crossed = 0, i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m512i b = _mm512_loadu_si512(bids + i);
+        __m512i a = _mm512_loadu_si512(asks + i);
+        __mmask8 quoted = _mm512_test_epi64_mask(b, b) & _mm512_test_epi64_mask(a, a);
+        crossed += (size_t)__builtin_popcount(_mm512_mask_cmpge_epi64_mask(quoted, b, a));
+    }
+    return crossed + crossed_scalar(bids + i, asks + i, count - i);
+}
+
+#elif defined(__aarch64__)
+
+static void to_double_neon(const iex_price_t *prices, double *dollars, size_t count) {
+    const float64x2_t scale = vdupq_n_f64(IEX_PRICE_SCALE);
+    size_t i = 0;
+
+    for (; i + 2 <= count; i += 2) {
+        float64x2_t v = vcvtq_f64_s64(vld1q_s64(prices + i));
+        vst1q_f64(dollars + i, vdivq_f64(v, scale));
+    }
+    to_double_scalar(prices + i, dollars + i, count - i);
+}
+
+static size_t range_neon(const iex_price_t *prices, size_t count,
+                         iex_price_t *min, iex_price_t *max) {
+    int64x2_t vlo = vdupq_n_s64(INT64_MAX), vhi = vdupq_n_s64(INT64_MIN);
+    uint64x2_t vquoted = vdupq_n_u64(0);
+    size_t i = 0;
+
+    for (; i + 2 <= count; i += 2) {
+        int64x2_t v = vld1q_s64(prices + i);
+        uint64x2_t set = vtstq_s64(v, v);
+        int64x2_t as_lo = vbslq_s64(set, v, vdupq_n_s64(INT64_MAX));
+        int64x2_t as_hi = vbslq_s64(set, v, vdupq_n_s64(INT64_MIN));
+        vlo = vbslq_s64(vcltq_s64(as_lo, vlo), as_lo, vlo);
+        vhi = vbslq_s64(vcgtq_s64(as_hi, vhi), as_hi, vhi);
+        vquoted = vsubq_u64(vquoted, set);
+    }
+    int64_t lanes_lo[2], lanes_hi[2];
+    vst1q_s64(lanes_lo, vlo);
+    vst1q_s64(lanes_hi, vhi);
+    iex_price_t lo = lanes_lo[0] < lanes_lo[1] ? lanes_lo[0] : lanes_lo[1];
+    iex_price_t hi = lanes_hi[0] > lanes_hi[1] ? lanes_hi[0] : lanes_hi[1];
+    size_t quoted = (size_t)vaddvq_u64(vquoted);
+
+    quoted += range_scalar(prices + i, count - i, &lo, &hi);
+    if (quoted > 0) {
+        *min = lo;
+        *max = hi;
+    }
+    return quoted;
+}
+
+static size_t crossed_neon(const iex_price_t *bids, const iex_price_t *asks, size_t count) {
+    uint64x2_t vcrossed = vdupq_n_u64(0);
+    size_t i = 0;
+
+    for (; i + 2 <= count; i += 2) {
+        int64x2_t b = vld1q_s64(bids + i);
+        int64x2_t a = vld1q_s64(asks + i);
+        uint64x2_t hit = vandq_u64(vandq_u64(vtstq_s64(b, b), vtstq_s64(a, a)), vcgeq_s64(b, a));
+        vcrossed = vsubq_u64(vcrossed, hit);
+    }
+    return (size_t)vaddvq_u64(vcrossed) + crossed_scalar(bids + i, asks + i, count - i);
+}
+#endif
+
+static size_t range_scalar_entry(const iex_price_t *prices, size_t count,
+                                 iex_price_t *min, iex_price_t *max) {
+    iex_price_t lo = INT64_MAX, hi = INT64_MIN;
+    size_t quoted = range_scalar(prices, count, &lo, &hi);
+    if (quoted > 0) {
+        *min = lo;
+        *max = hi;
+    }
+    return quoted;
+}
+
+void price_kernels_resolve(cpu_isa_t isa, cpu_kernels_t *kernels) {
+    kernels->price_to_double = to_double_scalar;
+    kernels->price_range = range_scalar_entry;
+    kernels->price_count_crossed = crossed_scalar;
+
+#if defined(__x86_64__)
+    switch (isa) {
+        case CPU_ISA_SSE42:
+            kernels->price_range = range_sse42;
+            kernels->price_count_crossed = crossed_sse42;
+            break;
+        case CPU_ISA_AVX2:
+            kernels->price_to_double = to_double_avx2;
+            kernels->price_range = range_avx2;
+            kernels->price_count_crossed = crossed_avx2;
+            break;
+        case CPU_ISA_AVX512:
+            kernels->price_to_double = to_double_avx512;
+            kernels->price_range = range_avx512;
+            kernels->price_count_crossed = crossed_avx512;
+            break;
+        default:
+            break;
+    }
+#elif defined(__aarch64__)
+    if (isa == CPU_ISA_NEON) {
+        kernels->price_to_double = to_double_neon;
+        kernels->price_range = range_neon;
+        kernels->price_count_crossed = crossed_neon;
+    }
+#else
+    (void)isa;
+#endif
+}
+
+void price_to_double(const iex_price_t *prices, double *dollars, size_t count) {
+    cpu_kernels.price_to_double(prices, dollars, count);
+}
+
+size_t price_range(const iex_price_t *prices, size_t count,
+                   iex_price_t *min, iex_price_t *max) {
+    return cpu_kernels.price_range(prices, count, min, max);
+}
+
+size_t price_count_crossed(const iex_price_t *bids, const iex_price_t *asks, size_t count) {
+    return cpu_kernels.price_count_crossed(bids, asks, count);
+}
@@ -1,43 +1,42 @@
 #include "simd_optimizer.h"
+#include "pcap.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 
-// Stub implementations for SIMD functions
-// These provide basic functionality when assembly isn't available
+// Portable versions of the assembly entry points
+// Used where src/asm has no implementation for the target; the contracts
+// are those of src/asm/x86_64/simd_optimizer.S.
 
+// Compact the pcap_header_t entries with a pcap or pcapng magic
 uint32_t _simd_parse_pcap_batch(const void* input_buffer, 
                                void* output_buffer, 
                                uint32_t header_count) {
-    // Simple stub - just copy valid headers
-    // In real implementation, this would be highly optimized assembly
-    const uint32_t* input = (const uint32_t*)input_buffer;
-    uint32_t* output = (uint32_t*)output_buffer;
+    const pcap_header_t* input = (const pcap_header_t*)input_buffer;
+    pcap_header_t* output = (pcap_header_t*)output_buffer;
     uint32_t valid_count = 0;
     
     for (uint32_t i = 0; i < header_count; i++) {
-        uint32_t magic = input[i * 4]; // Assume 16-byte headers
-        if (magic == 0x0a0d0d0a || magic == 0xa1b2c3d4) { // PCAPNG or PCAP magic
-            memcpy(&output[valid_count * 4], &input[i * 4], 16);
-            valid_count++;
+        if (input[i].magic == PCAPNG_MAGIC || input[i].magic == PCAP_MAGIC) {
+            output[valid_count++] = input[i];
         }
     }
     
     return valid_count;
 }
 
+// Count Quote Update / Trade Report type bytes followed by a letter
 uint32_t _simd_extract_iex_messages(const uint8_t* udp_payload,
                                    size_t payload_length,
                                    void* output_buffer) {
-    // Simple stub - scan for IEX message types
+    (void)output_buffer;
     uint32_t message_count = 0;
     
-    for (size_t i = 0; i < payload_length - 8; i++) {
+    for (size_t i = 0; i + 8 < payload_length; i++) {
         uint8_t msg_type = udp_payload[i];
-        if (msg_type == 0x51 || msg_type == 0x54) { // Quote or Trade
+        if ((msg_type == 0x51 || msg_type == 0x54) &&   // Quote or Trade
+            udp_payload[i + 1] >= 'A' && udp_payload[i + 1] <= 'Z') {
             message_count++;
-            // Skip ahead to avoid double-counting
-            i += 32; // Skip typical message size
         }
     }
     
@@ -51,55 +50,3 @@ void _cache_optimized_chunk_processor(const void* source,
     // In real implementation, would use streaming stores and prefetching
     memcpy(destination, source, chunk_size);
 }
-
-// Additional SIMD functions needed for benchmarking
-void detect_simd_capabilities(simd_capabilities_t* caps) {
-    if (!caps) return;
-    
-    caps->has_neon = 0;
-    caps->has_avx2 = 0;
-    caps->has_avx512 = 0;
-    caps->cache_line_size = 64;
-    
-#ifdef __aarch64__
-    caps->has_neon = 1;
-#elif defined(__x86_64__)
-    caps->has_avx2 = 1; // Assume modern x86_64 has AVX2
-#endif
-}
-
-int alloc_simd_buffer(simd_memory_buffer_t* buffer, size_t size, size_t alignment) {
-    if (!buffer) return -1;
-    
-    // Align to specified boundaries for SIMD operations
-    void* ptr = NULL;
-    if (posix_memalign(&ptr, alignment > 0 ? alignment : 64, size) != 0) {
-        return -1;
-    }
-    
-    buffer->aligned_buffer = ptr;
-    buffer->buffer_size = size;
-    buffer->alignment = alignment > 0 ? alignment : 64;
-    buffer->numa_node = 0; // Default to node 0
-    
-    return 0;
-}
-
-void free_simd_buffer(simd_memory_buffer_t* buffer) {
-    if (buffer && buffer->aligned_buffer) {
-        free(buffer->aligned_buffer);
-        buffer->aligned_buffer = NULL;
-        buffer->buffer_size = 0;
-    }
-}
-
-void get_optimal_tuning_params(const simd_capabilities_t* caps, simd_tuning_params_t* params) {
-    if (!params) return;
-    
-    // Default conservative tuning parameters
-    params->batch_size = 256;
-    params->prefetch_distance = caps ? caps->cache_line_size : 64;
-    params->chunk_alignment = caps ? caps->cache_line_size : 64;
-    params->use_streaming_stores = 1;
-    params->prefetch_levels = 2;
-}
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "iex.h"
+#include "iex_tp.h"
+#include "symbol_table.h"
+#include "cpu_dispatch.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#define SYMBOL_HASH_MULTIPLIER 0x9E3779B97F4A7C15ULL
+#define SYMBOL_HASH_RUN        256
+
+int symbol_table_init(symbol_table_t *table, uint32_t max_symbols) {
+    memset(table, 0, sizeof(*table));
+    if (max_symbols == 0 || max_symbols > SYMBOL_TABLE_MAX) max_symbols = SYMBOL_TABLE_MAX;
+
+    // Keep the load factor at or below 1/2
+    uint32_t slots = 16;
+    uint32_t bits = 4;
+    while (slots < max_symbols * 2) {
+        slots <<= 1;
+        bits++;
+    }
+
+    table->slot_keys = calloc(slots, sizeof(uint64_t));
+    table->slot_ids = malloc(slots * sizeof(symbol_id_t));
+    table->symbols = malloc(max_symbols * sizeof(uint64_t));
+    if (!table->slot_keys || !table->slot_ids || !table->symbols) {
+        fprintf(stderr, "Failed to allocate symbol table\n");
+        symbol_table_free(table);
+        return -1;
+    }
+
+    table->slot_mask = slots - 1;
+    table->shift = 64 - bits;
+    table->max_symbols = max_symbols;
+    return 0;
+}
+
+void symbol_table_free(symbol_table_t *table) {
+    free(table->slot_keys);
+    free(table->slot_ids);
+    free(table->symbols);
+    memset(table, 0, sizeof(*table));
+}
+
+// Probe from a precomputed home slot
+static symbol_id_t intern_at(symbol_table_t *table, uint64_t symbol, uint32_t slot) {
+    if (symbol == SYMBOL_EMPTY_KEY) return SYMBOL_ID_INVALID;
+
+    for (;;) {
+        uint64_t key = table->slot_keys[slot];
+        if (key == symbol) return table->slot_ids[slot];
+        if (key == SYMBOL_EMPTY_KEY) break;
+        slot = (slot + 1) & table->slot_mask;
+    }
+
+    if (table->count >= table->max_symbols) return SYMBOL_ID_INVALID;
+
+    symbol_id_t id = (symbol_id_t)table->count++;
+    table->slot_keys[slot] = symbol;
+    table->slot_ids[slot] = id;
+    table->symbols[id] = symbol;
+    return id;
+}
+
+symbol_id_t symbol_table_intern(symbol_table_t *table, uint64_t symbol) {
+    return intern_at(table, symbol, symbol_table_slot(table, symbol));
+}
+
+// Home slots for a run of symbol words: symbol_table_slot() per lane
+
+static void symbol_slots_scalar(const uint64_t *symbols, uint32_t count, uint32_t shift,
+                                uint32_t *slots) {
+    for (uint32_t i = 0; i < count; i++) {
+        slots[i] = (uint32_t)((symbols[i] * SYMBOL_HASH_MULTIPLIER) >> shift);
+    }
+}
+
+#if defined(__x86_64__)
+// AVX2 has no 64-bit multiply: low 64 bits of x * k from three 32x32 products
+CPU_TARGET_AVX2
+static void symbol_slots_avx2(const uint64_t *symbols, uint32_t count, uint32_t shift,
+                              uint32_t *slots) {
+    const __m256i k_lo = _mm256_set1_epi64x(SYMBOL_HASH_MULTIPLIER & 0xFFFFFFFFULL);
+    const __m256i k_hi = _mm256_set1_epi64x(SYMBOL_HASH_MULTIPLIER >> 32);
+    const __m256i low_dwords = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+    const __m128i count_bits = _mm_cvtsi32_si128((int)shift);
+    uint32_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(symbols + i));
+        __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(x, k_hi),
+                                         _mm256_mul_epu32(_mm256_srli_epi64(x, 32), k_lo));
+        __m256i product = _mm256_add_epi64(_mm256_mul_epu32(x, k_lo),
+                                           _mm256_slli_epi64(cross, 32));
+        __m256i slot = _mm256_permutevar8x32_epi32(_mm256_srl_epi64(product, count_bits), low_dwords);
+        _mm_storeu_si128((__m128i *)(slots + i), _mm256_castsi256_si128(slot));
+    }
+    symbol_slots_scalar(symbols + i, count - i, shift, slots + i);
+}
+
+CPU_TARGET_AVX512
+static void symbol_slots_avx512(const uint64_t *symbols, uint32_t count, uint32_t shift,
+                                uint32_t *slots) {
+    const __m512i k = _mm512_set1_epi64((long long)SYMBOL_HASH_MULTIPLIER);
+    const __m128i count_bits = _mm_cvtsi32_si128((int)shift);
+    uint32_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m512i product = _mm512_mullo_epi64(_mm512_loadu_si512(symbols + i), k);
+        _mm256_storeu_si256((__m256i *)(slots + i),
+                            _mm512_cvtepi64_epi32(_mm512_srl_epi64(product, count_bits)));
+    }
+    symbol_slots_scalar(symbols + i, count - i, shift, slots + i);
+}
+#endif
+
+void symbol_table_kernels_resolve(cpu_isa_t isa, cpu_kernels_t *kernels) {
+    kernels->symbol_slots = symbol_slots_scalar;
+#if defined(__x86_64__)
+    if (isa == CPU_ISA_AVX2) kernels->symbol_slots = symbol_slots_avx2;
+    if (isa == CPU_ISA_AVX512) kernels->symbol_slots = symbol_slots_avx512;
+#else
+    (void)isa;      // NEON has no 64-bit lane multiply
+#endif
+}
+
+void symbol_table_name(const symbol_table_t *table, symbol_id_t id, char *out) {
+    uint64_t symbol = table->symbols[id];
+    memcpy(out, &symbol, 8);
+
+    int len = 8;
+    while (len > 0 && (out[len - 1] == ' ' || out[len - 1] == '\0')) len--;
+    out[len] = '\0';
+}
+
+uint32_t symbol_table_seed_segment(symbol_table_t *table, const uint8_t *udp_payload, size_t len) {
+    iex_tp_segment_t seg;
+    if (iex_tp_segment_init(&seg, udp_payload, len) != 0) return 0;
+
+    uint32_t seeded = 0;
+    const uint8_t *msg;
+    uint16_t msg_len;
+
+    while ((msg = iex_tp_next_message(&seg, &msg_len)) != NULL) {
+        if (msg[IEX_MSG_TYPE_OFFSET] != IEX_SECURITY_DIRECTORY || msg_len < IEX_LENGTH(security_directory)) continue;
+        symbol_table_intern(table, iex_msg_symbol(msg));
+        seeded++;
+    }
+
+    return seeded;
+}
+
+void symbol_table_intern_batch(symbol_table_t *table, const parsed_message_t *messages,
+                               uint32_t count, symbol_id_t *ids) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (messages[i].message_type == IEX_SECURITY_DIRECTORY) {
+            symbol_table_intern(table, messages[i].symbol_hash);
+        }
+    }
+
+    // Hash a run of symbols at once, then probe from the precomputed slots
+    uint64_t symbols[SYMBOL_HASH_RUN];
+    uint32_t slots[SYMBOL_HASH_RUN];
+
+    for (uint32_t base = 0; base < count; base += SYMBOL_HASH_RUN) {
+        uint32_t run = (count - base < SYMBOL_HASH_RUN) ? count - base : SYMBOL_HASH_RUN;
+        for (uint32_t i = 0; i < run; i++) {
+            symbols[i] = messages[base + i].symbol_hash;
+        }
+        cpu_kernels.symbol_slots(symbols, run, table->shift, slots);
+        for (uint32_t i = 0; i < run; i++) {
+            ids[base + i] = intern_at(table, symbols[i], slots[i]);
+        }
+    }
+}
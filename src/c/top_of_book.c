@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "iex.h"
+#include "top_of_book.h"
+
+#define TOB_ALIGNMENT 64
+
+static void *alloc_column(size_t bytes) {
+    void *column = NULL;
+    bytes = (bytes + TOB_ALIGNMENT - 1) & ~(size_t)(TOB_ALIGNMENT - 1);
+    if (posix_memalign(&column, TOB_ALIGNMENT, bytes) != 0) return NULL;
+
+    // Touch every page now so the hot path never takes a first-write fault
+    memset(column, 0, bytes);
+    return column;
+}
+
+int tob_book_init(tob_book_t *book, uint32_t capacity) {
+    memset(book, 0, sizeof(*book));
+
+    book->bid_price = alloc_column(capacity * sizeof(iex_price_t));
+    book->bid_size = alloc_column(capacity * sizeof(uint32_t));
+    book->ask_price = alloc_column(capacity * sizeof(iex_price_t));
+    book->ask_size = alloc_column(capacity * sizeof(uint32_t));
+    book->last_update = alloc_column(capacity * sizeof(uint64_t));
+    book->symbol = alloc_column(capacity * sizeof(uint64_t));
+
+    if (!book->bid_price || !book->bid_size || !book->ask_price ||
+        !book->ask_size || !book->last_update || !book->symbol) {
+        fprintf(stderr, "Failed to allocate top-of-book arrays\n");
+        tob_book_free(book);
+        return -1;
+    }
+
+    book->capacity = capacity;
+    return 0;
+}
+
+void tob_book_free(tob_book_t *book) {
+    free(book->bid_price);
+    free(book->bid_size);
+    free(book->ask_price);
+    free(book->ask_size);
+    free(book->last_update);
+    free(book->symbol);
+    memset(book, 0, sizeof(*book));
+}
+
+void tob_book_reset(tob_book_t *book) {
+    size_t n = book->active;
+    memset(book->bid_price, 0, n * sizeof(iex_price_t));
+    memset(book->bid_size, 0, n * sizeof(uint32_t));
+    memset(book->ask_price, 0, n * sizeof(iex_price_t));
+    memset(book->ask_size, 0, n * sizeof(uint32_t));
+    memset(book->last_update, 0, n * sizeof(uint64_t));
+    memset(book->symbol, 0, n * sizeof(uint64_t));
+    book->active = 0;
+    book->quotes_applied = 0;
+}
+
+void tob_apply_batch(tob_book_t *book, const parsed_message_t *messages,
+                     const symbol_id_t *ids, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        const parsed_message_t *msg = &messages[i];
+        if (msg->message_type != IEX_QUOTE_UPDATE) continue;
+
+        tob_apply_quote(book, ids[i], msg->symbol_hash, msg->timestamp_ns,
+                        msg->price, msg->size, msg->ask_price, msg->ask_size);
+    }
+}
+
+int tob_snapshot(const tob_book_t *book, tob_snapshot_t *snapshot) {
+    if (snapshot->capacity < book->active) return -1;
+
+    size_t n = book->active;
+    memcpy(snapshot->bid_price, book->bid_price, n * sizeof(iex_price_t));
+    memcpy(snapshot->bid_size, book->bid_size, n * sizeof(uint32_t));
+    memcpy(snapshot->ask_price, book->ask_price, n * sizeof(iex_price_t));
+    memcpy(snapshot->ask_size, book->ask_size, n * sizeof(uint32_t));
+    memcpy(snapshot->last_update, book->last_update, n * sizeof(uint64_t));
+    memcpy(snapshot->symbol, book->symbol, n * sizeof(uint64_t));
+
+    snapshot->active = book->active;
+    snapshot->quotes_applied = book->quotes_applied;
+    return 0;
+}
+
+int tob_channel_init(tob_channel_t *channel, const tob_book_t *book) {
+    memset(channel, 0, sizeof(*channel));
+    if (pthread_mutex_init(&channel->lock, NULL) != 0) return -1;
+    if (pthread_cond_init(&channel->changed, NULL) != 0) {
+        pthread_mutex_destroy(&channel->lock);
+        return -1;
+    }
+    channel->book = book;
+    atomic_init(&channel->pending, 0);
+    return 0;
+}
+
+void tob_channel_destroy(tob_channel_t *channel) {
+    pthread_cond_destroy(&channel->changed);
+    pthread_mutex_destroy(&channel->lock);
+}
+
+void tob_channel_open(tob_channel_t *channel) {
+    pthread_mutex_lock(&channel->lock);
+    channel->open = 1;
+    pthread_mutex_unlock(&channel->lock);
+}
+
+// Called with the lock held
+static void serve_locked(tob_channel_t *channel) {
+    if (!channel->target) return;
+
+    *channel->target_result = tob_snapshot(channel->book, channel->target);
+    channel->target = NULL;
+    atomic_store_explicit(&channel->pending, 0, memory_order_relaxed);
+    pthread_cond_broadcast(&channel->changed);
+}
+
+void tob_channel_serve(tob_channel_t *channel) {
+    pthread_mutex_lock(&channel->lock);
+    serve_locked(channel);
+    pthread_mutex_unlock(&channel->lock);
+}
+
+void tob_channel_close(tob_channel_t *channel) {
+    pthread_mutex_lock(&channel->lock);
+    serve_locked(channel);
+    channel->open = 0;
+    pthread_cond_broadcast(&channel->changed);
+    pthread_mutex_unlock(&channel->lock);
+}
+
+int tob_request_snapshot(tob_channel_t *channel, tob_snapshot_t *snapshot) {
+    int result = -1;
+
+    pthread_mutex_lock(&channel->lock);
+    while (channel->open && channel->target) {
+        pthread_cond_wait(&channel->changed, &channel->lock);   // one request at a time
+    }
+
+    if (!channel->open) {
+        // Nobody is writing: the book is stable while we hold the lock
+        result = tob_snapshot(channel->book, snapshot);
+    } else {
+        channel->target = snapshot;
+        channel->target_result = &result;
+        atomic_store_explicit(&channel->pending, 1, memory_order_release);
+        while (channel->target == snapshot) {
+            pthread_cond_wait(&channel->changed, &channel->lock);
+        }
+    }
+    pthread_mutex_unlock(&channel->lock);
+    return result;
+}
@@ -0,0 +1,383 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "pcap.h"
+#include "iex.h"
+#include "uring_reader.h"
+
+#ifdef __linux__
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+typedef enum {
+    BUFFER_IDLE,
+    BUFFER_INFLIGHT,
+    BUFFER_READY
+} buffer_state_t;
+
+typedef struct {
+    uint8_t *base;              // headroom + data, URING_ALIGNMENT aligned
+    uint8_t *data;              // base + URING_CARRY_SIZE
+    uint64_t file_offset;       // file position of data[0]
+    size_t wanted;              // bytes requested for this buffer
+    size_t filled;              // bytes completed so far
+    buffer_state_t state;
+} uring_buffer_t;
+
+typedef struct {
+    int ring_fd;
+    int file_fd;
+    uint64_t file_size;
+    int registered;             // buffers registered: use READ_FIXED
+    int direct;                 // file_fd was opened with O_DIRECT
+
+    // Submission queue
+    void *sq_ring;
+    size_t sq_ring_size;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+
+    // Completion queue
+    void *cq_ring;
+    size_t cq_ring_size;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+
+    uring_buffer_t buffers[URING_BUFFER_COUNT];
+    uint64_t next_read;         // next file offset to request
+} uring_reader_t;
+
+static int sys_io_uring_setup(unsigned entries, struct io_uring_params *params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int sys_io_uring_register(int fd, unsigned opcode, const void *arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static void reader_close(uring_reader_t *r) {
+    if (r->sqes) munmap(r->sqes, r->sqes_size);
+    if (r->cq_ring && r->cq_ring != r->sq_ring) munmap(r->cq_ring, r->cq_ring_size);
+    if (r->sq_ring) munmap(r->sq_ring, r->sq_ring_size);
+    if (r->ring_fd >= 0) close(r->ring_fd);
+    if (r->file_fd >= 0) close(r->file_fd);
+    for (int i = 0; i < URING_BUFFER_COUNT; i++) {
+        free(r->buffers[i].base);
+    }
+}
+
+// Returns 0, -1 on error, URING_UNAVAILABLE if the kernel refuses io_uring
+static int reader_open(uring_reader_t *r, const char *filename, int direct) {
+    memset(r, 0, sizeof(*r));
+    r->ring_fd = -1;
+    r->file_fd = -1;
+
+    if (direct) {
+        r->file_fd = open(filename, O_RDONLY | O_DIRECT);
+        if (r->file_fd == -1 && errno == EINVAL) {
+            fprintf(stderr, "O_DIRECT not supported here, using buffered reads\n");
+        }
+        r->direct = r->file_fd != -1;
+    }
+    if (r->file_fd == -1) r->file_fd = open(filename, O_RDONLY);
+    if (r->file_fd == -1) {
+        perror("open");
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(r->file_fd, &st) == -1) {
+        perror("fstat");
+        return -1;
+    }
+    r->file_size = (uint64_t)st.st_size;
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    r->ring_fd = sys_io_uring_setup(URING_BUFFER_COUNT, &params);
+    if (r->ring_fd < 0) {
+        perror("io_uring_setup");
+        return URING_UNAVAILABLE;
+    }
+
+    r->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    r->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    int single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap && r->cq_ring_size > r->sq_ring_size) r->sq_ring_size = r->cq_ring_size;
+
+    r->sq_ring = mmap(NULL, r->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      r->ring_fd, IORING_OFF_SQ_RING);
+    if (r->sq_ring == MAP_FAILED) {
+        r->sq_ring = NULL;
+        perror("mmap sq ring");
+        return -1;
+    }
+
+    if (single_mmap) {
+        r->cq_ring = r->sq_ring;
+    } else {
+        r->cq_ring = mmap(NULL, r->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          r->ring_fd, IORING_OFF_CQ_RING);
+        if (r->cq_ring == MAP_FAILED) {
+            r->cq_ring = NULL;
+            perror("mmap cq ring");
+            return -1;
+        }
+    }
+
+    r->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   r->ring_fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) {
+        r->sqes = NULL;
+        perror("mmap sqes");
+        return -1;
+    }
+
+    uint8_t *sq = r->sq_ring;
+    uint8_t *cq = r->cq_ring;
+    r->sq_head = (unsigned *)(sq + params.sq_off.head);
+    r->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    r->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+    r->sq_array = (unsigned *)(sq + params.sq_off.array);
+    r->cq_head = (unsigned *)(cq + params.cq_off.head);
+    r->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+    r->cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+    struct iovec iovecs[URING_BUFFER_COUNT];
+    for (int i = 0; i < URING_BUFFER_COUNT; i++) {
+        uring_buffer_t *buf = &r->buffers[i];
+        if (posix_memalign((void **)&buf->base, URING_ALIGNMENT,
+                           URING_CARRY_SIZE + URING_BUFFER_SIZE) != 0) {
+            buf->base = NULL;
+            fprintf(stderr, "Failed to allocate read buffers\n");
+            return -1;
+        }
+        buf->data = buf->base + URING_CARRY_SIZE;
+        iovecs[i].iov_base = buf->base;
+        iovecs[i].iov_len = URING_CARRY_SIZE + URING_BUFFER_SIZE;
+    }
+
+    // Registration pins the buffers once instead of on every read; it can
+    // fail under a low RLIMIT_MEMLOCK, which only costs that saving
+    r->registered = sys_io_uring_register(r->ring_fd, IORING_REGISTER_BUFFERS,
+                                          iovecs, URING_BUFFER_COUNT) == 0;
+    return 0;
+}
+
+// Queue a read of the remainder of buffer i
+static void queue_read(uring_reader_t *r, int i) {
+    uring_buffer_t *buf = &r->buffers[i];
+    unsigned tail = *r->sq_tail;
+    unsigned index = tail & *r->sq_mask;
+    struct io_uring_sqe *sqe = &r->sqes[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = r->registered ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe->fd = r->file_fd;
+    sqe->off = buf->file_offset + buf->filled;
+    sqe->addr = (uint64_t)(uintptr_t)(buf->data + buf->filled);
+    sqe->len = (uint32_t)(buf->wanted - buf->filled);
+    sqe->buf_index = (uint16_t)i;
+    sqe->user_data = (uint64_t)i;
+
+    r->sq_array[index] = index;
+    __atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    buf->state = BUFFER_INFLIGHT;
+}
+
+// Start the next sequential read into an idle buffer; 0 if past EOF
+static int start_buffer(uring_reader_t *r, int i) {
+    if (r->next_read >= r->file_size) return 0;
+
+    uring_buffer_t *buf = &r->buffers[i];
+    buf->file_offset = r->next_read;
+    buf->wanted = URING_BUFFER_SIZE;   // O_DIRECT wants aligned lengths; EOF shortens the read
+    buf->filled = 0;
+    r->next_read += URING_BUFFER_SIZE;
+
+    queue_read(r, i);
+    return 1;
+}
+
+// Submit queued reads and wait until buffer i is filled (or hits EOF)
+static int wait_buffer(uring_reader_t *r, int i) {
+    uring_buffer_t *buf = &r->buffers[i];
+
+    while (buf->state != BUFFER_READY) {
+        unsigned pending = *r->sq_tail - __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE);
+        if (sys_io_uring_enter(r->ring_fd, pending, 1, IORING_ENTER_GETEVENTS) < 0) {
+            if (errno == EINTR) continue;
+            perror("io_uring_enter");
+            return -1;
+        }
+
+        unsigned head = *r->cq_head;
+        while (head != __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE)) {
+            struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+            uring_buffer_t *done = &r->buffers[cqe->user_data];
+            int res = cqe->res;
+            head++;
+            __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+
+            if (res < 0) {
+                errno = -res;
+                perror("io_uring read");
+                return -1;
+            }
+
+            done->filled += (size_t)res;
+            uint64_t end = done->file_offset + done->filled;
+            if (end >= r->file_size || done->filled == done->wanted) {
+                done->state = BUFFER_READY;
+            } else if (res == 0) {
+                fprintf(stderr, "Capture ended early at offset %llu\n", (unsigned long long)end);
+                return -1;
+            } else {
+                // Short read: fetch the rest. O_DIRECT needs the offset, length
+                // and address block aligned, so re-read any partial block
+                if (r->direct) done->filled &= ~((size_t)URING_ALIGNMENT - 1);
+                queue_read(r, (int)cqe->user_data);
+            }
+        }
+    }
+
+    return 0;
+}
+
+int parse_pcap_file_uring(const char *filename, int direct, size_t *file_size) {
+    uring_reader_t reader;
+    int result = reader_open(&reader, filename, direct);
+    if (result != 0) {
+        reader_close(&reader);
+        return result;
+    }
+    *file_size = (size_t)reader.file_size;
+
+    message_pipeline_t pipeline;
+    if (start_message_delivery(&pipeline, BATCH_POOL_DEPTH) != 0) {
+        reader_close(&reader);
+        return -1;
+    }
+
+    PARSER_LOG("io_uring reader: %d x %d MB buffers%s%s\n", URING_BUFFER_COUNT,
+               URING_BUFFER_SIZE / (1024 * 1024), reader.direct ? ", O_DIRECT" : "",
+               reader.registered ? ", registered" : "");
+
+    for (int i = 0; i < URING_BUFFER_COUNT; i++) {
+        start_buffer(&reader, i);
+    }
+
+    uint64_t total_packets = 0;
+    uint64_t total_messages = 0;
+    const uint8_t *carry = NULL;        // unconsumed tail of the previous buffer
+    size_t carry_len = 0;
+    int previous = -1;
+
+    for (int i = 0; ; i = (i + 1) % URING_BUFFER_COUNT) {
+        uring_buffer_t *buf = &reader.buffers[i];
+        if (buf->state == BUFFER_IDLE) break;           // nothing left to read
+
+        if (wait_buffer(&reader, i) != 0) {
+            result = -1;
+            break;
+        }
+
+        // Stitch the straddling block in front of the new data
+        uint8_t *data = buf->data - carry_len;
+        if (carry_len) memmove(data, carry, carry_len);
+        const uint8_t *end = buf->data + buf->filled;
+
+        // The previous buffer is free once its tail has been copied
+        if (previous >= 0) {
+            reader.buffers[previous].state = BUFFER_IDLE;
+            start_buffer(&reader, previous);
+        }
+
+        if (buf->file_offset == 0) {
+            if (buf->filled < 12 || *((uint32_t *)data) != PCAPNG_MAGIC) {
+                fprintf(stderr, "io_uring reader supports pcapng captures only\n");
+                result = -1;
+                break;
+            }
+        }
+
+        const uint8_t *ptr = data;
+        while (ptr < end) {
+            message_batch_t *batch = batch_pool_acquire(&pipeline.pool);
+            const uint8_t *next = decode_pcapng_blocks(ptr, end, end, batch, &batch->packets);
+            if (next == ptr) {
+                batch_pool_release(&pipeline.pool, batch);
+                break;                                  // block continues in the next buffer
+            }
+
+            ptr = next;
+            total_packets += batch->packets;
+            total_messages += batch->count;
+            batch_pool_submit(&pipeline.pool, batch);
+        }
+
+        carry = ptr;
+        carry_len = (size_t)(end - ptr);
+        previous = i;
+
+        uint64_t consumed_to = buf->file_offset + buf->filled;
+        if (carry_len > 0 && consumed_to >= reader.file_size) {
+            fprintf(stderr, "Invalid or truncated block at offset %llu\n",
+                    (unsigned long long)(consumed_to - carry_len));
+            result = -1;
+            break;
+        }
+        if (carry_len > URING_CARRY_SIZE) {
+            fprintf(stderr, "Invalid block or block larger than %d bytes at offset %llu\n",
+                    URING_CARRY_SIZE, (unsigned long long)(consumed_to - carry_len));
+            result = -1;
+            break;
+        }
+        if (consumed_to >= reader.file_size) break;
+    }
+
+    drain_message_delivery(&pipeline);
+    PARSER_LOG("Final stats: %llu packets, %llu messages parsed\n",
+               (unsigned long long)total_packets, (unsigned long long)total_messages);
+    finish_message_delivery(&pipeline);
+
+    // Drain reads still in flight before the buffers go away
+    for (int i = 0; i < URING_BUFFER_COUNT; i++) {
+        if (reader.buffers[i].state == BUFFER_INFLIGHT) wait_buffer(&reader, i);
+    }
+
+    reader_close(&reader);
+    return result;
+}
+
+#else
+
+int parse_pcap_file_uring(const char *filename, int direct, size_t *file_size) {
+    (void)filename;
+    (void)direct;
+    (void)file_size;
+    fprintf(stderr, "io_uring reader requires Linux\n");
+    return URING_UNAVAILABLE;
+}
+
+#endif
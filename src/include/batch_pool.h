@@ -0,0 +1,55 @@
+#ifndef BATCH_POOL_H
+#define BATCH_POOL_H
+
+#include <stdint.h>
+#include "iex.h"
+#include "message_ring.h"
+
+// Pool of reusable message batches
+// All batches are allocated once, cache-line aligned, and then circulate:
+// a decoder acquires a free batch, fills it and submits it; the consumer
+// takes full batches in submission order and releases them back. Batches
+// are recycled as-is (count reset, no memset). When every batch is full or
+// in use, batch_pool_acquire() waits: that is the back-pressure keeping a
+// fast decoder from running away from a slow consumer.
+//
+// Both queues are lock-free rings. Full batches travel on an SPSC ring, so
+// acquire and submit belong to one decoding thread and next to one consumer
+// thread. Free batches return on an MPSC ring and may be released from any
+// thread.
+
+#define BATCH_POOL_DEPTH        4       // batches in flight for a single decoder
+#define BATCH_POOL_ALIGNMENT    64
+
+typedef struct {
+    message_batch_t *batches;   // one contiguous aligned allocation
+    uint32_t capacity;
+    mpsc_ring_t free_ring;
+    spsc_ring_t full_ring;
+} batch_pool_t;
+
+// Allocate capacity batches; returns 0 or -1
+int batch_pool_init(batch_pool_t *pool, uint32_t capacity);
+void batch_pool_destroy(batch_pool_t *pool);
+
+// Position of a pooled batch, for per-batch side arrays
+static inline uint32_t batch_pool_index(const batch_pool_t *pool, const message_batch_t *batch) {
+    return (uint32_t)(batch - pool->batches);
+}
+
+// Producer side: take an empty batch (waits while none is free)
+message_batch_t *batch_pool_acquire(batch_pool_t *pool);
+
+// Producer side: hand a filled batch to the consumer
+void batch_pool_submit(batch_pool_t *pool, message_batch_t *batch);
+
+// Producer side: no further submissions; the consumer drains and stops
+void batch_pool_close(batch_pool_t *pool);
+
+// Consumer side: next full batch in submission order, NULL once closed and drained
+message_batch_t *batch_pool_next(batch_pool_t *pool);
+
+// Any thread: return a batch to the free ring
+void batch_pool_release(batch_pool_t *pool, message_batch_t *batch);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef BENCH_RESULTS_H
+#define BENCH_RESULTS_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// Benchmark result files
+// Every benchmark that writes JSON starts the file with the same header so
+// runs can be archived and diffed by bench_compare: schema version, tool,
+// the git revision the binary was built from, CPU model, active kernels,
+// time of the run and every capture measured with its size and content
+// hash. The tool then writes "results", an array of objects that each have
+// a unique "name" and the raw timed samples in "seconds".
+
+#define BENCH_RESULTS_SCHEMA_VERSION    1
+
+// The Makefile passes the revision to the benchmark tools
+#ifndef BENCH_GIT_REVISION
+#define BENCH_GIT_REVISION "unknown"
+#endif
+
+// CPU model string ("unknown" if it cannot be read)
+void bench_cpu_model(char *buffer, size_t size);
+
+// FNV-1a over the capture's 8-byte words (tail zero padded), then its size
+// Returns 0, or -1 (reported) if the file cannot be read
+int bench_dataset_hash(const char *path, uint64_t *hash, uint64_t *size);
+
+// Create path and write the header, leaving "results" for the caller
+// Returns NULL (reported) if the file cannot be written or a capture hashed.
+FILE *bench_results_open(const char *path, const char *benchmark, const char *git_revision,
+                         const char *const *captures, int capture_count);
+
+// Close the top-level object; returns 0 or -1 (reported)
+int bench_results_close(FILE *out);
+
+// Quoted, escaped JSON string
+void bench_json_string(FILE *out, const char *text);
+
+#endif
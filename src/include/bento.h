@@ -0,0 +1,134 @@
+#ifndef BENTO_H
+#define BENTO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// libbento: embeddable IEX capture decoder
+// Open a pcap/pcapng capture, register callbacks per message type, run.
+// Decoding uses the same mmap block walk, parallel partitioning and batch
+// pipeline as pcap_parser; callbacks are invoked on a single delivery
+// thread, strictly in capture order, whatever the decode thread count.
+//
+// Only one bento_run() may be active per process at a time: the decoder's
+// message filter, progress output and consumer registry are process-wide.
+// Captures may be opened and configured from any thread, but runs on
+// different captures must be serialized; a run started while another is
+// active returns BENTO_ERR_BUSY without touching either.
+//
+// This header is self-contained and is the whole public interface. Prices
+// are signed 64-bit fixed point in 1/10000 dollars, as IEX publishes them.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BENTO_API_VERSION           4     // 2: 64-bit prices, 3: BENTO_ERR_BUSY, 4: book snapshots
+
+// bento_run() result when another run is active in the process
+#define BENTO_ERR_BUSY              (-2)
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BENTO_API __attribute__((visibility("default")))
+#else
+#define BENTO_API
+#endif
+
+// Message type byte (IEX TOPS 1.6 / DEEP 1.0)
+#define BENTO_SYSTEM_EVENT          0x53
+#define BENTO_SECURITY_DIRECTORY    0x44
+#define BENTO_TRADING_STATUS        0x48
+#define BENTO_OPERATIONAL_HALT      0x4F
+#define BENTO_SHORT_SALE_PRICE      0x50
+#define BENTO_QUOTE_UPDATE          0x51
+#define BENTO_TRADE_REPORT          0x54
+#define BENTO_OFFICIAL_PRICE        0x58
+#define BENTO_TRADE_BREAK           0x42
+#define BENTO_AUCTION_INFO          0x41
+#define BENTO_SECURITY_EVENT        0x45    // DEEP only
+#define BENTO_PRICE_LEVEL_BUY       0x38
+#define BENTO_PRICE_LEVEL_SELL      0x35
+
+// One decoded message (same layout as the parser's internal record)
+typedef struct {
+    uint64_t timestamp_ns;      // nanoseconds since the POSIX epoch
+    uint64_t symbol;            // 8 space-padded ASCII bytes as one word; 0 if none
+    int64_t  price;             // trade/level/official price; bid price for quotes
+    uint32_t size;              // trade/level size; bid size for quotes
+    uint8_t  message_type;      // BENTO_* type byte
+    uint8_t  side;              // 'B' / 'S' for price levels
+    int64_t  ask_price;         // quotes only
+    uint32_t ask_size;          // quotes only
+    uint8_t  flags;             // raw flags byte (sale conditions, DEEP event flags)
+} __attribute__((packed)) bento_message_t;
+
+typedef struct {
+    uint64_t packets;
+    uint64_t messages;
+} bento_stats_t;
+
+// Top of book of one symbol, as set by its latest Quote Update
+typedef struct {
+    uint64_t symbol;
+    uint64_t timestamp_ns;      // of the quote
+    int64_t  bid_price;         // 0 when the side is empty
+    int64_t  ask_price;
+    uint32_t bid_size;
+    uint32_t ask_size;
+} bento_quote_t;
+
+typedef struct bento_capture bento_capture_t;
+
+typedef void (*bento_message_fn)(void *user, const bento_message_t *message);
+typedef void (*bento_batch_fn)(void *user, const bento_message_t *messages, uint32_t count);
+
+// Map a capture; NULL on error (reported on stderr)
+BENTO_API bento_capture_t *bento_open(const char *path);
+BENTO_API void bento_close(bento_capture_t *capture);
+
+// Call fn for every message of one type (fn NULL removes it)
+BENTO_API int bento_on(bento_capture_t *capture, uint8_t message_type,
+                       bento_message_fn fn, void *user);
+
+// Call fn for every message whose type has no callback of its own
+BENTO_API int bento_on_any(bento_capture_t *capture, bento_message_fn fn, void *user);
+
+// Call fn once per decoded batch, before any per-message callback
+BENTO_API int bento_on_batch(bento_capture_t *capture, bento_batch_fn fn, void *user);
+
+// Decode only one message family: "all" (default), "trades", "quotes",
+// "depth" or "book". Each is a separately compiled decode loop that skips
+// other messages by length alone. Returns 0, or -1 for an unknown name.
+BENTO_API int bento_set_filter(bento_capture_t *capture, const char *filter);
+
+// Print pcap_parser's progress output while running (off by default)
+BENTO_API void bento_set_verbose(bento_capture_t *capture, int verbose);
+
+// Decode the whole capture on threads decode threads (pcapng only for > 1)
+// Returns 0, -1 on error, or BENTO_ERR_BUSY if another run is active in
+// this process. May be called again to replay the capture.
+BENTO_API int bento_run(bento_capture_t *capture, int threads);
+
+// Keep a top-of-book of every quoted symbol during runs (off by default)
+// Costs about 5 MB per capture; must not be called while the capture runs.
+BENTO_API int bento_track_book(bento_capture_t *capture, int enable);
+
+// Copy the tracked book into quotes, one entry per quoted symbol, at most
+// max of them. May be called from any thread, including a callback: during
+// a run it waits for the delivery thread's next batch boundary, so the book
+// is always the market after a whole number of batches in capture order.
+// After a run it returns the closing book. Returns the number of quoted
+// symbols (which may exceed max), or -1 if the book is not tracked.
+BENTO_API int bento_book_snapshot(bento_capture_t *capture, bento_quote_t *quotes, uint32_t max);
+
+// Packets and messages delivered by the last run
+BENTO_API void bento_get_stats(const bento_capture_t *capture, bento_stats_t *stats);
+
+// Ticker text of a symbol word, padding removed (out needs 9 bytes)
+BENTO_API void bento_symbol_text(uint64_t symbol, char *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef BENTO_HPP
+#define BENTO_HPP
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "bento.h"
+
+// Header-only C++ front end for libbento
+// A visitor is any class with on_* member functions; deriving from
+// bento::visitor<Derived> supplies empty defaults for the ones it leaves
+// out. capture::run() registers a single batch callback instantiated for
+// the visitor type, so the per-message switch and every handler call are
+// resolved at compile time and can be inlined into one loop per batch.
+//
+//     struct vwap : bento::visitor<vwap> {
+//         int64_t notional = 0, volume = 0;
+//         void on_trade(const bento::message &m) {
+//             notional += m.price * m.size;
+//             volume += m.size;
+//         }
+//     };
+//
+//     bento::capture capture("day.pcap");
+//     vwap v;
+//     capture.run(v, 8);
+//
+// Handlers run on the delivery thread in capture order and must not throw.
+// As in bento.h, only one run may be active per process at a time.
+
+namespace bento {
+
+typedef bento_message_t message;
+typedef bento_stats_t stats;
+typedef bento_quote_t quote;
+
+template <class Derived>
+struct visitor {
+    void on_quote(const message &) {}
+    void on_trade(const message &) {}
+    void on_trade_break(const message &) {}
+    void on_price_level(const message &) {}
+    void on_official_price(const message &) {}
+    void on_auction(const message &) {}
+    void on_security_directory(const message &) {}
+    void on_trading_status(const message &) {}
+    void on_system_event(const message &) {}
+    void on_other(const message &) {}
+};
+
+template <class Visitor>
+inline void dispatch(Visitor &v, const message &m) {
+    switch (m.message_type) {
+        case BENTO_QUOTE_UPDATE:        v.on_quote(m); break;
+        case BENTO_TRADE_REPORT:        v.on_trade(m); break;
+        case BENTO_TRADE_BREAK:         v.on_trade_break(m); break;
+        case BENTO_PRICE_LEVEL_BUY:
+        case BENTO_PRICE_LEVEL_SELL:    v.on_price_level(m); break;
+        case BENTO_OFFICIAL_PRICE:      v.on_official_price(m); break;
+        case BENTO_AUCTION_INFO:        v.on_auction(m); break;
+        case BENTO_SECURITY_DIRECTORY:  v.on_security_directory(m); break;
+        case BENTO_TRADING_STATUS:
+        case BENTO_OPERATIONAL_HALT:
+        case BENTO_SHORT_SALE_PRICE:    v.on_trading_status(m); break;
+        case BENTO_SYSTEM_EVENT:        v.on_system_event(m); break;
+        default:                        v.on_other(m); break;
+    }
+}
+
+inline std::string symbol(const message &m) {
+    char text[9];
+    bento_symbol_text(m.symbol, text);
+    return std::string(text);
+}
+
+class capture {
+public:
+    explicit capture(const std::string &path) : handle_(bento_open(path.c_str())) {
+        if (!handle_) throw std::runtime_error("bento: cannot open " + path);
+    }
+    ~capture() { bento_close(handle_); }
+
+    capture(const capture &) = delete;
+    capture &operator=(const capture &) = delete;
+
+    void set_verbose(bool verbose) { bento_set_verbose(handle_, verbose ? 1 : 0); }
+
+    // Restrict decoding to one message family ("trades", "quotes", "depth", "book", "all")
+    void set_filter(const char *filter) {
+        if (bento_set_filter(handle_, filter) != 0) {
+            throw std::invalid_argument(std::string("bento: unknown filter ") + filter);
+        }
+    }
+
+    // Decode the capture on threads decode threads, feeding every message to v
+    // Throws std::logic_error if another run is active in the process
+    template <class Visitor>
+    void run(Visitor &v, int threads = 1) {
+        bento_on_batch(handle_, &batch_thunk<Visitor>, &v);
+        int result = bento_run(handle_, threads);
+        bento_on_batch(handle_, nullptr, nullptr);
+        if (result == BENTO_ERR_BUSY) throw std::logic_error("bento: another run is active");
+        if (result != 0) throw std::runtime_error("bento: decode failed");
+    }
+
+    // Keep a top-of-book during runs; call before run()
+    void track_book(bool enable = true) {
+        if (bento_track_book(handle_, enable ? 1 : 0) != 0) {
+            throw std::runtime_error("bento: cannot track the book");
+        }
+    }
+
+    // Quoted symbols' top of book; safe from any thread, including mid-run
+    std::vector<quote> book_snapshot() {
+        std::vector<quote> quotes(256);
+        for (;;) {
+            int n = bento_book_snapshot(handle_, quotes.data(), (uint32_t)quotes.size());
+            if (n < 0) throw std::logic_error("bento: book not tracked");
+            if ((size_t)n <= quotes.size()) {
+                quotes.resize(n);
+                return quotes;
+            }
+            quotes.resize(n);
+        }
+    }
+
+    stats last_stats() const {
+        stats s;
+        bento_get_stats(handle_, &s);
+        return s;
+    }
+
+    bento_capture_t *handle() { return handle_; }
+
+private:
+    template <class Visitor>
+    static void batch_thunk(void *user, const message *messages, uint32_t count) {
+        Visitor &v = *static_cast<Visitor *>(user);
+        for (uint32_t i = 0; i < count; i++) dispatch(v, messages[i]);
+    }
+
+    bento_capture_t *handle_;
+};
+
+} // namespace bento
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef CONSUMERS_H
+#define CONSUMERS_H
+
+#include "message_bus.h"
+
+// Stock consumers for the message bus
+// Each register_* call allocates the consumer's state and attaches it to
+// the next run; the state is released after its end-of-stream report.
+
+// Top-of-book and DEEP depth book; reports the busiest symbol's closing book
+int register_book_builder(void);
+
+// Ask the book builder to log the market after its current batch
+// Async-signal-safe; pcap_parser calls it on SIGUSR1.
+void book_builder_request_report(void);
+
+// Per-symbol trade volume and VWAP
+int register_trade_aggregator(void);
+
+// Decoded messages as packed parsed_message_t records (host byte order)
+int register_message_writer(const char *path);
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef CPU_DISPATCH_H
+#define CPU_DISPATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "iex.h"
+#include "iex_tp.h"
+#include "simd_optimizer.h"
+
+// Runtime CPU dispatch
+// The build targets the baseline ISA (x86-64 or ARMv8), so one binary runs
+// on every host. The hot kernels are compiled once per instruction set with
+// target attributes, and a single table of function pointers is filled from
+// detect_simd_capabilities before main() runs. Every variant returns exactly
+// what the scalar one does: forcing a lower ISA changes speed, not output.
+
+typedef enum {
+    CPU_ISA_SCALAR,
+    CPU_ISA_SSE42,
+    CPU_ISA_AVX2,
+    CPU_ISA_AVX512,         // F + DQ
+    CPU_ISA_NEON,
+    CPU_ISA_COUNT
+} cpu_isa_t;
+
+#if defined(__x86_64__)
+#define CPU_TARGET_SSE42    __attribute__((target("sse4.2,popcnt")))
+#define CPU_TARGET_AVX2     __attribute__((target("avx2,popcnt")))
+#define CPU_TARGET_AVX512   __attribute__((target("avx512f,avx512dq,avx2,popcnt")))
+#elif defined(__aarch64__)
+// CRC32 is optional in ARMv8.0: only call these when has_crc32 is set
+#if defined(__clang__)
+#define CPU_TARGET_CRC      __attribute__((target("crc")))
+#else
+#define CPU_TARGET_CRC      __attribute__((target("+crc")))
+#endif
+#endif
+
+typedef struct {
+    cpu_isa_t isa;
+
+    // Block walk: first 4-byte aligned word equal to value in [from, end)
+    // (end if none); pcapng_resync uses it to find EPB candidates
+    const uint8_t *(*find_word)(const uint8_t *from, const uint8_t *end, uint32_t value);
+
+    // Message framing and filtering: segment decoders by IEX_FILTER_INDEX_*
+    iex_segment_decoder_fn decode_segment[IEX_FILTER_COUNT];
+
+    // Symbol hash: symbol_table_slot() for a run of symbol words
+    void (*symbol_slots)(const uint64_t *symbols, uint32_t count, uint32_t shift,
+                         uint32_t *slots);
+
+    // Price conversion and column scans (price_kernels.h)
+    void (*price_to_double)(const iex_price_t *prices, double *dollars, size_t count);
+    size_t (*price_range)(const iex_price_t *prices, size_t count,
+                          iex_price_t *min, iex_price_t *max);
+    size_t (*price_count_crossed)(const iex_price_t *bids, const iex_price_t *asks,
+                                  size_t count);
+
+    // Quote/trade field extraction (simd_optimizer.h)
+    uint32_t (*records)(const uint8_t *data, size_t length, uint8_t type,
+                        simd_iex_message_t *out, uint32_t max);
+    void (*quote_columns)(const uint8_t *data, const uint64_t *offsets, uint32_t count,
+                          simd_quote_columns_t *columns);
+    void (*trade_columns)(const uint8_t *data, const uint64_t *offsets, uint32_t count,
+                          simd_trade_columns_t *columns);
+
+    // CRC32C of symbol words (simd_hash_symbols)
+    void (*symbol_hashes)(const uint64_t *symbols, uint32_t *hashes, size_t count);
+} cpu_kernels_t;
+
+// Active kernels: the best supported set, unless forced
+extern cpu_kernels_t cpu_kernels;
+
+// "scalar", "sse4.2", "avx2", "avx512" or "neon"
+const char *cpu_isa_name(cpu_isa_t isa);
+
+int cpu_isa_supported(cpu_isa_t isa);
+cpu_isa_t cpu_isa_best(void);
+
+// Fill cpu_kernels for isa (which must be supported)
+void cpu_dispatch_select(cpu_isa_t isa);
+
+// --force-isa: select an ISA by name; -1 (reported) if unknown or unsupported
+int cpu_dispatch_force(const char *name);
+
+// Each kernel module fills its own entries, falling back to its best
+// variant below isa
+void pcapng_kernels_resolve(cpu_isa_t isa, cpu_kernels_t *kernels);
+void iex_tp_kernels_resolve(cpu_isa_t isa, cpu_kernels_t *kernels);
+void symbol_table_kernels_resolve(cpu_isa_t isa, cpu_kernels_t *kernels);
+void price_kernels_resolve(cpu_isa_t isa, cpu_kernels_t *kernels);
+void simd_kernels_resolve(cpu_isa_t isa, cpu_kernels_t *kernels);
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef DEPTH_BOOK_H
+#define DEPTH_BOOK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "iex.h"
+#include "symbol_table.h"
+
+// IEX DEEP price-level book
+// Each symbol side is one contiguous array of levels sorted worst to best,
+// so the touch sits at the end and the common near-touch update moves only
+// a few entries. Arrays come from a pooled allocator with power-of-two size
+// classes (levels are 16 bytes, so the smallest class of 8 levels is two
+// cache lines); a side that outgrows its block moves to the next class and
+// its old block is recycled, so a warmed up replay performs no heap
+// allocation.
+//
+// DEEP groups the updates of one matching event: only the last carries the
+// event-complete flag. Updates are staged until that flag arrives and are
+// then applied together, so a snapshot never shows a half-applied event.
+
+#define DEPTH_MIN_LEVELS        8
+#define DEPTH_SIZE_CLASSES      13          // 8 .. 32768 levels per side
+#define DEPTH_MAX_LEVELS        (DEPTH_MIN_LEVELS << (DEPTH_SIZE_CLASSES - 1))
+#define DEPTH_POOL_SLAB_SIZE    (1024 * 1024)
+#define DEPTH_STAGING_CAPACITY  4096        // updates of unfinished events
+
+typedef struct {
+    iex_price_t price;
+    uint32_t size;
+} depth_level_t;
+
+typedef struct {
+    depth_level_t *levels;      // worst .. best
+    uint32_t count;
+    uint8_t size_class;         // capacity = DEPTH_MIN_LEVELS << size_class
+} depth_side_t;
+
+typedef struct {
+    depth_side_t bids;
+    depth_side_t asks;
+    uint64_t last_update;       // timestamp of the last completed event
+} depth_symbol_t;
+
+typedef struct {
+    symbol_id_t id;
+    uint8_t side;               // 'B' or 'S'
+    iex_price_t price;
+    uint32_t size;
+    uint64_t timestamp;
+} depth_staged_update_t;
+
+typedef struct {
+    void *free_lists[DEPTH_SIZE_CLASSES];
+    void **slabs;               // every slab, for release
+    size_t slab_count;
+    size_t slab_capacity;
+    uint8_t *cursor;            // unused tail of the newest slab
+    size_t cursor_remaining;
+} depth_pool_t;
+
+typedef struct {
+    depth_symbol_t *symbols;    // indexed by symbol_id_t
+    uint32_t capacity;
+    depth_pool_t pool;
+    depth_staged_update_t *staged;
+    uint32_t staged_count;
+    uint64_t updates_applied;
+    uint64_t events_completed;
+    uint64_t updates_dropped;   // level arrays full or allocation failed
+    uint64_t events_crossed;    // events leaving best bid >= best ask
+} depth_book_t;
+
+int depth_book_init(depth_book_t *book, uint32_t capacity);
+void depth_book_free(depth_book_t *book);
+
+// Stage or apply one price level update (size 0 removes the level)
+void depth_apply_update(depth_book_t *book, symbol_id_t id, uint8_t side,
+                        iex_price_t price, uint32_t size, uint64_t timestamp, uint8_t flags);
+
+// Apply every price level update of a decoded batch (ids as from
+// symbol_table_intern_batch); other message types are ignored
+void depth_apply_batch(depth_book_t *book, const parsed_message_t *messages,
+                       const symbol_id_t *ids, uint32_t count);
+
+// Copy up to max_levels per side, best first; returns levels written per side
+// through bid_count/ask_count. Staged (unfinished) updates are never visible.
+void depth_snapshot(const depth_book_t *book, symbol_id_t id, uint32_t max_levels,
+                    depth_level_t *bids, uint32_t *bid_count,
+                    depth_level_t *asks, uint32_t *ask_count);
+
+#endif
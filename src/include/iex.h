@@ -14,47 +14,71 @@
 #define IEX_OFFICIAL_PRICE      0x58
 #define IEX_TRADE_BREAK         0x42
 #define IEX_AUCTION_INFO        0x41
+#define IEX_SECURITY_EVENT      0x45    // DEEP only
 
-typedef struct {
-    uint8_t  message_type;
-    uint32_t timestamp;
-    uint64_t symbol;  // 8-byte symbol (padded)
-} __attribute__((packed)) iex_message_header_t;
+// DEEP 1.0 price level updates
+#define IEX_PRICE_LEVEL_BUY     0x38
+#define IEX_PRICE_LEVEL_SELL    0x35
 
-typedef struct {
-    iex_message_header_t header;
-    uint32_t bid_price;
-    uint32_t bid_size;
-    uint32_t ask_price;
-    uint32_t ask_size;
-} __attribute__((packed)) iex_quote_update_t;
+// Wire layouts of all of the above are generated in iex_schema.h
 
-typedef struct {
-    iex_message_header_t header;
-    uint32_t price;
-    uint32_t size;
-    uint8_t  side;  // 'B' or 'S'
-} __attribute__((packed)) iex_trade_report_t;
+// Fixed-point price: signed 1/10000 dollars, exactly as on the wire
+// Prices stay integers through decoding, books and analytics; only text
+// output turns them into decimals, and without going through a double.
+typedef int64_t iex_price_t;
+
+#define IEX_PRICE_SCALE         10000
+#define IEX_PRICE_TEXT_MAX      24      // "-922337203685477.5808" and NUL
+
+// Exact decimal text of a price, always 4 places ("-12.3400"); returns text
+static inline char *iex_price_text(iex_price_t price, char *text) {
+    uint64_t magnitude = price < 0 ? 0 - (uint64_t)price : (uint64_t)price;
+    char digits[IEX_PRICE_TEXT_MAX];
+    int n = 0;
+
+    for (int i = 0; i < 4; i++) {
+        digits[n++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    }
+    digits[n++] = '.';
+    do {
+        digits[n++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (price < 0) digits[n++] = '-';
+
+    for (int i = 0; i < n; i++) text[i] = digits[n - 1 - i];
+    text[n] = '\0';
+    return text;
+}
 
 // High-performance output structures
 typedef struct {
     uint64_t timestamp_ns;
     uint64_t symbol_hash;
-    uint32_t price;
+    iex_price_t price;
     uint32_t size;
     uint8_t  message_type;
     uint8_t  side;
+    iex_price_t ask_price;  // quote updates only: price/size above are the bid
+    uint32_t ask_size;
+    uint8_t  flags;         // raw message flags byte (DEEP event flags, quote flags)
 } __attribute__((packed)) parsed_message_t;
 
 #define MAX_MESSAGES_PER_CHUNK 100000
 
+// Padded to whole cache lines, so every batch of a pool array starts on
+// its own line and two batches never share one
 typedef struct {
     parsed_message_t messages[MAX_MESSAGES_PER_CHUNK];
     uint32_t count;
     uint64_t total_processed;
-} message_batch_t;
+    uint64_t packets;       // packets decoded into this batch
+} __attribute__((aligned(64))) message_batch_t;
 
-// Assembly parsing functions
+// Assembly parsing functions (src/asm/<arch>)
+// data points at the message type byte; on x86-64 the record matches the
+// decoder's (see pcap.h for the arm64 routines)
 extern void parse_iex_quote_asm(const uint8_t *data, parsed_message_t *output);
 extern void parse_iex_trade_asm(const uint8_t *data, parsed_message_t *output);
 extern uint64_t hash_symbol_asm(const uint8_t *symbol);
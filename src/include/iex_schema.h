@@ -0,0 +1,269 @@
+#ifndef IEX_SCHEMA_H
+#define IEX_SCHEMA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "iex.h"
+
+// IEX TOPS 1.6 / DEEP 1.0 message schemas
+// Every message layout is declared once, as a field table, and each feed
+// version lists the messages it carries. The packed structs, length and
+// type constants, field accessors, printers and the segment decoder's
+// dispatch are all expanded from these tables, so an offset is written in
+// exactly one place. Integers are little endian, prices are signed 8-byte
+// values in 1/10000 dollars, and every message starts with its type byte.
+//
+// A field is F(message, type, name, kind); kind selects the printer.
+
+// Common prefix: type(1) flags(1) timestamp(8) [symbol(8)]
+// flags is the message-specific second byte: sale condition, event code,
+// status, price type, auction type or DEEP event flags.
+#define IEX_FIELDS_PREFIX(F, m)                 \
+    F(m, uint8_t,  message_type, type)          \
+    F(m, uint8_t,  flags,        code)          \
+    F(m, uint64_t, timestamp,    time)
+
+#define IEX_FIELDS_HEADER(F, m)                 \
+    IEX_FIELDS_PREFIX(F, m)                     \
+    F(m, uint64_t, symbol,       symbol)
+
+#define IEX_FIELDS_system_event(F, m)           \
+    IEX_FIELDS_PREFIX(F, m)
+
+#define IEX_FIELDS_security_directory(F, m)     \
+    IEX_FIELDS_HEADER(F, m)                     \
+    F(m, uint32_t, round_lot_size,     count)   \
+    F(m, int64_t,  adjusted_poc_price, price)   \
+    F(m, uint8_t,  luld_tier,          byte)
+
+#define IEX_FIELDS_trading_status(F, m)         \
+    IEX_FIELDS_HEADER(F, m)                     \
+    F(m, uint32_t, reason,             text)
+
+#define IEX_FIELDS_operational_halt(F, m)       \
+    IEX_FIELDS_HEADER(F, m)
+
+#define IEX_FIELDS_short_sale_price(F, m)       \
+    IEX_FIELDS_HEADER(F, m)                     \
+    F(m, uint8_t,  detail,             code)
+
+#define IEX_FIELDS_security_event(F, m)         \
+    IEX_FIELDS_HEADER(F, m)
+
+#define IEX_FIELDS_quote_update(F, m)           \
+    IEX_FIELDS_HEADER(F, m)                     \
+    F(m, uint32_t, bid_size,           count)   \
+    F(m, int64_t,  bid_price,          price)   \
+    F(m, int64_t,  ask_price,          price)   \
+    F(m, uint32_t, ask_size,           count)
+
+#define IEX_FIELDS_trade_report(F, m)           \
+    IEX_FIELDS_HEADER(F, m)                     \
+    F(m, uint32_t, size,               count)   \
+    F(m, int64_t,  price,              price)   \
+    F(m, uint64_t, trade_id,           id)
+
+#define IEX_FIELDS_trade_break IEX_FIELDS_trade_report
+
+#define IEX_FIELDS_official_price(F, m)         \
+    IEX_FIELDS_HEADER(F, m)                     \
+    F(m, int64_t,  price,              price)
+
+#define IEX_FIELDS_auction_info(F, m)                   \
+    IEX_FIELDS_HEADER(F, m)                             \
+    F(m, uint32_t, paired_shares,              count)   \
+    F(m, int64_t,  reference_price,            price)   \
+    F(m, int64_t,  indicative_clearing_price,  price)   \
+    F(m, uint32_t, imbalance_shares,           count)   \
+    F(m, uint8_t,  imbalance_side,             code)    \
+    F(m, uint8_t,  extension_number,           byte)    \
+    F(m, uint32_t, scheduled_auction_time,     count)   \
+    F(m, int64_t,  auction_book_clearing_price, price)  \
+    F(m, int64_t,  collar_reference_price,     price)   \
+    F(m, int64_t,  lower_auction_collar,       price)   \
+    F(m, int64_t,  upper_auction_collar,       price)
+
+#define IEX_FIELDS_price_level_buy(F, m)        \
+    IEX_FIELDS_HEADER(F, m)                     \
+    F(m, uint32_t, size,               count)   \
+    F(m, int64_t,  price,              price)
+
+#define IEX_FIELDS_price_level_sell IEX_FIELDS_price_level_buy
+
+// Every layout once: M(name, type byte, length from the specification)
+#define IEX_MESSAGES(M)                                         \
+    M(system_event,       IEX_SYSTEM_EVENT,       10)           \
+    M(security_directory, IEX_SECURITY_DIRECTORY, 31)           \
+    M(trading_status,     IEX_TRADING_STATUS,     22)           \
+    M(operational_halt,   IEX_OPERATIONAL_HALT,   18)           \
+    M(short_sale_price,   IEX_SHORT_SALE_PRICE,   19)           \
+    M(security_event,     IEX_SECURITY_EVENT,     18)           \
+    M(quote_update,       IEX_QUOTE_UPDATE,       42)           \
+    M(trade_report,       IEX_TRADE_REPORT,       38)           \
+    M(trade_break,        IEX_TRADE_BREAK,        38)           \
+    M(official_price,     IEX_OFFICIAL_PRICE,     26)           \
+    M(auction_info,       IEX_AUCTION_INFO,       80)           \
+    M(price_level_buy,    IEX_PRICE_LEVEL_BUY,    30)           \
+    M(price_level_sell,   IEX_PRICE_LEVEL_SELL,   30)
+
+// Messages carried by each feed version
+#define IEX_TOPS_1_6_MESSAGES(V)                                \
+    V(system_event) V(security_directory) V(trading_status)     \
+    V(operational_halt) V(short_sale_price) V(quote_update)     \
+    V(trade_report) V(official_price) V(trade_break)            \
+    V(auction_info)
+
+#define IEX_DEEP_1_0_MESSAGES(V)                                \
+    V(system_event) V(security_directory) V(trading_status)     \
+    V(operational_halt) V(short_sale_price) V(security_event)   \
+    V(price_level_buy) V(price_level_sell) V(trade_report)      \
+    V(official_price) V(trade_break) V(auction_info)
+
+// Generated per message: iex_<name>_t, IEX_TYPE(name), IEX_LENGTH(name)
+// and one accessor iex_<name>_<field>(msg) per field. Accessors are a
+// fixed-offset unaligned load; callers check the length once up front.
+#define IEX_TYPE(name)      iex_##name##_type
+#define IEX_LENGTH(name)    iex_##name##_length
+
+#define IEX_SCHEMA_MEMBER(m, type_, field, kind) type_ field;
+
+#define IEX_SCHEMA_ACCESSOR(m, type_, field, kind)                          \
+    static inline type_ iex_##m##_##field(const uint8_t *msg) {             \
+        type_ v;                                                            \
+        memcpy(&v, msg + offsetof(iex_##m##_t, field), sizeof(v));          \
+        return v;                                                           \
+    }
+
+#define IEX_SCHEMA_LAYOUT(name, type_, length)                              \
+    typedef struct {                                                        \
+        IEX_FIELDS_##name(IEX_SCHEMA_MEMBER, name)                          \
+    } __attribute__((packed)) iex_##name##_t;                               \
+    enum { IEX_TYPE(name) = (type_), IEX_LENGTH(name) = (length) };         \
+    _Static_assert(sizeof(iex_##name##_t) == (length), "iex_" #name "_t layout"); \
+    IEX_FIELDS_##name(IEX_SCHEMA_ACCESSOR, name)
+
+// Symbol-carrying prefix shared by everything but system events
+typedef struct {
+    IEX_FIELDS_HEADER(IEX_SCHEMA_MEMBER, message_header)
+} __attribute__((packed)) iex_message_header_t;
+IEX_FIELDS_HEADER(IEX_SCHEMA_ACCESSOR, message_header)
+
+IEX_MESSAGES(IEX_SCHEMA_LAYOUT)
+
+// Feed versions, selected by the IEX-TP message protocol ID
+// Types sit in 0x20..0x5F, one bit each in a 64-bit mask.
+#define IEX_TYPE_BIT(type) (1ULL << ((type) - 0x20))
+#define IEX_SCHEMA_TYPE_BIT(name) | IEX_TYPE_BIT(IEX_TYPE(name))
+
+#define IEX_TP_PROTOCOL_TOPS    0x8003
+#define IEX_TP_PROTOCOL_DEEP    0x8004
+
+#define IEX_TOPS_1_6_TYPES  (0 IEX_TOPS_1_6_MESSAGES(IEX_SCHEMA_TYPE_BIT))
+#define IEX_DEEP_1_0_TYPES  (0 IEX_DEEP_1_0_MESSAGES(IEX_SCHEMA_TYPE_BIT))
+#define IEX_SCHEMA_ALL_TYPES (IEX_TOPS_1_6_TYPES | IEX_DEEP_1_0_TYPES)
+
+// Message types valid in a feed; unknown protocol IDs accept every layout
+static inline uint64_t iex_schema_types(uint16_t protocol_id) {
+    switch (protocol_id) {
+        case IEX_TP_PROTOCOL_TOPS: return IEX_TOPS_1_6_TYPES;
+        case IEX_TP_PROTOCOL_DEEP: return IEX_DEEP_1_0_TYPES;
+        default:                    return IEX_SCHEMA_ALL_TYPES;
+    }
+}
+
+static inline const char *iex_schema_name(uint16_t protocol_id) {
+    switch (protocol_id) {
+        case IEX_TP_PROTOCOL_TOPS: return "TOPS 1.6";
+        case IEX_TP_PROTOCOL_DEEP: return "DEEP 1.0";
+        default:                    return "unknown";
+    }
+}
+
+// Schema name of a message type ("unknown" if none)
+static inline const char *iex_message_name(uint8_t type) {
+    switch (type) {
+#define IEX_SCHEMA_NAME_CASE(name, type_, length) case (type_): return #name;
+        IEX_MESSAGES(IEX_SCHEMA_NAME_CASE)
+#undef IEX_SCHEMA_NAME_CASE
+        default: return "unknown";
+    }
+}
+
+// Printers: one " field=value" per field, by kind
+static inline void iex_print_type(FILE *out, const char *field, uint8_t v) {
+    (void)out; (void)field; (void)v;    // already named by the message
+}
+
+static inline void iex_print_code(FILE *out, const char *field, uint8_t v) {
+    if (v >= 0x21 && v <= 0x7E) fprintf(out, " %s=%c", field, v);
+    else fprintf(out, " %s=0x%02x", field, v);
+}
+
+static inline void iex_print_byte(FILE *out, const char *field, uint8_t v) {
+    fprintf(out, " %s=%u", field, v);
+}
+
+static inline void iex_print_count(FILE *out, const char *field, uint32_t v) {
+    fprintf(out, " %s=%u", field, v);
+}
+
+static inline void iex_print_id(FILE *out, const char *field, uint64_t v) {
+    fprintf(out, " %s=%llu", field, (unsigned long long)v);
+}
+
+static inline void iex_print_time(FILE *out, const char *field, uint64_t v) {
+    fprintf(out, " %s=%llu", field, (unsigned long long)v);
+}
+
+static inline void iex_print_price(FILE *out, const char *field, int64_t v) {
+    char text[IEX_PRICE_TEXT_MAX];
+    fprintf(out, " %s=%s", field, iex_price_text(v, text));
+}
+
+static inline void iex_print_symbol(FILE *out, const char *field, uint64_t v) {
+    char text[9];
+    memcpy(text, &v, 8);
+    int len = 8;
+    while (len > 0 && (text[len - 1] == ' ' || text[len - 1] == '\0')) len--;
+    fprintf(out, " %s=%.*s", field, len, text);
+}
+
+static inline void iex_print_text(FILE *out, const char *field, uint32_t v) {
+    char text[4];
+    memcpy(text, &v, 4);
+    int len = 4;
+    while (len > 0 && (text[len - 1] == ' ' || text[len - 1] == '\0')) len--;
+    fprintf(out, " %s=%.*s", field, len, text);
+}
+
+#define IEX_SCHEMA_PRINT_FIELD(m, type_, field, kind) \
+    iex_print_##kind(out, #field, iex_##m##_##field(msg));
+
+// Print one framed message as "<name> field=value ..." on its own line
+// Returns 0, or -1 (nothing printed) if the type is not part of the feed
+// version or the message is shorter than its layout.
+static inline int iex_print_message(FILE *out, const uint8_t *msg, uint16_t len,
+                                    uint16_t protocol_id) {
+    uint8_t type = msg[0];
+    if (type < 0x20 || type > 0x5F || !(iex_schema_types(protocol_id) & IEX_TYPE_BIT(type))) {
+        return -1;
+    }
+
+    switch (type) {
+#define IEX_SCHEMA_PRINT_CASE(name, type_, length)              \
+        case (type_):                                           \
+            if (len < (length)) return -1;                      \
+            fputs(#name, out);                                  \
+            IEX_FIELDS_##name(IEX_SCHEMA_PRINT_FIELD, name)     \
+            fputc('\n', out);                                   \
+            return 0;
+        IEX_MESSAGES(IEX_SCHEMA_PRINT_CASE)
+#undef IEX_SCHEMA_PRINT_CASE
+        default:
+            return -1;
+    }
+}
+
+#endif
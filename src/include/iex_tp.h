@@ -0,0 +1,224 @@
+#ifndef IEX_TP_H
+#define IEX_TP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "iex.h"
+#include "iex_schema.h"
+
+// IEX Transport Protocol (IEX-TP v1) segment framing
+// Every UDP datagram carries exactly one segment: a 40-byte header followed
+// by message_count blocks of [uint16 length][message bytes]. All integers
+// are little endian. Walking the length prefixes visits each message once
+// and never has to guess where the next one starts.
+
+#define IEX_TP_VERSION          0x01
+#define IEX_TP_HEADER_SIZE      40
+
+typedef struct {
+    uint8_t  version;               // 0x01
+    uint8_t  reserved;
+    uint16_t message_protocol_id;   // selects the schema: 0x8003 TOPS, 0x8004 DEEP
+    uint32_t channel_id;
+    uint32_t session_id;
+    uint16_t payload_length;        // bytes following this header
+    uint16_t message_count;
+    uint64_t stream_offset;
+    uint64_t first_sequence_number;
+    uint64_t send_time;             // ns since POSIX epoch
+} __attribute__((packed)) iex_tp_header_t;
+
+#define IEX_TP_PAYLOAD_LENGTH_OFFSET    12
+#define IEX_TP_MESSAGE_COUNT_OFFSET     14
+#define IEX_TP_FIRST_SEQUENCE_OFFSET    24
+#define IEX_TP_SEND_TIME_OFFSET         32
+
+// Link/network framing in front of the segment
+#define ETH_HEADER_SIZE         14
+#define ETH_TYPE_IPV4           0x0800
+#define ETH_TYPE_VLAN           0x8100
+#define IPV4_PROTOCOL_UDP       17
+#define UDP_HEADER_SIZE         8
+
+// Common message prefix: type(1) flags(1) timestamp(8) symbol(8)
+#define IEX_MSG_TYPE_OFFSET     offsetof(iex_message_header_t, message_type)
+#define IEX_MSG_FLAGS_OFFSET    offsetof(iex_message_header_t, flags)
+#define IEX_MSG_TIME_OFFSET     offsetof(iex_message_header_t, timestamp)
+#define IEX_MSG_SYMBOL_OFFSET   offsetof(iex_message_header_t, symbol)
+#define IEX_MSG_HEADER_LENGTH   sizeof(iex_message_header_t)
+
+// DEEP price level update flags
+#define IEX_DEEP_EVENT_COMPLETE     0x01    // last update of the event
+
+// Unaligned little-endian loads (compile to a single mov on x86/ARM64)
+static inline uint16_t iex_load_u16(const uint8_t *p) {
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t iex_load_u32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t iex_load_u64(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline int64_t iex_load_i64(const uint8_t *p) {
+    int64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Locate the UDP payload inside an Ethernet frame
+// Handles an optional 802.1Q tag and variable IPv4 header length.
+// Returns NULL for anything that is not IPv4/UDP or is truncated.
+static inline const uint8_t *iex_udp_payload(const uint8_t *frame, size_t caplen,
+                                             size_t *payload_len) {
+    size_t off = ETH_HEADER_SIZE;
+    if (caplen < ETH_HEADER_SIZE + 20 + UDP_HEADER_SIZE) return NULL;
+
+    uint16_t ethertype = (uint16_t)((frame[12] << 8) | frame[13]);
+    if (ethertype == ETH_TYPE_VLAN) {
+        ethertype = (uint16_t)((frame[16] << 8) | frame[17]);
+        off += 4;
+    }
+    if (ethertype != ETH_TYPE_IPV4) return NULL;
+
+    const uint8_t *ip = frame + off;
+    size_t ihl = (size_t)(ip[0] & 0x0F) * 4;
+    if ((ip[0] >> 4) != 4 || ihl < 20 || ip[9] != IPV4_PROTOCOL_UDP) return NULL;
+
+    off += ihl;
+    if (off + UDP_HEADER_SIZE > caplen) return NULL;
+
+    const uint8_t *udp = frame + off;
+    size_t udp_len = (size_t)((udp[4] << 8) | udp[5]);
+    off += UDP_HEADER_SIZE;
+    if (udp_len < UDP_HEADER_SIZE) return NULL;
+
+    size_t len = udp_len - UDP_HEADER_SIZE;
+    if (off + len > caplen) len = caplen - off;  // truncated capture
+
+    *payload_len = len;
+    return frame + off;
+}
+
+// Number of messages announced by a segment header (0 for heartbeats)
+static inline uint16_t iex_tp_message_count(const uint8_t *udp_payload, size_t len) {
+    if (len < IEX_TP_HEADER_SIZE || udp_payload[0] != IEX_TP_VERSION) return 0;
+    return iex_load_u16(udp_payload + IEX_TP_MESSAGE_COUNT_OFFSET);
+}
+
+// Segment cursor
+typedef struct {
+    const iex_tp_header_t *header;
+    const uint8_t *cursor;          // next length prefix
+    const uint8_t *end;             // end of segment payload
+    uint64_t sequence;              // sequence number of the next message
+    uint32_t remaining;             // messages not yet returned
+} iex_tp_segment_t;
+
+// Validate the segment header and position the cursor at the first block
+// Returns 0 on success, -1 if the payload is not an IEX-TP v1 segment.
+static inline int iex_tp_segment_init(iex_tp_segment_t *seg,
+                                      const uint8_t *udp_payload, size_t len) {
+    if (len < IEX_TP_HEADER_SIZE) return -1;
+
+    const iex_tp_header_t *hdr = (const iex_tp_header_t *)udp_payload;
+    if (hdr->version != IEX_TP_VERSION) return -1;
+
+    size_t payload_length = iex_load_u16(udp_payload + IEX_TP_PAYLOAD_LENGTH_OFFSET);
+    if (IEX_TP_HEADER_SIZE + payload_length > len) return -1;
+
+    seg->header = hdr;
+    seg->cursor = udp_payload + IEX_TP_HEADER_SIZE;
+    seg->end = seg->cursor + payload_length;
+    seg->sequence = iex_load_u64(udp_payload + IEX_TP_FIRST_SEQUENCE_OFFSET);
+    seg->remaining = iex_load_u16(udp_payload + IEX_TP_MESSAGE_COUNT_OFFSET);
+    return 0;
+}
+
+// Return the next message (starting at its type byte) or NULL when done
+// A block that would run past the segment ends the walk.
+static inline const uint8_t *iex_tp_next_message(iex_tp_segment_t *seg,
+                                                 uint16_t *msg_len) {
+    if (seg->remaining == 0 || seg->cursor + 2 > seg->end) return NULL;
+
+    uint16_t len = iex_load_u16(seg->cursor);
+    const uint8_t *msg = seg->cursor + 2;
+    if (len == 0 || msg + len > seg->end) {
+        seg->remaining = 0;
+        return NULL;
+    }
+
+    seg->cursor = msg + len;
+    seg->sequence++;
+    seg->remaining--;
+    *msg_len = len;
+    return msg;
+}
+
+static inline uint64_t iex_msg_timestamp(const uint8_t *msg) {
+    return iex_message_header_timestamp(msg);
+}
+
+// 8-byte space-padded symbol as a single little-endian word
+static inline uint64_t iex_msg_symbol(const uint8_t *msg) {
+    return iex_message_header_symbol(msg);
+}
+
+// Decode every message of one segment into parsed_message_t records
+// The segment's protocol ID selects the schema (TOPS 1.6 or DEEP 1.0).
+// Returns the number of records written (at most max_out); messages the
+// schema does not define or with a short body are skipped, not guessed at.
+uint32_t iex_tp_decode_segment(const uint8_t *udp_payload, size_t len,
+                               parsed_message_t *out, uint32_t max_out);
+
+// Message-type filter sets
+// Named subsets of the schema's types (IEX_TYPE_BIT masks). Each set gets
+// its own iex_tp_decode_segment_<name>() compiled with the set as a
+// constant, so unwanted messages are skipped by length with no dispatch.
+#define IEX_FILTER_ALL     (~0ULL)
+
+#define IEX_FILTER_SETS(X)                                                           \
+    X(trades, IEX_TYPE_BIT(IEX_TRADE_REPORT) | IEX_TYPE_BIT(IEX_TRADE_BREAK))        \
+    X(quotes, IEX_TYPE_BIT(IEX_QUOTE_UPDATE))                                        \
+    X(depth,  IEX_TYPE_BIT(IEX_PRICE_LEVEL_BUY) | IEX_TYPE_BIT(IEX_PRICE_LEVEL_SELL)) \
+    X(book,   IEX_TYPE_BIT(IEX_QUOTE_UPDATE) | IEX_TYPE_BIT(IEX_TRADE_REPORT) |      \
+              IEX_TYPE_BIT(IEX_TRADE_BREAK) | IEX_TYPE_BIT(IEX_PRICE_LEVEL_BUY) |    \
+              IEX_TYPE_BIT(IEX_PRICE_LEVEL_SELL))
+
+// Filter sets by index: "all" first, then IEX_FILTER_SETS order
+#define IEX_FILTER_ENUM(name, mask) IEX_FILTER_INDEX_##name,
+enum { IEX_FILTER_INDEX_all, IEX_FILTER_SETS(IEX_FILTER_ENUM) IEX_FILTER_COUNT };
+#undef IEX_FILTER_ENUM
+
+typedef uint32_t (*iex_segment_decoder_fn)(const uint8_t *udp_payload, size_t len,
+                                           parsed_message_t *out, uint32_t max_out);
+
+#define IEX_DECLARE_FILTERED(name, mask)                                               \
+    uint32_t iex_tp_decode_segment_##name(const uint8_t *udp_payload, size_t len,     \
+                                          parsed_message_t *out, uint32_t max_out);
+IEX_FILTER_SETS(IEX_DECLARE_FILTERED)
+#undef IEX_DECLARE_FILTERED
+
+// Decoder for a filter set by name ("all" or a set above), NULL if unknown
+iex_segment_decoder_fn iex_tp_segment_decoder(const char *filter);
+
+// Index of a filter set by name, -1 if unknown
+// The decoders themselves are compiled per ISA; cpu_kernels.decode_segment
+// holds the active copy of each.
+int iex_tp_filter_index(const char *filter);
+
+// Convenience wrapper that starts from the Ethernet frame
+uint32_t iex_tp_decode_frame(const uint8_t *frame, size_t caplen,
+                             parsed_message_t *out, uint32_t max_out);
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef MESSAGE_BUS_H
+#define MESSAGE_BUS_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "iex.h"
+#include "batch_pool.h"
+#include "message_ring.h"
+#include "symbol_table.h"
+
+// Fan-out of decoded batches to in-process consumers
+// Parsers submit batches to the pipeline's pool. A dispatcher thread takes
+// them in capture order, resolves symbols to dense IDs once for everybody,
+// and pushes each batch onto one SPSC ring per registered consumer. Every
+// consumer runs on its own thread; the last one done with a batch releases
+// it back to the pool. Another consumer costs a ring hop per batch, not
+// another pass over the file.
+
+#define MESSAGE_BUS_MAX_CONSUMERS   8
+
+// Shared end-of-stream state handed to every consumer report
+typedef struct {
+    const symbol_table_t *symbols;
+    const uint64_t *message_counts;     // indexed by symbol_id_t
+    symbol_id_t busiest;                // SYMBOL_ID_INVALID if no symbol was seen
+} message_bus_summary_t;
+
+typedef struct {
+    const char *name;
+    void *state;
+    // Consumer thread, once per batch in capture order; ids[i] belongs to messages[i]
+    void (*consume)(void *state, const message_batch_t *batch, const symbol_id_t *ids);
+    // After the last batch, in registration order: report and release state
+    void (*finish)(void *state, const message_bus_summary_t *summary);
+} message_consumer_t;
+
+// Attach a consumer to the next run; returns 0, or -1 once the bus is full
+int message_bus_register(const message_consumer_t *consumer);
+
+// Forget registered consumers without running them (a run that failed to start)
+void message_bus_reset(void);
+
+struct message_pipeline;
+
+typedef struct {
+    struct message_pipeline *pipeline;
+    message_consumer_t consumer;
+    spsc_ring_t ring;
+    pthread_t thread;
+} consumer_lane_t;
+
+typedef struct message_pipeline {
+    batch_pool_t pool;
+    pthread_t dispatcher;
+    symbol_table_t symbols;
+    uint64_t *message_counts;           // indexed by symbol_id_t
+    symbol_id_t *ids;                   // MAX_MESSAGES_PER_CHUNK per pooled batch
+    atomic_uint *readers;               // consumers still holding each pooled batch
+    consumer_lane_t lanes[MESSAGE_BUS_MAX_CONSUMERS];
+    uint32_t lane_count;
+    int samples_shown;
+} message_pipeline_t;
+
+// Allocate batch_count pooled batches and start the dispatcher and consumers
+int start_message_delivery(message_pipeline_t *pipeline, uint32_t batch_count);
+
+// Close the pool and wait until every consumer has seen every batch
+void drain_message_delivery(message_pipeline_t *pipeline);
+
+// End of stream (after draining): consumer reports, then release everything
+void finish_message_delivery(message_pipeline_t *pipeline);
+
+#endif
@@ -0,0 +1,167 @@
+#ifndef MESSAGE_RING_H
+#define MESSAGE_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <time.h>
+#include "iex.h"
+
+// Lock-free rings of message batch pointers
+// Capacities are powers of two and indices run freely (masked on access).
+// Indices written by different threads sit on separate cache lines so a
+// producer and a consumer never invalidate each other's line except through
+// the slots themselves.
+//
+// spsc_ring_t: one producer thread, one consumer thread. Each side keeps a
+// private copy of the other side's index and only reloads it when the ring
+// looks full (or empty), so the shared lines move once per lap, not per push.
+//
+// mpsc_ring_t: any number of producers, one consumer. Bounded queue with a
+// sequence number per cell: a producer claims a position with one CAS on
+// tail and publishes the cell by bumping its sequence.
+
+#define RING_CACHE_LINE     64
+
+typedef struct {
+    atomic_size_t head __attribute__((aligned(RING_CACHE_LINE)));     // consumer
+    size_t cached_tail;
+    atomic_size_t tail __attribute__((aligned(RING_CACHE_LINE)));     // producer
+    size_t cached_head;
+    message_batch_t **slots __attribute__((aligned(RING_CACHE_LINE)));
+    size_t mask;
+    atomic_int closed;          // producer is done; consumer drains then stops
+} spsc_ring_t;
+
+typedef struct {
+    atomic_size_t sequence;
+    message_batch_t *batch;
+} mpsc_cell_t;
+
+typedef struct {
+    atomic_size_t tail __attribute__((aligned(RING_CACHE_LINE)));     // producers
+    size_t head __attribute__((aligned(RING_CACHE_LINE)));            // consumer
+    mpsc_cell_t *cells __attribute__((aligned(RING_CACHE_LINE)));
+    size_t mask;
+} mpsc_ring_t;
+
+// Room for at least min_capacity entries; return 0 or -1
+int spsc_ring_init(spsc_ring_t *ring, size_t min_capacity);
+void spsc_ring_free(spsc_ring_t *ring);
+int mpsc_ring_init(mpsc_ring_t *ring, size_t min_capacity);
+void mpsc_ring_free(mpsc_ring_t *ring);
+
+static inline void ring_cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// Wait step for a ring that is empty or full: spin, then yield, then sleep
+static inline void ring_backoff(unsigned *spins) {
+    if (*spins < 64) {
+        ring_cpu_relax();
+    } else if (*spins < 128) {
+        sched_yield();
+    } else {
+        struct timespec pause = {0, 20000};
+        nanosleep(&pause, NULL);
+    }
+    (*spins)++;
+}
+
+// Returns 0, or -1 if the ring is full
+static inline int spsc_ring_push(spsc_ring_t *ring, message_batch_t *batch) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    if (tail - ring->cached_head > ring->mask) {
+        ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (tail - ring->cached_head > ring->mask) return -1;
+    }
+
+    ring->slots[tail & ring->mask] = batch;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return 0;
+}
+
+// Next batch, or NULL if the ring is empty
+static inline message_batch_t *spsc_ring_pop(spsc_ring_t *ring) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    if (head == ring->cached_tail) {
+        ring->cached_tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if (head == ring->cached_tail) return NULL;
+    }
+
+    message_batch_t *batch = ring->slots[head & ring->mask];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return batch;
+}
+
+// Producer side: no further pushes
+static inline void spsc_ring_close(spsc_ring_t *ring) {
+    atomic_store_explicit(&ring->closed, 1, memory_order_release);
+}
+
+// Consumer side: next batch, waiting for one; NULL once closed and drained
+static inline message_batch_t *spsc_ring_pop_wait(spsc_ring_t *ring) {
+    unsigned spins = 0;
+
+    for (;;) {
+        message_batch_t *batch = spsc_ring_pop(ring);
+        if (batch) return batch;
+
+        // Pushes happen before close, so one more look after seeing it is final
+        if (atomic_load_explicit(&ring->closed, memory_order_acquire)) {
+            return spsc_ring_pop(ring);
+        }
+        ring_backoff(&spins);
+    }
+}
+
+// Returns 0, or -1 if the ring is full
+static inline int mpsc_ring_push(mpsc_ring_t *ring, message_batch_t *batch) {
+    size_t pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    mpsc_cell_t *cell;
+
+    for (;;) {
+        cell = &ring->cells[pos & ring->mask];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->tail, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+            // pos was reloaded by the failed exchange
+        } else if (diff < 0) {
+            return -1;  // the consumer has not freed this cell yet
+        } else {
+            pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        }
+    }
+
+    cell->batch = batch;
+    atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+    return 0;
+}
+
+// Next batch, or NULL if the ring is empty (single consumer only)
+static inline message_batch_t *mpsc_ring_pop(mpsc_ring_t *ring) {
+    mpsc_cell_t *cell = &ring->cells[ring->head & ring->mask];
+    size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+
+    if (sequence != ring->head + 1) return NULL;
+
+    message_batch_t *batch = cell->batch;
+    atomic_store_explicit(&cell->sequence, ring->head + ring->mask + 1, memory_order_release);
+    ring->head++;
+    return batch;
+}
+
+#endif
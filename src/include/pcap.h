@@ -2,7 +2,15 @@
 #define PCAP_H
 
 #include <stdint.h>
+#include <stdio.h>
 #include <sys/mman.h>
+#include "iex.h"
+#include "message_bus.h"
+
+// Progress output of the parsers and consumer reports; embedders
+// (libbento) and benchmarks switch it off
+extern int parser_verbose;
+#define PARSER_LOG(...) do { if (parser_verbose) printf(__VA_ARGS__); } while (0)
 
 #define PCAP_MAGIC 0xa1b2c3d4
 #define PCAPNG_MAGIC 0x0a0d0d0a
@@ -30,6 +38,12 @@ typedef struct {
 
 #define PCAPNG_EPB_TYPE 0x00000006  // Enhanced Packet Block
 #define PCAPNG_IDB_TYPE 0x00000001  // Interface Description Block
+#define PCAPNG_SPB_TYPE 0x00000003  // Simple Packet Block
+#define PCAPNG_NRB_TYPE 0x00000004  // Name Resolution Block
+#define PCAPNG_ISB_TYPE 0x00000005  // Interface Statistics Block
+#define PCAPNG_DSB_TYPE 0x0000000A  // Decryption Secrets Block
+
+#define PCAPNG_RESYNC_DEPTH 4       // blocks chained forward to confirm a resync
 
 typedef struct {
     uint32_t block_type;     // 0x00000006
@@ -54,11 +68,25 @@ typedef struct {
     size_t size;
     size_t offset;
     int fd;
+    size_t window_size;     // bytes kept resident around the cursor; 0 = unbounded
+    size_t released_to;     // pages below this offset have been dropped
+    size_t prefetched_to;   // readahead requested up to this offset
 } mmap_context_t;
 
-// Assembly function declarations
-extern void parse_pcap_chunk_asm(const uint8_t *data, size_t size, void *output);
+#define MMAP_DEFAULT_PREFETCH (64 * 1024 * 1024)  // readahead distance when unbounded
+
+// Assembly function declarations (src/asm/<arch>)
+// The record contracts below are those of src/asm/x86_64, checked frame by
+// frame against the C decoder by simd_benchmark --verify-asm. The arm64
+// routines still write the older 24-byte record and only
+// validate_pcap_header_asm is called there.
+// Walk classic pcap records from data, appending each frame's Quote Updates
+// and Trade Reports to output (parsed_message_t); returns packets decoded
+extern uint32_t parse_pcap_chunk_asm(const uint8_t *data, size_t size, void *output);
+// 1 for a pcap (either byte order) or pcapng file header, else 0
 extern int validate_pcap_header_asm(const pcap_header_t *header);
+// Quote Updates and Trade Reports of one Ethernet frame into output
+// (parsed_message_t), framed as iex_tp_decode_frame does; returns the count
 extern uint32_t extract_iex_messages_asm(const uint8_t *packet_data, size_t len, void *output);
 
 // C wrapper functions
@@ -66,4 +94,41 @@ int init_mmap_parser(const char *filename, mmap_context_t *ctx);
 void cleanup_mmap_parser(mmap_context_t *ctx);
 int parse_pcap_file(mmap_context_t *ctx);
 
+// Sliding residency window: request readahead up to cursor + window (or
+// MMAP_DEFAULT_PREFETCH) and, with a window set, drop pages behind cursor
+// from both the mapping and the page cache. Call as the parse advances.
+void mmap_window_advance(mmap_context_t *ctx, size_t cursor);
+
+// Drop pages behind cursor only (for non-sequential access); no-op unless
+// a window is set
+void mmap_release_behind(mmap_context_t *ctx, size_t cursor);
+
+// Parallel pcapng parsing: partitions decoded on num_threads workers,
+// batches delivered downstream in original capture order
+int parse_pcap_file_parallel(mmap_context_t *ctx, int num_threads);
+
+// Shared block walk used by the serial and parallel parsers
+int locate_first_block(mmap_context_t *ctx, uint8_t **start, size_t *remaining);
+
+// Walk pcapng blocks that start before stop and end within limit, decoding
+// every EPB into batch. Stops early at an invalid block, or before a packet
+// whose messages would overflow the batch; returns the first block not
+// consumed (>= stop when the range was walked completely).
+const uint8_t *decode_pcapng_blocks(const uint8_t *data, const uint8_t *stop, const uint8_t *limit,
+                                    message_batch_t *batch, uint64_t *packets);
+
+// Restrict the block decoders to a message-type filter set ("all", "trades",
+// "quotes", "depth", "book"; see IEX_FILTER_SETS). Returns 0 or -1.
+int pcap_set_message_filter(const char *filter);
+
+// Same contract for classic pcap records (Ethernet link type)
+const uint8_t *decode_pcap_records(const uint8_t *data, const uint8_t *stop, const uint8_t *limit,
+                                   message_batch_t *batch, uint64_t *packets);
+
+// Find the first EPB boundary at or after from without walking from the SHB
+// A candidate needs the EPB type, matching leading/trailing lengths and a
+// captured_len that fits, and must chain into PCAPNG_RESYNC_DEPTH further
+// well-framed blocks. Returns end if no boundary is found.
+const uint8_t *pcapng_resync(const uint8_t *base, const uint8_t *from, const uint8_t *end);
+
 #endif
\ No newline at end of file
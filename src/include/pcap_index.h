@@ -0,0 +1,134 @@
+#ifndef PCAP_INDEX_H
+#define PCAP_INDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "pcap.h"
+#include "symbol_table.h"
+
+// Sidecar packet index (<capture>.idx)
+// Every Nth EPB carrying an IEX-TP segment gets one entry: its file offset,
+// capture timestamp (ns since epoch, after applying the IDB if_tsresol) and
+// the segment's first sequence number. Entries are in file order, so a seek
+// by time or sequence is a binary search followed by a short forward walk.
+//
+// The sidecar also carries one zone map per PCAP_CHUNK_SIZE range of the
+// file: min/max message timestamp and sequence number and a bitmap of
+// message types. Symbols are interned into dense IDs (symbol_table.h) in
+// order of first sight; the dictionary is stored once and every chunk gets
+// an exact bitmap of the IDs it contains, one bit per symbol. A filtered
+// run consults them to skip whole chunks without faulting in their pages.
+
+#define PCAP_INDEX_MAGIC        0x58444950  // "PIDX"
+#define PCAP_INDEX_VERSION      4
+#define PCAP_INDEX_SUFFIX       ".idx"
+#define PCAP_INDEX_DEFAULT_STRIDE 1024
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t stride;            // EPBs between consecutive entries
+    uint32_t chunk_size;        // bytes of file covered by one zone map
+    uint64_t source_size;       // capture size when the index was built
+    int64_t  source_mtime_ns;   // capture mtime (ns) when the index was built
+    uint64_t entry_count;
+    uint64_t zone_count;
+    uint32_t symbol_count;      // dictionary size: symbol IDs 0..symbol_count-1
+    uint32_t symbol_words;      // uint64 words of symbol bitmap per zone map
+} __attribute__((packed)) pcap_index_header_t;
+
+typedef struct {
+    uint64_t offset;            // file offset of the EPB
+    uint64_t timestamp_ns;      // capture time
+    uint64_t first_sequence;    // IEX-TP first sequence number of the segment
+} __attribute__((packed)) pcap_index_entry_t;
+
+// Message types are ASCII letters; bit (type & 63) marks presence
+#define PCAP_ZONE_TYPE_BIT(type) (1ULL << ((type) & 63))
+
+#define PCAP_SYMBOL_WORDS(count) (((uint32_t)(count) + 63) / 64)
+
+// Zone map flags
+#define PCAP_ZONE_ALL_SYMBOLS   0x1     // a symbol found the dictionary full
+
+// Summary of the blocks starting inside one chunk of the file
+typedef struct {
+    uint64_t start_offset;      // first block starting in the chunk
+    uint64_t end_offset;        // end of the last block starting in the chunk
+    uint64_t min_timestamp;     // message timestamps (UINT64_MAX/0 if none)
+    uint64_t max_timestamp;
+    uint64_t min_sequence;      // IEX-TP sequence numbers (UINT64_MAX/0 if none)
+    uint64_t max_sequence;
+    uint64_t type_bitmap;
+    uint32_t message_count;
+    uint32_t flags;
+} __attribute__((packed)) pcap_zone_map_t;
+
+// On disk: header, entries, zone maps, the dictionary's symbol words in ID
+// order, then symbol_words bitmap words per zone map
+typedef struct {
+    pcap_index_header_t header;
+    pcap_index_entry_t *entries;
+    pcap_zone_map_t *zones;
+    uint64_t *symbol_bitmaps;   // zone z: symbol_bitmaps[z * symbol_words ..]
+    symbol_table_t symbols;     // symbol word -> ID of the bitmaps
+} pcap_index_t;
+
+// Selective scan: a message matches if its timestamp lies in
+// [from_timestamp, until_timestamp], its type bit is set in type_mask and
+// (when symbol_count > 0) its symbol word is one of symbols
+#define PCAP_QUERY_MAX_SYMBOLS  16
+
+typedef struct {
+    uint64_t from_timestamp;
+    uint64_t until_timestamp;
+    uint64_t type_mask;
+    uint64_t symbols[PCAP_QUERY_MAX_SYMBOLS];
+    uint32_t symbol_count;
+} pcap_query_t;
+
+// Walk the capture once and record every stride-th IEX-TP EPB
+int pcap_index_build(const mmap_context_t *ctx, uint32_t stride, pcap_index_t *index);
+
+int pcap_index_save(const pcap_index_t *index, const char *path);
+
+// Load a sidecar; fails if it is malformed, truncated or was built from a
+// capture of a different size or mtime
+int pcap_index_load(const char *path, const mmap_context_t *ctx, pcap_index_t *index);
+
+// Load <pcap_path>.idx, building and saving it first if missing or stale
+int pcap_index_open(const char *pcap_path, const mmap_context_t *ctx,
+                    uint32_t stride, pcap_index_t *index);
+
+void pcap_index_free(pcap_index_t *index);
+
+// Position ctx->offset at the last indexed EPB at or before the target, so
+// the parser starts no more than stride packets ahead of it. Returns 0, or
+// -1 if the target lies before the first entry (offset left unchanged).
+int pcap_index_seek_time(const pcap_index_t *index, mmap_context_t *ctx, uint64_t timestamp_ns);
+int pcap_index_seek_sequence(const pcap_index_t *index, mmap_context_t *ctx, uint64_t sequence);
+
+// Match-everything query; narrow it with the helpers below
+void pcap_query_init(pcap_query_t *query);
+
+// Add a ticker (space padded to the 8-byte IEX symbol word); -1 if full
+int pcap_query_add_symbol(pcap_query_t *query, const char *ticker);
+
+// Could any message in zone map z match? Symbols and types are exact, the
+// time window a range test; false positives only, never false negatives
+int pcap_query_match_zone(const pcap_query_t *query, const pcap_index_t *index, uint64_t z);
+
+int pcap_query_match_message(const pcap_query_t *query, const parsed_message_t *msg);
+
+// Decode only the chunks whose zone maps may match, delivering matching
+// messages in capture order
+int parse_pcap_file_query(mmap_context_t *ctx, const pcap_index_t *index,
+                          const pcap_query_t *query);
+
+// Parse "HH:MM[:SS[.fraction]]" into ns since midnight; -1 on bad input
+int pcap_parse_time_of_day(const char *text, uint64_t *ns);
+
+// Absolute timestamp for a UTC time of day on the capture's first day
+uint64_t pcap_index_time_of_day(const pcap_index_t *index, uint64_t ns_since_midnight);
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+
+// Hardware performance counters (Linux perf_event_open)
+// One counter per event, user space only, following threads the calling
+// thread creates while they are running, so a parse with its dispatcher
+// and consumer threads is counted whole. Events the CPU or the kernel does
+// not offer (virtual machines often have no PMU at all) are left out and
+// reported as unavailable rather than failing the measurement. Counts are
+// scaled by time enabled / time running when the kernel multiplexed them.
+
+typedef enum {
+    PERF_COUNTER_CYCLES,
+    PERF_COUNTER_INSTRUCTIONS,
+    PERF_COUNTER_L1D_MISSES,        // L1 data cache read misses
+    PERF_COUNTER_LLC_MISSES,        // last-level cache misses
+    PERF_COUNTER_BRANCH_MISSES,
+    PERF_COUNTER_DTLB_MISSES,       // data TLB read misses
+    PERF_COUNTER_COUNT
+} perf_counter_id_t;
+
+typedef struct {
+    int fds[PERF_COUNTER_COUNT];    // -1 where the event is unavailable
+    int open_count;
+} perf_counters_t;
+
+typedef struct {
+    uint64_t values[PERF_COUNTER_COUNT];
+    uint32_t valid;                 // bit per perf_counter_id_t that was counted
+} perf_sample_t;
+
+// Open every event that is available; returns how many, 0 (reported once)
+// if none are or the platform has no perf_event_open
+int perf_counters_open(perf_counters_t *counters);
+void perf_counters_close(perf_counters_t *counters);
+
+// Reset and enable / disable and read the open counters
+void perf_counters_start(perf_counters_t *counters);
+void perf_counters_stop(perf_counters_t *counters, perf_sample_t *sample);
+
+// "cycles", "instructions", "L1d-misses", "LLC-misses", "branch-misses", "dTLB-misses"
+const char *perf_counter_name(perf_counter_id_t id);
+
+static inline int perf_sample_has(const perf_sample_t *sample, perf_counter_id_t id) {
+    return (sample->valid >> id) & 1;
+}
+
+#endif
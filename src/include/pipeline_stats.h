@@ -0,0 +1,153 @@
+#ifndef PIPELINE_STATS_H
+#define PIPELINE_STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+// Per-stage latency histograms for the parse pipeline
+// Built with -DPIPELINE_STATS=1 (make STATS=1) the decoders time block
+// walk, framing and decode of one packet in PIPELINE_STATS_SAMPLE_EVERY,
+// and every batch through dispatch and each consumer, with the cycle
+// counter (rdtsc, cntvct_el0). Each thread records into its own HDR-style
+// histograms with no sharing; pipeline_stats_merge sums them whenever it
+// is called. Built without it the STAGE_* macros expand to nothing.
+//
+// Per packet: block walk is the block header checks, framing locates the
+// UDP payload and reads the segment header, decode walks the IEX-TP
+// length chain and fills the batch. Per batch: dispatch resolves symbols
+// and hands the batch to every consumer ring; consumer is one consume().
+
+#ifndef PIPELINE_STATS
+#define PIPELINE_STATS 0
+#endif
+
+#ifndef PIPELINE_STATS_SAMPLE_SHIFT
+#define PIPELINE_STATS_SAMPLE_SHIFT 4       // time 1 packet in 16
+#endif
+#define PIPELINE_STATS_SAMPLE_EVERY (1u << PIPELINE_STATS_SAMPLE_SHIFT)
+
+typedef enum {
+    PIPELINE_STAGE_BLOCK_WALK,
+    PIPELINE_STAGE_FRAMING,
+    PIPELINE_STAGE_DECODE,
+    PIPELINE_STAGE_DISPATCH,
+    PIPELINE_STAGE_CONSUMER,
+    PIPELINE_STAGE_COUNT
+} pipeline_stage_t;
+
+// Log-bucketed histogram: values below 16 exact, then 16 buckets per
+// power of two (at most 6.25% relative error), covering all of uint64_t
+#define PIPELINE_STATS_SUB_BITS     4
+#define PIPELINE_STATS_SUB_COUNT    (1u << PIPELINE_STATS_SUB_BITS)
+#define PIPELINE_STATS_BUCKETS      ((64 - PIPELINE_STATS_SUB_BITS + 1) * PIPELINE_STATS_SUB_COUNT)
+
+typedef struct {
+    uint64_t count;
+    uint64_t total;                 // ticks
+    uint64_t max;
+    uint64_t buckets[PIPELINE_STATS_BUCKETS];
+} stats_histogram_t;
+
+typedef struct pipeline_thread_stats {
+    stats_histogram_t stages[PIPELINE_STAGE_COUNT];
+    uint32_t sample_clock;          // packets seen, for 1-in-N sampling
+    int in_use;                     // owned by a live thread
+    struct pipeline_thread_stats *next;
+} pipeline_thread_stats_t;
+
+// Merged view: histograms of every thread that recorded, in ticks
+typedef struct {
+    stats_histogram_t stages[PIPELINE_STAGE_COUNT];
+    uint32_t threads;
+    double ns_per_tick;
+} pipeline_stats_t;
+
+// Cycle counter; nanoseconds where there is none
+static inline uint64_t pipeline_ticks(void) {
+#if defined(__x86_64__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static inline uint32_t stats_bucket(uint64_t value) {
+    if (value < PIPELINE_STATS_SUB_COUNT) return (uint32_t)value;
+    uint32_t shift = 63 - (uint32_t)__builtin_clzll(value) - PIPELINE_STATS_SUB_BITS;
+    return ((shift + 1) << PIPELINE_STATS_SUB_BITS) +
+           (uint32_t)((value >> shift) & (PIPELINE_STATS_SUB_COUNT - 1));
+}
+
+// Smallest value that falls into bucket
+static inline uint64_t stats_bucket_floor(uint32_t bucket) {
+    if (bucket < PIPELINE_STATS_SUB_COUNT) return bucket;
+    uint32_t shift = (bucket >> PIPELINE_STATS_SUB_BITS) - 1;
+    return (uint64_t)(PIPELINE_STATS_SUB_COUNT + (bucket & (PIPELINE_STATS_SUB_COUNT - 1))) << shift;
+}
+
+extern _Thread_local pipeline_thread_stats_t *pipeline_stats_local;
+
+// This thread's histograms, claimed on first use
+pipeline_thread_stats_t *pipeline_stats_attach(void);
+
+static inline pipeline_thread_stats_t *pipeline_stats_thread(void) {
+    pipeline_thread_stats_t *stats = pipeline_stats_local;
+    return stats ? stats : pipeline_stats_attach();
+}
+
+// Cycle count for one packet in PIPELINE_STATS_SAMPLE_EVERY, else 0
+static inline uint64_t pipeline_stats_sample(void) {
+    pipeline_thread_stats_t *stats = pipeline_stats_thread();
+    return (stats->sample_clock++ & (PIPELINE_STATS_SAMPLE_EVERY - 1)) ? 0 : pipeline_ticks();
+}
+
+// Record the time since `since` against stage; returns now
+static inline uint64_t pipeline_stats_lap(pipeline_stage_t stage, uint64_t since) {
+    uint64_t now = pipeline_ticks();
+    uint64_t elapsed = now - since;
+    stats_histogram_t *h = &pipeline_stats_thread()->stages[stage];
+    h->count++;
+    h->total += elapsed;
+    if (elapsed > h->max) h->max = elapsed;
+    h->buckets[stats_bucket(elapsed)]++;
+    return now;
+}
+
+#if PIPELINE_STATS
+#define STAGE_CLOCK(clock)          uint64_t clock = 0
+#define STAGE_SAMPLE(clock)         ((clock) = pipeline_stats_sample())
+#define STAGE_START(clock)          ((clock) = pipeline_ticks())
+#define STAGE_LAP(clock, stage) \
+    do { if (clock) (clock) = pipeline_stats_lap(stage, clock); } while (0)
+#else
+#define STAGE_CLOCK(clock)
+#define STAGE_SAMPLE(clock)         ((void)0)
+#define STAGE_START(clock)          ((void)0)
+#define STAGE_LAP(clock, stage)     ((void)0)
+#endif
+
+// Sum every thread's histograms (racy but safe while threads still record)
+void pipeline_stats_merge(pipeline_stats_t *merged);
+
+// Clear every thread's histograms
+void pipeline_stats_reset(void);
+
+// Value at quantile q (0..1) of a histogram, in ticks
+uint64_t pipeline_stats_quantile(const stats_histogram_t *histogram, double q);
+
+// Merge and print count, mean, p50/p90/p99/p99.9 and max per stage in ns
+void pipeline_stats_report(FILE *out);
+
+const char *pipeline_stage_name(pipeline_stage_t stage);
+
+#endif
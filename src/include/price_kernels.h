@@ -0,0 +1,26 @@
+#ifndef PRICE_KERNELS_H
+#define PRICE_KERNELS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "iex.h"
+
+// Vector kernels over price columns (iex_price_t, 1/10000 dollars)
+// Books and analytics keep prices as 64-bit integers in contiguous arrays;
+// these are the column operations they need. Scalar, SSE4.2, AVX2, AVX-512
+// and NEON variants are selected at startup (cpu_dispatch.h); every variant
+// returns exactly what the scalar loop does.
+// 0 marks an empty book side, as in Quote Updates.
+
+// dollars[i] = prices[i] / 10000.0, correctly rounded (display and export only)
+void price_to_double(const iex_price_t *prices, double *dollars, size_t count);
+
+// Lowest and highest non-zero price; returns how many were non-zero
+// (min and max are left untouched when that is 0)
+size_t price_range(const iex_price_t *prices, size_t count,
+                   iex_price_t *min, iex_price_t *max);
+
+// Slots where both sides are quoted and bids[i] >= asks[i] (locked or crossed)
+size_t price_count_crossed(const iex_price_t *bids, const iex_price_t *asks, size_t count);
+
+#endif
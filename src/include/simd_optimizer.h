@@ -34,18 +34,21 @@ void cache_optimized_chunk_processor(const void* source,
 
 // SIMD configuration and capability detection
 typedef struct {
+    int has_sse42;          // x86_64: SSE4.2 support
     int has_avx2;           // x86_64: AVX2 support
-    int has_avx512;         // x86_64: AVX-512 support  
+    int has_avx512;         // x86_64: AVX-512 F and DQ support
     int has_neon;           // ARM64: NEON support
     int has_sve;            // ARM64: SVE support
+    int has_crc32;          // ARM64: CRC32/CRC32C instructions (optional in ARMv8.0)
     int cache_line_size;    // CPU cache line size
     int l1_cache_size;      // L1 cache size
     int l2_cache_size;      // L2 cache size
     int l3_cache_size;      // L3 cache size
 } simd_capabilities_t;
 
-// Detect SIMD capabilities and cache hierarchy
+// Detect SIMD capabilities and cache hierarchy (quiet; runs before main)
 void detect_simd_capabilities(simd_capabilities_t* caps);
+void print_simd_capabilities(const simd_capabilities_t* caps);
 
 // Performance tuning parameters
 typedef struct {
@@ -62,16 +65,20 @@ void get_optimal_tuning_params(const simd_capabilities_t* caps,
 
 // Specialized IEX message processing functions
 typedef struct {
-    uint64_t symbol_hash;       // CRC32 hash of symbol
+    uint64_t symbol_hash;       // 8-byte symbol word, as in parsed_message_t
     uint32_t message_type;      // IEX message type (0x51, 0x54, etc.)
-    uint32_t price;             // Price in fixed-point format
+    int64_t  price;             // 1/10000 dollars, as on the wire
     uint32_t size;              // Share/lot size
     uint64_t timestamp;         // Message timestamp
     uint32_t flags;             // Message flags
 } __attribute__((packed)) simd_iex_message_t;
 
+// Stream input for the quote/trade functions below: messages each prefixed by its 2-byte length as in an IEX-TP segment body. Messages
+// of other types are skipped by length; a truncated last message is ignored.
+
 // SIMD quote processing with bid/ask extraction
-// Processes multiple quote messages simultaneously
+// One record per Quote Update; price/size carry the bid side (use
+// simd_quote_columns for both sides). Returns records written.
 uint32_t simd_process_quote_batch(const uint8_t* quote_data,
                                   size_t data_length,
                                   simd_iex_message_t* output_messages,
@@ -83,8 +90,64 @@ uint32_t simd_process_trade_batch(const uint8_t* trade_data,
                                   simd_iex_message_t* output_messages,
                                   uint32_t max_messages);
 
-// Cache-friendly symbol hashing using SIMD CRC32
-uint64_t simd_hash_symbol(const char* symbol, size_t length);
+// Column (struct-of-arrays) outputs; the caller owns the arrays
+typedef struct {
+    uint64_t* timestamp;
+    uint64_t* symbol;
+    int64_t*  bid_price;
+    int64_t*  ask_price;
+    uint32_t* bid_size;
+    uint32_t* ask_size;
+    uint8_t*  flags;
+} simd_quote_columns_t;
+
+typedef struct {
+    uint64_t* timestamp;
+    uint64_t* symbol;
+    int64_t*  price;
+    uint32_t* size;
+    uint8_t*  flags;            // sale condition flags
+} simd_trade_columns_t;
+
+// Offsets (from data) of the messages of one type in a length-prefixed
+// stream, in order; returns how many were found, at most max_messages
+uint32_t simd_frame_messages(const uint8_t* data, size_t data_length,
+                             uint8_t message_type, uint64_t* offsets,
+                             uint32_t max_messages);
+
+// Transpose framed Quote Updates / Trade Reports (offsets as returned by
+// simd_frame_messages) into rows 0..count-1 of the columns, several messages per register group (AVX-512: 8, AVX2: 4, NEON: 2)
+void simd_quote_columns(const uint8_t* data, const uint64_t* offsets, uint32_t count,
+                        simd_quote_columns_t* columns);
+void simd_trade_columns(const uint8_t* data, const uint64_t* offsets, uint32_t count,
+                        simd_trade_columns_t* columns);
+
+// Scalar references: one schema accessor per field, one message at a time.
+// The vector versions above must produce byte-identical output.
+uint32_t simd_process_quote_batch_scalar(const uint8_t* quote_data, size_t data_length,
+                                         simd_iex_message_t* output_messages,
+                                         uint32_t max_messages);
+uint32_t simd_process_trade_batch_scalar(const uint8_t* trade_data, size_t data_length,
+                                         simd_iex_message_t* output_messages,
+                                         uint32_t max_messages);
+void simd_quote_columns_scalar(const uint8_t* data, const uint64_t* offsets, uint32_t count,
+                               simd_quote_columns_t* columns);
+void simd_trade_columns_scalar(const uint8_t* data, const uint64_t* offsets, uint32_t count,
+                               simd_trade_columns_t* columns);
+
+// Symbol hashing: CRC32C of the 8-byte space-padded symbol as one word,
+// one SSE4.2 crc32q / ARMv8 crc32cx per symbol where the CPU has it.
+// Symbols differing only within four adjacent bytes never collide, so all
+// tickers of up to four letters hash apart. (simd_benchmark
+// --verify-symbols checks a whole capture's symbols.)
+uint32_t simd_hash_symbol_word(uint64_t symbol);
+
+// Batch form: hashes[i] for symbols[i], i < count
+void simd_hash_symbols(const uint64_t* symbols, uint32_t* hashes, size_t count);
+void simd_hash_symbols_scalar(const uint64_t* symbols, uint32_t* hashes, size_t count);
+
+// Ticker text, padded to the wire form (longer text chains the CRC per word)
+uint32_t simd_hash_symbol(const char* symbol, size_t length);
 
 // Memory bandwidth optimization functions
 typedef struct {
@@ -102,19 +165,6 @@ int alloc_simd_buffer(simd_memory_buffer_t* buffer,
 // Free SIMD-optimized buffer
 void free_simd_buffer(simd_memory_buffer_t* buffer);
 
-// Performance measurement macros
-#ifdef SIMD_BENCHMARK
-#define SIMD_TIMER_START() \
-    uint64_t _start_cycles = __builtin_readcyclecounter()
-
-#define SIMD_TIMER_END(operation_name) \
-    uint64_t _end_cycles = __builtin_readcyclecounter(); \
-    printf("SIMD %s: %llu cycles\n", operation_name, _end_cycles - _start_cycles)
-#else
-#define SIMD_TIMER_START()
-#define SIMD_TIMER_END(operation_name)
-#endif
-
 // Architecture-specific optimizations
 #ifdef __aarch64__
     // ARM64-specific NEON optimizations
@@ -0,0 +1,75 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "iex.h"
+
+// Dense symbol dictionary
+// Maps the 8-byte space-padded IEX symbol, compared as one uint64 word, to
+// a dense ID 0..count-1 so per-symbol state can live in flat arrays indexed
+// by ID. IDs are handed out in order of first sight; seeding from the
+// Security Directory (0x44) messages published before the open gives the
+// listed universe the low, stable IDs. Lookups use open addressing with
+// linear probing over a power-of-two slot array kept at most half full.
+
+typedef uint16_t symbol_id_t;
+
+#define SYMBOL_ID_INVALID       ((symbol_id_t)0xFFFF)
+#define SYMBOL_TABLE_MAX        0xFFFF      // IDs 0..0xFFFE
+#define SYMBOL_EMPTY_KEY        0           // symbol words are never all zero
+
+typedef struct {
+    uint64_t *slot_keys;        // symbol word per slot, SYMBOL_EMPTY_KEY if free
+    symbol_id_t *slot_ids;      // ID per occupied slot
+    uint64_t *symbols;          // ID -> symbol word
+    uint32_t slot_mask;         // slot count - 1
+    uint32_t shift;             // 64 - log2(slot count)
+    uint32_t count;             // IDs assigned
+    uint32_t max_symbols;
+} symbol_table_t;
+
+// Size for up to max_symbols IDs; returns 0 or -1 on allocation failure
+int symbol_table_init(symbol_table_t *table, uint32_t max_symbols);
+void symbol_table_free(symbol_table_t *table);
+
+// Home slot (multiplicative hash); symbol_table_intern_batch computes the
+// same value for a run of symbols with the dispatched symbol_slots kernel
+static inline uint32_t symbol_table_slot(const symbol_table_t *table, uint64_t symbol) {
+    return (uint32_t)((symbol * 0x9E3779B97F4A7C15ULL) >> table->shift);
+}
+
+// ID of a known symbol, or SYMBOL_ID_INVALID
+static inline symbol_id_t symbol_table_find(const symbol_table_t *table, uint64_t symbol) {
+    uint32_t slot = symbol_table_slot(table, symbol);
+
+    for (;;) {
+        uint64_t key = table->slot_keys[slot];
+        if (key == symbol) return table->slot_ids[slot];
+        if (key == SYMBOL_EMPTY_KEY) return SYMBOL_ID_INVALID;
+        slot = (slot + 1) & table->slot_mask;
+    }
+}
+
+// ID of symbol, assigning the next one on first sight
+// Returns SYMBOL_ID_INVALID for a zero word or once the table is full.
+symbol_id_t symbol_table_intern(symbol_table_t *table, uint64_t symbol);
+
+static inline uint64_t symbol_table_symbol(const symbol_table_t *table, symbol_id_t id) {
+    return table->symbols[id];
+}
+
+// Ticker text for an ID, trailing padding removed (out needs 9 bytes)
+void symbol_table_name(const symbol_table_t *table, symbol_id_t id, char *out);
+
+// Intern every Security Directory message of one IEX-TP segment
+// Returns the number of directory entries seen.
+uint32_t symbol_table_seed_segment(symbol_table_t *table, const uint8_t *udp_payload, size_t len);
+
+// Resolve a batch of decoded messages to IDs (ids[i] for messages[i])
+// Directory messages in the batch are interned first so they keep seed
+// order; messages without a symbol (system events) get SYMBOL_ID_INVALID.
+void symbol_table_intern_batch(symbol_table_t *table, const parsed_message_t *messages,
+                               uint32_t count, symbol_id_t *ids);
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef TOP_OF_BOOK_H
+#define TOP_OF_BOOK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "iex.h"
+#include "symbol_table.h"
+
+// Per-symbol top-of-book built from Quote Updates (0x51)
+// Struct-of-arrays indexed by symbol_id_t: a quote touches one slot in
+// each of six cache-line aligned arrays, and a market-wide scan of one
+// field streams through contiguous memory. All storage is allocated by
+// tob_book_init(); updates and snapshots never allocate.
+//
+// The book belongs to the thread applying quotes. Another thread takes a
+// snapshot mid-run through a tob_channel_t: it posts a request and blocks,
+// and the owner copies the book between two batches, so every snapshot is
+// the market after a whole number of batches in capture order.
+
+typedef struct {
+    iex_price_t *bid_price;     // 0 when the side is empty
+    uint32_t *bid_size;
+    iex_price_t *ask_price;
+    uint32_t *ask_size;
+    uint64_t *last_update;      // timestamp of the quote that set the slot, 0 if never quoted
+    uint64_t *symbol;           // symbol word of the slot
+    uint32_t capacity;          // symbol IDs the arrays can hold
+    uint32_t active;            // highest quoted ID + 1
+    uint64_t quotes_applied;
+} tob_book_t;
+
+// Same layout, owned by the caller; filled by tob_snapshot()
+typedef tob_book_t tob_snapshot_t;
+
+// Allocate arrays for symbol IDs 0..capacity-1; returns 0 or -1
+int tob_book_init(tob_book_t *book, uint32_t capacity);
+void tob_book_free(tob_book_t *book);
+
+// Forget every quote, keeping the arrays
+void tob_book_reset(tob_book_t *book);
+
+static inline void tob_apply_quote(tob_book_t *book, symbol_id_t id, uint64_t symbol,
+                                   uint64_t timestamp, iex_price_t bid_price, uint32_t bid_size,
+                                   iex_price_t ask_price, uint32_t ask_size) {
+    if (id >= book->capacity) return;
+
+    book->symbol[id] = symbol;
+    book->bid_price[id] = bid_price;
+    book->bid_size[id] = bid_size;
+    book->ask_price[id] = ask_price;
+    book->ask_size[id] = ask_size;
+    book->last_update[id] = timestamp;
+    if (id >= book->active) book->active = (uint32_t)id + 1;
+    book->quotes_applied++;
+}
+
+// Apply every quote of a decoded batch; ids[i] is the symbol ID of
+// messages[i] (see symbol_table_intern_batch). Other types are ignored.
+void tob_apply_batch(tob_book_t *book, const parsed_message_t *messages,
+                     const symbol_id_t *ids, uint32_t count);
+
+// Copy the whole market into a snapshot allocated with the same capacity
+// Only IDs below book->active are copied. Returns 0, or -1 if it does not fit.
+int tob_snapshot(const tob_book_t *book, tob_snapshot_t *snapshot);
+
+// Snapshot requests from other threads
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    const tob_book_t *book;
+    tob_snapshot_t *target;     // request being waited on, NULL if none
+    int *target_result;
+    int open;                   // an owner is applying quotes to book
+    atomic_int pending;         // target set; polled by the owner
+} tob_channel_t;
+
+int tob_channel_init(tob_channel_t *channel, const tob_book_t *book);
+void tob_channel_destroy(tob_channel_t *channel);
+
+// Owner: from now on the book is written by the owner thread only
+void tob_channel_open(tob_channel_t *channel);
+
+// Owner: serve any waiting request, then hand the book back to readers
+void tob_channel_close(tob_channel_t *channel);
+
+void tob_channel_serve(tob_channel_t *channel);
+
+// Owner, between batches: a single atomic load when nobody is waiting
+static inline void tob_channel_poll(tob_channel_t *channel) {
+    if (atomic_load_explicit(&channel->pending, memory_order_acquire)) tob_channel_serve(channel);
+}
+
+// Any thread: copy the book into snapshot, waiting for the owner's next
+// batch boundary while the channel is open. Returns tob_snapshot()'s result.
+int tob_request_snapshot(tob_channel_t *channel, tob_snapshot_t *snapshot);
+
+#endif
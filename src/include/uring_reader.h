@@ -0,0 +1,31 @@
+#ifndef URING_READER_H
+#define URING_READER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// io_uring reader backend (Linux)
+// The mmap path takes one page fault per 4KB on a cold file and the kernel
+// can only read ahead of the fault that is currently blocking. This backend
+// keeps URING_BUFFER_COUNT large reads in flight instead, optionally with
+// O_DIRECT into aligned buffers registered with the ring, and feeds each
+// filled buffer to the same pcapng block decoder in file order.
+//
+// Every buffer has URING_CARRY_SIZE bytes of headroom in front of its data.
+// A block cut off at the end of one buffer is copied into the headroom of
+// the next so the decoder always sees it contiguously.
+
+#define URING_BUFFER_SIZE   (4 * 1024 * 1024)
+#define URING_BUFFER_COUNT  8
+#define URING_CARRY_SIZE    (256 * 1024)        // largest block that may straddle buffers
+#define URING_ALIGNMENT     4096                // O_DIRECT offset/length/address alignment
+
+// Returned when io_uring is missing or disabled; callers fall back to mmap
+#define URING_UNAVAILABLE   (-2)
+
+// Stream a pcapng capture through io_uring; direct selects O_DIRECT
+// Returns 0, -1 on a parse/IO error, or URING_UNAVAILABLE. *file_size is
+// set once the file has been opened.
+int parse_pcap_file_uring(const char *filename, int direct, size_t *file_size);
+
+#endif
@@ -0,0 +1,82 @@
+#!/bin/sh
+# Regression checks on generated captures (make test)
+# Each check prints PASS or FAIL; the script exits non-zero if any failed.
+
+set -u
+cd "$(dirname "$0")/.."
+
+PARSER=./pcap_parser
+GENERATOR=./pcapng_generator
+SIMD_BENCHMARK=./simd_benchmark
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT INT TERM
+failures=0
+
+pass() {
+    echo "PASS: $1"
+}
+
+fail() {
+    echo "FAIL: $1"
+    failures=$((failures + 1))
+}
+
+# Default universe (8000 symbols), 32 chunks of DEEP
+CAPTURE="$WORK/deep.pcapng"
+if ! $GENERATOR -o "$CAPTURE" -s 64M -r 1 > /dev/null; then
+    echo "FAIL: could not generate $CAPTURE"
+    exit 1
+fi
+
+# Symbol zone maps: a ticker the generator can never produce (8 letters)
+# must let the query skip at least 90% of the chunks
+line=$($PARSER -S NOTLISTD "$CAPTURE" 2>&1 | grep "Zone maps skipped")
+skipped=$(echo "$line" | sed -n 's/.*skipped \([0-9]*\) of \([0-9]*\) chunks.*/\1/p')
+chunks=$(echo "$line" | sed -n 's/.*skipped \([0-9]*\) of \([0-9]*\) chunks.*/\2/p')
+if [ -n "$skipped" ] && [ "$chunks" -gt 0 ] && [ $((skipped * 10)) -ge $((chunks * 9)) ]; then
+    pass "absent symbol skips $skipped of $chunks chunks"
+else
+    fail "absent symbol zone map pruning (${line:-no zone map report})"
+fi
+
+# Generated DEEP books: replayed through depth_book, no completed event may
+# leave a symbol's best bid at or above its best ask
+line=$($PARSER -j 4 "$CAPTURE" 2>&1 | grep "Depth book:")
+events=$(echo "$line" | sed -n 's/.* \([0-9]*\) events.*/\1/p')
+crossed=$(echo "$line" | sed -n 's/.* \([0-9]*\) crossed.*/\1/p')
+if [ -n "$events" ] && [ "$events" -gt 0 ] && [ "$crossed" = "0" ]; then
+    pass "generated book never crossed over $events events"
+else
+    fail "generated book crossed (${line:-no depth book report})"
+fi
+
+# A capture cut off inside its last block fails on every reader
+TRUNCATED="$WORK/truncated.pcapng"
+head -c $(($(wc -c < "$CAPTURE") - 80)) "$CAPTURE" > "$TRUNCATED"
+for reader in "-j 1" "-j 4" "-R uring"; do
+    if $PARSER $reader "$TRUNCATED" > /dev/null 2>&1; then
+        fail "truncated capture accepted ($reader)"
+    else
+        pass "truncated capture rejected ($reader)"
+    fi
+done
+
+# Assembly entry points decode every frame of a TOPS and a DEEP capture
+# exactly as the C decoder does
+TOPS="$WORK/tops.pcapng"
+if ! $GENERATOR -o "$TOPS" -s 16M -r 2 -p tops > /dev/null; then
+    fail "could not generate $TOPS"
+elif ! $SIMD_BENCHMARK --verify-asm "$CAPTURE" "$TOPS" > "$WORK/asm.txt" 2>&1; then
+    fail "assembly differs from the C decoder"
+    grep MISMATCH "$WORK/asm.txt"
+elif grep -q "^Skipped" "$WORK/asm.txt"; then
+    pass "assembly check: $(grep "^Skipped" "$WORK/asm.txt")"
+else
+    pass "assembly matches the C decoder on TOPS and DEEP"
+fi
+
+if [ "$failures" -ne 0 ]; then
+    echo "$failures check(s) failed"
+    exit 1
+fi
+echo "All checks passed"